@@ -0,0 +1,168 @@
+// Base64编解码微基准：对比旧的逐字符实现与表驱动/SIMD实现
+#include "utils.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace legacy {
+
+static const std::string base64_chars =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static inline bool is_base64(unsigned char c) {
+    return (isalnum(c) || (c == '+') || (c == '/'));
+}
+
+// 旧版编码实现（逐字符追加）
+std::string base64Encode(const unsigned char* data, size_t length) {
+    std::string ret;
+    int i = 0;
+    int j = 0;
+    unsigned char char_array_3[3];
+    unsigned char char_array_4[4];
+
+    while (length--) {
+        char_array_3[i++] = *(data++);
+        if (i == 3) {
+            char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
+            char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
+            char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
+            char_array_4[3] = char_array_3[2] & 0x3f;
+
+            for (i = 0; i < 4; i++)
+                ret += base64_chars[char_array_4[i]];
+            i = 0;
+        }
+    }
+
+    if (i) {
+        for (j = i; j < 3; j++)
+            char_array_3[j] = '\0';
+
+        char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
+        char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
+        char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
+        char_array_4[3] = char_array_3[2] & 0x3f;
+
+        for (j = 0; j < i + 1; j++)
+            ret += base64_chars[char_array_4[j]];
+
+        while ((i++ < 3))
+            ret += '=';
+    }
+
+    return ret;
+}
+
+// 旧版解码实现（线性查找 + push_back）
+std::vector<unsigned char> base64Decode(const std::string& encoded_data) {
+    size_t in_len = encoded_data.size();
+    int i = 0;
+    int j = 0;
+    int in_ = 0;
+    unsigned char char_array_4[4], char_array_3[3];
+    std::vector<unsigned char> ret;
+
+    while (in_len-- && (encoded_data[in_] != '=') && is_base64(encoded_data[in_])) {
+        char_array_4[i++] = encoded_data[in_]; in_++;
+        if (i == 4) {
+            for (i = 0; i < 4; i++)
+                char_array_4[i] = base64_chars.find(char_array_4[i]);
+
+            char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
+            char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
+            char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
+
+            for (i = 0; i < 3; i++)
+                ret.push_back(char_array_3[i]);
+            i = 0;
+        }
+    }
+
+    if (i) {
+        for (j = i; j < 4; j++)
+            char_array_4[j] = 0;
+
+        for (j = 0; j < 4; j++)
+            char_array_4[j] = base64_chars.find(char_array_4[j]);
+
+        char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
+        char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
+        char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
+
+        for (j = 0; j < i - 1; j++)
+            ret.push_back(char_array_3[j]);
+    }
+
+    return ret;
+}
+
+} // namespace legacy
+
+// 运行fn若干次，返回吞吐量（MB/s，按原始字节计）
+template <typename Fn>
+static double measure(size_t bytes, int iterations, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    return bytes * static_cast<double>(iterations) / seconds / (1024.0 * 1024.0);
+}
+
+int main(int argc, char* argv[]) {
+    // 默认测试一张约200KB的JPEG大小的数据
+    size_t size = 200 * 1024;
+    int iterations = 200;
+    if (argc >= 2) size = std::stoul(argv[1]);
+    if (argc >= 3) iterations = std::stoi(argv[2]);
+
+    std::mt19937 rng(42);
+    std::vector<unsigned char> data(size);
+    for (auto& b : data) {
+        b = static_cast<unsigned char>(rng());
+    }
+
+    std::string encoded = utils::base64Encode(data.data(), data.size());
+
+    // 校验新旧实现结果一致
+    if (encoded != legacy::base64Encode(data.data(), data.size()) ||
+        utils::base64Decode(encoded) != data ||
+        legacy::base64Decode(encoded) != data) {
+        std::cerr << "错误: 新旧Base64实现结果不一致" << std::endl;
+        return 1;
+    }
+
+    std::vector<unsigned char> out(utils::base64DecodedMaxLength(encoded.size()));
+    volatile size_t sink = 0;
+
+    double legacy_enc = measure(size, iterations, [&]() {
+        sink += legacy::base64Encode(data.data(), data.size()).size();
+    });
+    double new_enc = measure(size, iterations, [&]() {
+        sink += utils::base64Encode(data.data(), data.size()).size();
+    });
+    double legacy_dec = measure(size, iterations, [&]() {
+        sink += legacy::base64Decode(encoded).size();
+    });
+    double new_dec = measure(size, iterations, [&]() {
+        sink += utils::base64Decode(encoded).size();
+    });
+    double new_dec_into = measure(size, iterations, [&]() {
+        sink += utils::base64DecodeTo(encoded.data(), encoded.size(), out.data(), out.size());
+    });
+
+    std::cout << "{\"benchmark\":\"base64\",\"impl\":\"" << utils::base64Implementation()
+              << "\",\"bytes\":" << size
+              << ",\"iterations\":" << iterations
+              << ",\"encode_legacy_mbps\":" << legacy_enc
+              << ",\"encode_mbps\":" << new_enc
+              << ",\"decode_legacy_mbps\":" << legacy_dec
+              << ",\"decode_mbps\":" << new_dec
+              << ",\"decode_into_mbps\":" << new_dec_into
+              << "}" << std::endl;
+    return 0;
+}
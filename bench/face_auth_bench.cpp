@@ -0,0 +1,427 @@
+// 核心路径基准：图像质量门限、人脸检测、预处理、比较、不同图库规模下的识别、Base64解码、SHA-256与请求帧解析
+// 只使用合成图像（或 --image 指定的本地图片），离线运行，结果以JSON输出便于跨版本对比
+#include "face_detector.h"
+#include "face_recognizer.h"
+#include "image_quality.h"
+#include "logger.h"
+#include "metrics.h"
+#include "protocol.h"
+#include "synthetic_face.h"
+#include "utils.h"
+#include <json/json.h>
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::string cascade = "models/haarcascade_frontalface_default.xml";
+    std::string image;          // 可选的真实图片，替代合成场景
+    std::string filter;         // 只运行名称包含该子串的基准
+    std::string output;         // 结果文件，为空时写到标准输出
+    int min_time_ms = 500;      // 每项基准的最短运行时间
+    size_t max_gallery = 10000; // 识别基准的最大图库规模
+};
+
+// LBPH每个样本保存 8x8 网格 * 256 维直方图的float，另有100x100的预处理图像
+const size_t BYTES_PER_GALLERY_ENTRY = 8 * 8 * 256 * sizeof(float) + 100 * 100;
+
+const size_t GALLERY_SIZES[] = {10, 100, 1000, 10000, 100000, 1000000};
+
+// compareFaces每次以整个训练集重新训练临时模型，只在小图库上测量
+const size_t MAX_COMPARE_GALLERY = 1000;
+
+void printUsage(const char* program) {
+    std::cerr << "用法: " << program << " [选项]\n"
+              << "  --cascade PATH      Haar级联模型（默认 models/haarcascade_frontalface_default.xml）\n"
+              << "  --image PATH        使用本地图片做检测基准，默认使用合成场景\n"
+              << "  --filter TEXT       只运行名称包含TEXT的基准\n"
+              << "  --min-time-ms N     每项基准的最短运行时间（默认500）\n"
+              << "  --max-gallery N     识别基准的最大图库规模（默认10000，最大1000000）\n"
+              << "  --output FILE       结果写入文件（默认标准输出）\n";
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            return false;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "缺少参数值: " << arg << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--cascade") {
+            options.cascade = value;
+        } else if (arg == "--image") {
+            options.image = value;
+        } else if (arg == "--filter") {
+            options.filter = value;
+        } else if (arg == "--output") {
+            options.output = value;
+        } else if (arg == "--min-time-ms") {
+            options.min_time_ms = std::stoi(value);
+        } else if (arg == "--max-gallery") {
+            options.max_gallery = std::stoul(value);
+        } else {
+            std::cerr << "未知选项: " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+class BenchRunner {
+public:
+    explicit BenchRunner(const Options& options) : options_(options), results_(Json::arrayValue) {
+    }
+
+    bool enabled(const std::string& name) const {
+        return options_.filter.empty() || name.find(options_.filter) != std::string::npos;
+    }
+
+    // 预热一次后重复执行fn，直到满足最短运行时间；逐次记录纳秒耗时
+    template <typename Fn>
+    void run(const std::string& name, const Json::Value& params, Fn fn) {
+        if (!enabled(name)) {
+            return;
+        }
+        fn();
+
+        std::unique_ptr<LatencyHistogram> histogram(new LatencyHistogram());
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(options_.min_time_ms);
+        uint64_t iterations = 0;
+        do {
+            auto start = std::chrono::steady_clock::now();
+            fn();
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            histogram->record(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+            ++iterations;
+        } while (iterations < MIN_ITERATIONS || std::chrono::steady_clock::now() < deadline);
+
+        HistogramSnapshot snapshot = histogram->snapshot();
+        Json::Value result;
+        result["name"] = name;
+        result["params"] = params;
+        result["iterations"] = static_cast<Json::UInt64>(snapshot.count);
+        result["mean_ns"] = snapshot.mean();
+        result["p50_ns"] = static_cast<Json::UInt64>(snapshot.percentile(0.5));
+        result["p99_ns"] = static_cast<Json::UInt64>(snapshot.percentile(0.99));
+        result["max_ns"] = static_cast<Json::UInt64>(snapshot.max);
+        result["ops_per_sec"] = snapshot.mean() > 0 ? 1e9 / snapshot.mean() : 0.0;
+        results_.append(result);
+
+        Json::FastWriter writer;
+        std::cerr << name << " " << writer.write(params).substr(0, 80) << "  mean "
+                  << static_cast<uint64_t>(snapshot.mean()) << " ns, p99 " << snapshot.percentile(0.99)
+                  << " ns, " << snapshot.count << " 次" << std::endl;
+    }
+
+    const Json::Value& results() const { return results_; }
+
+private:
+    static const uint64_t MIN_ITERATIONS = 3;
+
+    const Options& options_;
+    Json::Value results_;
+};
+
+// 防止结果被优化掉
+volatile size_t g_sink = 0;
+
+void benchDetector(BenchRunner& runner, const Options& options) {
+    if (!runner.enabled("detect_faces")) {
+        return;
+    }
+    FaceDetector detector;
+    if (!detector.initialize(options.cascade)) {
+        std::cerr << "跳过 detect_faces: 无法加载级联模型 " << options.cascade << std::endl;
+        return;
+    }
+
+    std::vector<std::pair<std::string, cv::Mat>> images;
+    if (!options.image.empty()) {
+        cv::Mat image = cv::imread(options.image);
+        if (image.empty()) {
+            std::cerr << "无法读取图片: " << options.image << std::endl;
+        } else {
+            images.push_back(std::make_pair(std::string("file"), image));
+        }
+    } else {
+        images.push_back(std::make_pair(std::string("synthetic"), synthetic::makeScene(cv::Size(640, 480), 1)));
+        images.push_back(std::make_pair(std::string("synthetic"), synthetic::makeScene(cv::Size(1280, 720), 2)));
+    }
+
+    for (const auto& item : images) {
+        const cv::Mat& image = item.second;
+        Json::Value params;
+        params["source"] = item.first;
+        params["width"] = image.cols;
+        params["height"] = image.rows;
+        params["faces_found"] = static_cast<Json::UInt64>(detector.detectFaces(image).size());
+        runner.run("detect_faces", params, [&]() {
+            g_sink += detector.detectFaces(image).size();
+        });
+    }
+}
+
+// 质量门限与检测使用相同的图像，另加一张模糊图像（门限在此提前拒绝）
+void benchQualityGate(BenchRunner& runner, const Options& options) {
+    if (!runner.enabled("quality_gate")) {
+        return;
+    }
+
+    std::vector<std::pair<std::string, cv::Mat>> images;
+    if (!options.image.empty()) {
+        cv::Mat image = cv::imread(options.image);
+        if (image.empty()) {
+            std::cerr << "无法读取图片: " << options.image << std::endl;
+            return;
+        }
+        images.push_back(std::make_pair(std::string("file"), image));
+    } else {
+        images.push_back(std::make_pair(std::string("synthetic"), synthetic::makeScene(cv::Size(640, 480), 1)));
+        images.push_back(std::make_pair(std::string("synthetic"), synthetic::makeScene(cv::Size(1280, 720), 2)));
+    }
+    cv::Mat blurred;
+    cv::GaussianBlur(images.back().second, blurred, cv::Size(31, 31), 0);
+    images.push_back(std::make_pair(images.back().first + "_blurred", blurred));
+
+    QualityConfig config;
+    for (const auto& item : images) {
+        const cv::Mat& image = item.second;
+        QualityMetrics metrics;
+        Json::Value params;
+        params["source"] = item.first;
+        params["width"] = image.cols;
+        params["height"] = image.rows;
+        params["result"] = qualityReason(checkImageQuality(image, config, &metrics));
+        params["sharpness"] = metrics.sharpness;
+        params["brightness"] = metrics.brightness;
+        runner.run("quality_gate", params, [&]() {
+            g_sink += static_cast<size_t>(checkImageQuality(image, config));
+        });
+    }
+}
+
+void benchRecognizer(BenchRunner& runner, const Options& options) {
+    bool want_preprocess = runner.enabled("preprocess_face");
+    bool want_compare = runner.enabled("compare_faces");
+    bool want_recognize = runner.enabled("recognize");
+    if (!want_preprocess && !want_compare && !want_recognize) {
+        return;
+    }
+
+    // 不读写face_auth_data下的模型文件
+    FaceRecognizer recognizer;
+    recognizer.setPersistent(false);
+    if (!recognizer.initialize()) {
+        std::cerr << "跳过识别基准: 人脸识别器初始化失败" << std::endl;
+        return;
+    }
+
+    cv::Mat probe = synthetic::makeFaceCrop(160, 7);
+    cv::Mat other = synthetic::makeFaceCrop(160, 8);
+
+    const int preprocess_sides[] = {100, 320};
+    for (int side : preprocess_sides) {
+        cv::Mat crop = synthetic::makeFaceCrop(side, 3);
+        Json::Value params;
+        params["width"] = side;
+        params["height"] = side;
+        runner.run("preprocess_face", params, [&]() {
+            g_sink += recognizer.preprocessFace(crop).total();
+        });
+    }
+
+    if (want_compare) {
+        Json::Value params;
+        params["gallery"] = 0;
+        runner.run("compare_faces", params, [&]() {
+            g_sink += static_cast<size_t>(recognizer.compareFaces(probe, other));
+        });
+    }
+
+    if (!want_compare && !want_recognize) {
+        return;
+    }
+
+    // 图库逐级增量扩充，每个用户一张合成人脸
+    size_t gallery = 0;
+    const size_t batch_size = 1000;
+    for (size_t target : GALLERY_SIZES) {
+        if (target > options.max_gallery) {
+            break;
+        }
+        if (!want_recognize && target > MAX_COMPARE_GALLERY) {
+            break;
+        }
+        auto build_start = std::chrono::steady_clock::now();
+        while (gallery < target) {
+            std::vector<std::pair<int, cv::Mat>> samples;
+            std::vector<bool> trained;
+            size_t count = std::min(batch_size, target - gallery);
+            for (size_t i = 0; i < count; ++i) {
+                int user_id = static_cast<int>(gallery + i + 1);
+                samples.push_back(std::make_pair(user_id, synthetic::makeFaceCrop(100, 1000 + user_id)));
+            }
+            gallery += recognizer.trainBatch(samples, trained);
+            if (trained.empty() || !trained[0]) {
+                std::cerr << "构建图库失败，停止识别基准" << std::endl;
+                return;
+            }
+        }
+        std::cerr << "图库规模 " << gallery << "，构建耗时 "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::steady_clock::now() - build_start).count()
+                  << " ms" << std::endl;
+
+        Json::Value params;
+        params["gallery"] = static_cast<Json::UInt64>(gallery);
+        if (want_recognize) {
+            runner.run("recognize", params, [&]() {
+                g_sink += static_cast<size_t>(recognizer.recognize(probe).first);
+            });
+        }
+        if (want_compare && gallery <= MAX_COMPARE_GALLERY) {
+            runner.run("compare_faces", params, [&]() {
+                g_sink += static_cast<size_t>(recognizer.compareFaces(probe, other));
+            });
+        }
+    }
+}
+
+void benchUtils(BenchRunner& runner) {
+    std::mt19937 rng(42);
+
+    const size_t decode_sizes[] = {1024, 64 * 1024, 256 * 1024};
+    for (size_t size : decode_sizes) {
+        std::vector<unsigned char> data(size);
+        for (auto& b : data) {
+            b = static_cast<unsigned char>(rng());
+        }
+        std::string encoded = utils::base64Encode(data.data(), data.size());
+        Json::Value params;
+        params["bytes"] = static_cast<Json::UInt64>(size);
+        params["impl"] = utils::base64Implementation();
+        runner.run("base64_decode", params, [&]() {
+            g_sink += utils::base64Decode(encoded).size();
+        });
+    }
+
+    const size_t hash_sizes[] = {16, 64 * 1024};
+    for (size_t size : hash_sizes) {
+        std::string data(size, '\0');
+        for (auto& c : data) {
+            c = static_cast<char>(rng());
+        }
+        Json::Value params;
+        params["bytes"] = static_cast<Json::UInt64>(size);
+        runner.run("sha256", params, [&]() {
+            g_sink += utils::sha256(data).size();
+        });
+    }
+}
+
+void benchProtocol(BenchRunner& runner) {
+    // 登录请求：JSON头 + 一张JPEG大小的人脸数据
+    std::vector<uchar> jpeg;
+    cv::imencode(".jpg", synthetic::makeFaceCrop(320, 5), jpeg);
+    std::string face_data(jpeg.begin(), jpeg.end());
+
+    Json::Value login;
+    login["type"] = "login";
+    login["username"] = "bench_user";
+    login["password"] = "bench_password";
+    std::string login_frame = protocol::buildRequestFrame(login, face_data);
+
+    Json::Value stats;
+    stats["type"] = "stats";
+    std::string stats_frame = protocol::buildRequestFrame(stats, std::string());
+
+    const std::pair<const char*, const std::string*> frames[] = {
+        std::make_pair("login", &login_frame),
+        std::make_pair("stats", &stats_frame),
+    };
+    for (const auto& frame : frames) {
+        Json::Value params;
+        params["type"] = frame.first;
+        params["bytes"] = static_cast<Json::UInt64>(frame.second->size());
+        runner.run("parse_frame", params, [&]() {
+            Message message;
+            if (protocol::parseRequestFrame(frame.second->data(), frame.second->size(), message) ==
+                FrameStatus::COMPLETE) {
+                g_sink += message.data.size();
+            }
+        });
+    }
+}
+
+Json::Value environment(const Options& options) {
+    Json::Value env;
+    env["opencv"] = CV_VERSION;
+    env["cpus"] = std::thread::hardware_concurrency();
+    env["base64_impl"] = utils::base64Implementation();
+    env["timestamp"] = static_cast<Json::Int64>(std::time(nullptr));
+    env["min_time_ms"] = options.min_time_ms;
+    env["max_gallery"] = static_cast<Json::UInt64>(options.max_gallery);
+    return env;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (options.max_gallery > GALLERY_SIZES[sizeof(GALLERY_SIZES) / sizeof(GALLERY_SIZES[0]) - 1]) {
+        options.max_gallery = GALLERY_SIZES[sizeof(GALLERY_SIZES) / sizeof(GALLERY_SIZES[0]) - 1];
+    }
+    if (options.max_gallery >= 100000) {
+        std::cerr << "注意: 图库规模 " << options.max_gallery << " 约需 "
+                  << options.max_gallery * BYTES_PER_GALLERY_ENTRY / (1024 * 1024) << " MB 内存" << std::endl;
+    }
+
+    // 只保留警告以上的日志，避免训练日志干扰计时
+    for (int i = 0; i < static_cast<int>(LogSubsystem::COUNT); ++i) {
+        Logger::instance().setLevel(static_cast<LogSubsystem>(i), LogLevel::WARN);
+    }
+
+    BenchRunner runner(options);
+    benchQualityGate(runner, options);
+    benchDetector(runner, options);
+    benchRecognizer(runner, options);
+    benchUtils(runner);
+    benchProtocol(runner);
+
+    Json::Value root;
+    root["benchmark"] = "face_auth";
+    root["environment"] = environment(options);
+    root["results"] = runner.results();
+
+    Json::StyledWriter writer;
+    std::string output = writer.write(root);
+    if (options.output.empty()) {
+        std::cout << output;
+    } else {
+        std::ofstream file(options.output);
+        if (!file.is_open()) {
+            std::cerr << "无法写入结果文件: " << options.output << std::endl;
+            return 1;
+        }
+        file << output;
+    }
+    return 0;
+}
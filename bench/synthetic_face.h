@@ -0,0 +1,61 @@
+#ifndef SYNTHETIC_FACE_H
+#define SYNTHETIC_FACE_H
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+
+// 基准与压测工具共用的合成人脸图像，不依赖外部图片
+namespace synthetic {
+
+// 在region内画一张简化的人脸：肤色椭圆、眼睛、鼻子和嘴，seed决定五官的细微差别
+inline void drawFace(cv::Mat& image, const cv::Rect& region, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> jitter(-3, 3);
+    std::uniform_int_distribution<int> shade(150, 220);
+
+    cv::Point center(region.x + region.width / 2, region.y + region.height / 2);
+    int skin = shade(rng);
+    cv::ellipse(image, center, cv::Size(region.width * 2 / 5, region.height / 2), 0, 0, 360,
+                cv::Scalar(skin - 40, skin - 10, skin), cv::FILLED);
+
+    int eye_y = region.y + region.height * 2 / 5 + jitter(rng);
+    int eye_dx = region.width / 6 + jitter(rng);
+    int eye_r = std::max(2, region.width / 18);
+    cv::circle(image, cv::Point(center.x - eye_dx, eye_y), eye_r, cv::Scalar(40, 30, 30), cv::FILLED);
+    cv::circle(image, cv::Point(center.x + eye_dx, eye_y), eye_r, cv::Scalar(40, 30, 30), cv::FILLED);
+    cv::line(image, cv::Point(center.x - eye_dx - eye_r * 2, eye_y - eye_r * 2),
+             cv::Point(center.x - eye_dx + eye_r * 2, eye_y - eye_r * 2 + jitter(rng)), cv::Scalar(30, 30, 30), 2);
+    cv::line(image, cv::Point(center.x + eye_dx - eye_r * 2, eye_y - eye_r * 2 + jitter(rng)),
+             cv::Point(center.x + eye_dx + eye_r * 2, eye_y - eye_r * 2), cv::Scalar(30, 30, 30), 2);
+
+    int nose_y = region.y + region.height * 3 / 5 + jitter(rng);
+    cv::line(image, cv::Point(center.x, eye_y + eye_r), cv::Point(center.x + jitter(rng), nose_y),
+             cv::Scalar(skin - 80, skin - 60, skin - 50), 2);
+
+    int mouth_y = region.y + region.height * 3 / 4 + jitter(rng);
+    cv::ellipse(image, cv::Point(center.x, mouth_y), cv::Size(region.width / 6 + jitter(rng), region.height / 20 + 1),
+                0, 0, 180, cv::Scalar(60, 60, 150), 3);
+}
+
+// 带噪声背景的合成场景，中间放一张人脸
+inline cv::Mat makeScene(const cv::Size& size, uint32_t seed) {
+    cv::Mat scene(size, CV_8UC3);
+    cv::randn(scene, cv::Scalar(110, 110, 110), cv::Scalar(25, 25, 25));
+    int face = size.height / 2;
+    drawFace(scene, cv::Rect((size.width - face) / 2, (size.height - face) / 2, face, face), seed);
+    return scene;
+}
+
+// 合成人脸裁剪图，用作图库样本与查询人脸
+inline cv::Mat makeFaceCrop(int side, uint32_t seed) {
+    cv::Mat crop(side, side, CV_8UC3);
+    cv::randn(crop, cv::Scalar(100, 100, 100), cv::Scalar(15, 15, 15));
+    drawFace(crop, cv::Rect(0, 0, side, side), seed);
+    return crop;
+}
+
+} // namespace synthetic
+
+#endif // SYNTHETIC_FACE_H
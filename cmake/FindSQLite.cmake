@@ -0,0 +1,35 @@
+# - Find SQLite
+# Find the SQLite3 includes and library
+# This module defines
+#  SQLITE_INCLUDE_DIR, where to find sqlite3.h
+#  SQLITE_LIBRARY, the libraries needed to use SQLite.
+#  SQLITE_FOUND, If false, do not try to use SQLite.
+
+if(SQLITE_INCLUDE_DIR AND SQLITE_LIBRARY)
+   set(SQLITE_FOUND TRUE)
+else()
+  find_path(SQLITE_INCLUDE_DIR sqlite3.h
+    /usr/include
+    /usr/local/include
+    /opt/local/include
+  )
+
+  find_library(SQLITE_LIBRARY NAMES sqlite3
+    PATHS
+    /usr/lib
+    /usr/lib64
+    /usr/local/lib
+    /usr/local/lib64
+    /opt/local/lib
+  )
+
+  if(SQLITE_INCLUDE_DIR AND SQLITE_LIBRARY)
+    set(SQLITE_FOUND TRUE)
+    message(STATUS "Found SQLite: ${SQLITE_INCLUDE_DIR}, ${SQLITE_LIBRARY}")
+  else()
+    set(SQLITE_FOUND FALSE)
+    message(STATUS "SQLite not found.")
+  endif()
+
+  mark_as_advanced(SQLITE_INCLUDE_DIR SQLITE_LIBRARY)
+endif()
@@ -0,0 +1,50 @@
+#ifndef ADMIN_SERVER_H
+#define ADMIN_SERVER_H
+
+#include <string>
+#include <map>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+// 本地管理套接字（Unix域套接字，权限0600）
+// 客户端发送一行命令（如"metrics"），服务器写回结果后关闭连接；
+// 也接受"GET /metrics HTTP/1.x"形式的请求，便于用 curl --unix-socket 抓取
+class AdminServer {
+public:
+    // 命令处理函数，参数为命令名之后的剩余文本
+    typedef std::function<std::string(const std::string& args)> Handler;
+
+    AdminServer();
+    ~AdminServer();
+
+    AdminServer(const AdminServer&) = delete;
+    AdminServer& operator=(const AdminServer&) = delete;
+
+    // 注册命令，需在start之前调用；第一个注册的命令为空请求时的默认命令
+    void addCommand(const std::string& name, Handler handler);
+
+    // 在指定路径监听，已存在的旧套接字文件会被删除
+    bool start(const std::string& socket_path);
+
+    // 停止监听并删除套接字文件
+    void stop();
+
+private:
+    // 接受连接的线程，管理请求量很小，逐个连接串行处理
+    void serverThread();
+
+    // 读取命令、执行并写回结果
+    void handleClient(int client_socket);
+
+    std::string socket_path_;
+    int server_socket_;
+    std::map<std::string, Handler> commands_;
+    std::string default_command_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::atomic<bool> running_;
+};
+
+#endif // ADMIN_SERVER_H
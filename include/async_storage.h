@@ -0,0 +1,40 @@
+#ifndef ASYNC_STORAGE_H
+#define ASYNC_STORAGE_H
+
+#include "storage.h"
+#include "pipeline_stage.h"
+#include <string>
+#include <vector>
+#include <future>
+
+// 存储的异步封装：调用在专用I/O线程池上执行，通过future或回调返回结果
+// 请求线程发起查询后可继续做CPU工作（如图像解码），需要结果时再等待；
+// 同时在途的数据库操作数由I/O线程数限定，不占用视觉计算线程
+// 读操作计入查询阶段，写操作计入持久化阶段
+class AsyncStorage {
+public:
+    AsyncStorage();
+
+    // 绑定存储后端与读写阶段（生命周期由调用方管理）
+    void attach(Storage& storage, PipelineStage& reads, PipelineStage& writes);
+
+    // 根据用户名获取用户
+    std::future<UserInfo> getUserByUsername(const std::string& username);
+
+    // 根据ID获取用户
+    std::future<UserInfo> getUserById(int user_id);
+
+    // 添加用户（人脸图像在I/O线程上写入BlobStore）
+    std::future<bool> addUser(const std::string& username, const std::string& password,
+                              std::vector<FaceImage> faces);
+
+    // 更新用户的人脸数据
+    std::future<bool> updateUserFace(int user_id, std::vector<FaceImage> faces);
+
+private:
+    Storage* storage_;
+    PipelineStage* reads_;
+    PipelineStage* writes_;
+};
+
+#endif // ASYNC_STORAGE_H
@@ -0,0 +1,127 @@
+#ifndef AUTH_EVENT_WAL_H
+#define AUTH_EVENT_WAL_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// 认证事件
+struct AuthEvent {
+    // 取值写入日志文件，不可更改
+    enum Type {
+        AUTH_LOG = 0,      // 认证日志
+        LOGIN_RECORD = 1,  // 登录记录（face_images中的login行）
+        LAST_LOGIN = 2     // 更新最后登录时间
+    };
+
+    Type type;
+    int user_id;
+    bool success;
+    std::string details;
+    std::string created_at;  // 事件产生时间
+};
+
+// 预写日志配置
+struct AuthEventWalConfig {
+    std::string dir;            // 段文件目录
+    size_t segment_bytes;       // 段文件达到该大小后切换新段
+    int segment_max_age_ms;     // 段文件最长打开时间，到期后切换，限制事件入库延迟
+    bool sync;                  // 追加后是否fdatasync（组提交）
+    int group_commit_us;        // 组提交等待窗口
+
+    AuthEventWalConfig()
+        : dir("face_auth_data/wal"), segment_bytes(16 * 1024 * 1024), segment_max_age_ms(1000),
+          sync(true), group_commit_us(500) {
+    }
+};
+
+// 预写日志统计
+struct AuthEventWalStats {
+    size_t appended;       // 追加的事件数
+    size_t syncs;          // fdatasync次数
+    size_t segments;       // 已关闭的段数
+    size_t corrupt_tails;  // 读取时遇到的截断/校验失败的段尾
+};
+
+// 认证事件的本地预写日志
+// 事件追加到按序号命名的段文件（segment-<序号>.wal），每条记录带长度与CRC32
+// 并发追加合并为一次write+fdatasync（组提交）；序号小于活动段的段均已关闭，由加载线程入库后删除
+class AuthEventWal {
+public:
+    AuthEventWal();
+    ~AuthEventWal();
+
+    AuthEventWal(const AuthEventWal&) = delete;
+    AuthEventWal& operator=(const AuthEventWal&) = delete;
+
+    // 打开日志目录，新建活动段（已有的段全部视为已关闭）
+    // 新段序号大于目录中已用过的序号及min_sequence（已入库的检查点），保证序号单调递增
+    bool open(const AuthEventWalConfig& config, uint64_t min_sequence);
+
+    // 关闭活动段
+    void close();
+
+    // 追加事件，返回时已写入活动段（sync开启时已落盘）
+    bool append(const AuthEvent& event);
+
+    // 活动段非空且超过最长打开时间时切换新段
+    void rotateIfDue();
+
+    // 列出已关闭的段序号（升序）
+    std::vector<uint64_t> closedSegments();
+
+    // 读取段中的事件，遇到截断或校验失败的记录时停止（崩溃时未写完的段尾）
+    bool readSegment(uint64_t sequence, std::vector<AuthEvent>& events);
+
+    // 删除已加载的段
+    void removeSegment(uint64_t sequence);
+
+    AuthEventWalStats getStats() const;
+
+private:
+    // 一次追加：记录已编码，等待leader写入
+    struct PendingAppend {
+        const std::string* record;
+        bool ok;
+        bool done;
+    };
+
+    std::string segmentPath(uint64_t sequence) const;
+
+    // 打开新的活动段（调用方持有io_mutex_）
+    bool openSegment(uint64_t sequence);
+
+    // 组提交：同一批次由第一个到达的线程（leader）统一write与fdatasync
+    bool commit(PendingAppend& append);
+    bool writeBatch(const std::vector<PendingAppend*>& batch);
+
+    // 批次写入失败时把活动段截回批次之前的长度并切换新段（调用方持有io_mutex_）
+    void rollbackBatch();
+
+    static void encode(const AuthEvent& event, std::string& out);
+    static bool decode(const char* data, size_t size, AuthEvent& event);
+
+    AuthEventWalConfig config_;
+
+    std::mutex mutex_;
+    std::condition_variable committed_;
+    std::vector<PendingAppend*> pending_;
+    bool leader_active_;
+
+    std::mutex io_mutex_;          // 保护活动段（写入与切换）
+    int fd_;
+    uint64_t active_sequence_;
+    size_t active_bytes_;
+    std::chrono::steady_clock::time_point active_opened_;
+
+    std::atomic<size_t> appended_;
+    std::atomic<size_t> syncs_;
+    std::atomic<size_t> segments_;
+    std::atomic<size_t> corrupt_tails_;
+};
+
+#endif // AUTH_EVENT_WAL_H
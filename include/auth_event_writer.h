@@ -0,0 +1,128 @@
+#ifndef AUTH_EVENT_WRITER_H
+#define AUTH_EVENT_WRITER_H
+
+#include "storage.h"
+#include "auth_event_wal.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// 认证事件写入配置
+struct AuthWriterConfig {
+    size_t queue_size;          // 队列容量，满时生产者阻塞等待
+    size_t batch_size;          // 单批最多写入的事件数
+    int flush_interval_ms;      // 队列未满一批时的最长等待时间
+    int max_retries;            // 批次写入失败后的重试次数
+    std::string dead_letter_path;  // 重试仍失败的事件写入该文件
+    bool wal_enabled;           // 事件先写本地预写日志，由后台线程按段批量入库
+    AuthEventWalConfig wal;     // 预写日志配置
+    int wal_load_interval_ms;   // 加载线程检查已关闭段的间隔
+
+    AuthWriterConfig()
+        : queue_size(10000), batch_size(256), flush_interval_ms(200), max_retries(3),
+          dead_letter_path("face_auth_data/logs/auth_events_failed.log"),
+          wal_enabled(false), wal_load_interval_ms(500) {
+    }
+};
+
+// 认证事件写入统计
+struct AuthWriterStats {
+    size_t enqueued;      // 入队事件数
+    size_t written;       // 成功写入事件数
+    size_t batches;       // 写入批次数
+    size_t retries;       // 重试次数
+    size_t dead_letters;  // 写入死信文件的事件数
+    size_t blocked;       // 因队列满而阻塞的入队次数
+    size_t wal_segments;  // 已入库的预写日志段数
+    size_t wal_pending;   // 等待入库的预写日志段数
+};
+
+// 认证日志与登录副作用的异步批量写入器
+// 请求线程只负责入队，后台线程按批次合并为多行INSERT/UPDATE
+// 启用预写日志时，请求线程只追加本地日志（不依赖数据库），后台线程将已关闭的段按事务入库
+class AuthEventWriter {
+public:
+    AuthEventWriter();
+    ~AuthEventWriter();
+
+    AuthEventWriter(const AuthEventWriter&) = delete;
+    AuthEventWriter& operator=(const AuthEventWriter&) = delete;
+
+    // 启动后台写入线程，事件写入storage
+    bool start(Storage& storage, const AuthWriterConfig& config);
+
+    // 停止写入线程，队列中剩余事件全部写完后返回
+    void stop();
+
+    // 记录认证日志
+    void logAuthentication(int user_id, bool success, const std::string& details);
+
+    // 记录一次登录（face_images中的login记录）
+    void recordLogin(int user_id);
+
+    // 更新用户最后登录时间
+    void updateLastLogin(int user_id);
+
+    AuthWriterStats getStats() const;
+
+private:
+    // 入队，队列满时阻塞；启用预写日志时追加到日志
+    void enqueue(AuthEvent&& event);
+
+    // 后台写入线程
+    void run();
+
+    // 预写日志加载线程
+    void runLoader();
+
+    // 按序号加载全部已关闭的段，遇到失败时停止，下一轮重试
+    void loadSegments();
+
+    // 写入一批事件，失败时重试，最终失败写入死信文件
+    void flush(std::vector<AuthEvent>& batch);
+
+    // 按类型合并；同一用户的多次最后登录更新只保留最新时间
+    static void aggregate(const std::vector<AuthEvent>& batch,
+                          std::vector<AuthLogEntry>& logs,
+                          std::vector<LoginRecord>& logins,
+                          std::map<int, std::string>& last_logins);
+
+    // 按类型合并后写入数据库
+    bool writeBatch(const std::vector<AuthLogEntry>& logs,
+                    const std::vector<LoginRecord>& logins,
+                    const std::map<int, std::string>& last_logins,
+                    bool& logs_done, bool& logins_done, bool& last_logins_done);
+
+    // 写入死信文件
+    void writeDeadLetters(const std::vector<AuthEvent>& batch);
+
+    Storage* storage_;
+    AuthWriterConfig config_;
+
+    AuthEventWal wal_;
+    bool wal_active_;
+    std::string wal_source_;    // 检查点中的日志来源：主机名:日志目录
+
+    std::deque<AuthEvent> queue_;
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::thread thread_;
+    bool running_;
+
+    std::atomic<size_t> enqueued_;
+    std::atomic<size_t> written_;
+    std::atomic<size_t> batches_;
+    std::atomic<size_t> retries_;
+    std::atomic<size_t> dead_letters_;
+    std::atomic<size_t> blocked_;
+    std::atomic<size_t> wal_segments_;
+    std::atomic<size_t> wal_pending_;
+};
+
+#endif // AUTH_EVENT_WRITER_H
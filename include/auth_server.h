@@ -3,12 +3,29 @@
 
 #include "face_detector.h"
 #include "face_recognizer.h"
-#include "db_manager.h"
+#include "storage.h"
+#include "auth_event_writer.h"
+#include "user_cache.h"
+#include "blob_store.h"
+#include "executor.h"
+#include "pipeline_stage.h"
+#include "enrollment_trainer.h"
+#include "logger.h"
+#include "metrics.h"
+#include "admin_server.h"
+#include "async_storage.h"
+#include "capture.h"
+#include "auth_session.h"
+#include "image_quality.h"
+#include "token_manager.h"
 #include <json/json.h>
 #include <string>
 #include <vector>
 #include <map>
 #include <mutex>
+#include <memory>
+#include <thread>
+#include <condition_variable>
 
 class AuthServer {
 public:
@@ -30,31 +47,159 @@ public:
     // 认证用户
     Json::Value authenticateUser(const std::string& username, const std::string& password, const std::string& face_data);
     
+    // 开始多帧登录会话：验证密码并准备注册人脸，失败时返回nullptr并填写response
+    std::shared_ptr<AuthSession> startSession(const std::string& username, const std::string& password,
+                                              Json::Value& response);
+    
+    // 提交会话中的一帧异步评分，帧未被接受（已判定、超出帧数或评分中的帧过多）时返回false
+    bool scoreSessionFrame(const std::shared_ptr<AuthSession>& session, const std::string& face_data);
+    
+    // 会话判定后记录结果并生成响应
+    Json::Value finishSession(const std::shared_ptr<AuthSession>& session);
+    
+    // 校验会话令牌，不解码图像、不访问数据库
+    Json::Value verifyToken(const std::string& token);
+    
+    // 吊销会话令牌（客户端登出或管理命令revoke）
+    Json::Value revokeToken(const std::string& token);
+    
+    // 多帧登录会话配置（由TcpServer使用）
+    const SessionConfig& getSessionConfig() const { return session_config_; }
+    
     // 更新用户的人脸数据
     Json::Value updateUserFace(int user_id, const std::string& face_data);
+    
+    // 查询用户的人脸是否已加入识别模型（需验证密码）
+    Json::Value enrollmentStatus(const std::string& username, const std::string& password);
+    
+    // 解析阶段（接收并解析请求，在连接线程上执行），供TcpServer计时
+    PipelineStage& parseStage() { return parse_stage_; }
+    
+    // 获取请求流水线各阶段统计
+    std::vector<StageStats> getStageStats() const;
+    
+    // 延迟直方图、计数器与队列深度（stats消息）
+    Json::Value getStats() const;
+    
+    // 同上，Prometheus文本格式（管理套接字）
+    std::string getPrometheusMetrics() const;
+    
+    // 是否允许通过客户端协议查询统计
+    bool isStatsMessageEnabled() const { return stats_message_enabled_; }
+    
+    // 请求抓包配置（由TcpServer使用）
+    const CaptureConfig& getCaptureConfig() const { return capture_config_; }
+    
+    // 最近请求帧的内存环形缓冲（由TcpServer写入）
+    FrameRing& getFrameRing() { return frame_ring_; }
 
 private:
     // 加载配置文件
     bool loadConfig(const std::string& config_file);
     
+    // 采集队列深度等瞬时值
+    std::vector<GaugeSample> collectGauges() const;
+    
+    // 导出最近的请求帧（管理命令frames），目录为空时导出到face_auth_data/temp下
+    std::string dumpFrames(const std::string& dir);
+    
+    // 检查用户存在且密码正确，失败时计数、记录并填写response
+    bool verifyCredentials(const UserInfo& user, const std::string& password, Json::Value& response);
+    
+    // 将读取到的注册人脸转为可比较的标准化人脸（旧数据需再检测），失败时计数、记录并填写response
+    bool prepareRegisteredFace(const UserInfo& user, cv::Mat& registered, Json::Value& response);
+    
+    // 在当前CPU工作线程上依次执行会话帧的各评分步骤（分别计入各阶段的执行时间），会话已判定时放弃
+    void runSessionFrame(AuthSession& session, const std::string& face_data);
+    
+    // 认证成功时按配置签发令牌，写入response的token与token_expires
+    void attachToken(int user_id, Json::Value& response);
+    
+    // 检查图像质量，不合格时按原因计数（在质量阶段执行）
+    QualityResult checkQuality(const cv::Mat& image);
+    
+    // 在解码任务内解码并检查质量，省去一次线程池往返；质量检查作为子阶段单独计时（也计入解码阶段的执行时间）
+    // 解码失败时返回空图像，quality为OK
+    cv::Mat decodeChecked(const std::string& face_data, QualityResult& quality);
+    
     // 确保必要的目录存在
     void ensureDirectories();
     
+    // 启动/停止后台存储维护线程
+    void startMaintenance();
+    void stopMaintenance();
+    
     // 从Base64字符串解码图像
     cv::Mat decodeImage(const std::string& base64_image);
     
     // 将图像编码为Base64字符串
     std::string encodeImage(const cv::Mat& image);
+    
+    // 生成要保存的注册人脸：标准化人脸（灰度PNG），按配置在其前保留原图
+    std::vector<FaceImage> buildEnrollmentFaces(const std::string& face_data, const cv::Mat& face_roi);
+    
+    // 读取用户的注册人脸：标准化人脸返回灰度图，旧数据返回原始图像（需再检测）
+    cv::Mat readRegisteredFace(const UserInfo& user);
+    
+    // 检测人脸并返回最大的人脸区域，未检测到时返回false（在检测阶段执行）
+    bool detectLargestFace(const cv::Mat& image, cv::Rect& face);
+    
+    // 交给认证事件写入器（内存队列或预写日志），不等待写入数据库
+    void logAuthEvent(int user_id, bool success, const std::string& details);
 
     FaceDetector face_detector_;
     FaceRecognizer face_recognizer_;
-    DBManager db_manager_;
+    std::unique_ptr<Storage> storage_;
+    AuthEventWriter auth_writer_;
+    UserCache user_cache_;
+    EnrollmentTrainer enrollment_trainer_;
+    AdminServer admin_server_;
+    FrameRing frame_ring_;
+    TokenManager token_manager_;
+    Executor cpu_executor_;       // 图像解码、检测与匹配线程池，线程数默认等于CPU核数
+    Executor io_executor_;        // 数据库与文件I/O专用线程池
+    
+    // 请求流水线各阶段，按资源类型绑定线程池
+    PipelineStage parse_stage_;       // 接收与解析（连接线程）
+    PipelineStage lookup_stage_;      // 用户查询与注册人脸读取（I/O）
+    PipelineStage decode_stage_;      // 图像解码（CPU）
+    PipelineStage quality_stage_;     // 图像质量门限（CPU），在检测前拒绝模糊、过暗过亮与过小的图像
+    PipelineStage detect_stage_;      // 人脸检测（CPU）
+    PipelineStage preprocess_stage_;  // 人脸预处理与标准化人脸编码（CPU）
+    PipelineStage match_stage_;       // LBPH比较（CPU）
+    PipelineStage persist_stage_;     // 用户数据与认证事件写入（I/O）
+    
+    AsyncStorage async_storage_;  // 读写分别在lookup_stage_与persist_stage_上执行
     
     std::string model_path_;
-    std::string db_host_;
-    std::string db_user_;
-    std::string db_password_;
-    std::string db_name_;
+    DBConfig db_config_;
+    AuthWriterConfig auth_writer_config_;
+    UserCacheConfig user_cache_config_;
+    BlobStoreConfig blob_store_config_;
+    EnrollmentTrainerConfig enrollment_trainer_config_;
+    LoggerConfig logger_config_;
+    CaptureConfig capture_config_;
+    SessionConfig session_config_;
+    QualityConfig quality_config_;
+    TokenConfig token_config_;
+    std::string admin_socket_path_;   // 为空时不启动管理套接字
+    bool stats_message_enabled_;
+    ExecutorConfig cpu_executor_config_;
+    ExecutorConfig io_executor_config_;
+    
+    // 注册时是否在标准化人脸之外保留原始图像
+    bool keep_original_face_;
+    
+    // Mat内存池配置
+    bool mat_pool_enabled_;
+    size_t mat_pool_thread_cache_bytes_;
+    size_t mat_pool_max_cached_bytes_;
+    
+    // 存储维护线程
+    std::thread maintenance_thread_;
+    std::mutex maintenance_mutex_;
+    std::condition_variable maintenance_cv_;
+    bool maintenance_stop_;
     
     bool running_;
     std::mutex mutex_;
@@ -0,0 +1,105 @@
+#ifndef AUTH_SESSION_H
+#define AUTH_SESSION_H
+
+#include <opencv2/opencv.hpp>
+#include <json/json.h>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+
+// 多帧认证会话配置
+struct SessionConfig {
+    bool enabled;
+    size_t max_frames;       // 每个会话最多评分的帧数，达到后按已有结果判定
+    size_t max_in_flight;    // 同时评分的帧数上限，超出时丢弃新到的帧而不排队
+    double margin;           // 单帧证据 = (阈值 - 距离) / margin，截断到[-1, 1]
+    double accept_bound;     // 累计证据达到该值即通过
+    double reject_bound;     // 累计证据低于其相反数即拒绝
+    int timeout_ms;          // 会话最长持续时间，超时后按已有结果判定
+
+    SessionConfig()
+        : enabled(true), max_frames(10), max_in_flight(4), margin(20.0),
+          accept_bound(1.0), reject_bound(2.0), timeout_ms(10000) {
+    }
+};
+
+enum class SessionDecision {
+    PENDING,
+    ACCEPTED,
+    REJECTED,
+    CANCELLED     // 客户端断开或出错，不发送结果
+};
+
+// 一次多帧登录：客户端在同一连接上连续发送多帧，各帧在流水线上并行评分，
+// 分数累加为证据，越过通过或拒绝边界即判定；判定后尚未执行的评分步骤直接放弃
+// 未越过边界时，在客户端结束发送（或达到max_frames）且所有帧评分完成后按证据正负判定，
+// 单帧会话因此与普通登录的阈值一致；超过timeout_ms时不再等待评分中的帧，按已有证据判定
+class AuthSession {
+public:
+    AuthSession(const SessionConfig& config, int user_id, double threshold, const cv::Mat& registered_face);
+    ~AuthSession();
+
+    AuthSession(const AuthSession&) = delete;
+    AuthSession& operator=(const AuthSession&) = delete;
+
+    // 判定时可读的eventfd（供连接线程与套接字一起poll），创建失败时为-1
+    int notifyFd() const { return notify_fd_; }
+
+    int userId() const { return user_id_; }
+
+    // 已标准化的注册人脸，评分线程只读
+    const cv::Mat& registeredFace() const { return registered_face_; }
+
+    // 登记一帧开始评分；已判定、已结束、达到max_frames或评分中的帧过多时返回false，该帧不评分
+    bool tryStartFrame();
+
+    // 一帧的结果，每个已登记的帧恰好调用其中之一
+    void addScore(double distance);
+    void frameFailed();        // 解码失败、未检测到人脸等，不计证据
+    void frameCancelled();     // 已判定后放弃评分
+
+    // 客户端不再发送帧
+    void endOfStream();
+
+    // 会话超时：不再等待评分中的帧，立即按已有证据的正负判定
+    void expire();
+
+    // 客户端断开或出错，放弃会话
+    void cancel();
+
+    // 评分步骤开始前检查，已判定时放弃该帧
+    bool isDecided() const { return decided_.load(std::memory_order_acquire); }
+
+    SessionDecision decision() const;
+
+    // 帧数、证据与是否超时判定的摘要（日志与响应）
+    Json::Value summary() const;
+
+private:
+    // 以下在持有mutex_时调用
+    void decideLocked();
+    void setDecisionLocked(SessionDecision decision);
+
+    SessionConfig config_;
+    int user_id_;
+    double threshold_;
+    cv::Mat registered_face_;
+    int notify_fd_;
+
+    mutable std::mutex mutex_;
+    SessionDecision decision_;
+    std::atomic<bool> decided_;
+    bool end_of_stream_;
+    bool timed_out_;
+    size_t submitted_;
+    size_t in_flight_;
+    size_t scored_;
+    size_t failed_;
+    size_t cancelled_;
+    size_t skipped_;
+    double evidence_;
+    double best_distance_;
+};
+
+#endif // AUTH_SESSION_H
@@ -0,0 +1,87 @@
+#ifndef BLOB_STORE_H
+#define BLOB_STORE_H
+
+#include <string>
+#include <vector>
+#include <set>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// 人脸图像存储配置
+struct BlobStoreConfig {
+    std::string root;       // 根目录
+    bool fsync;             // 是否同步落盘（基准测试可关闭）
+    int group_commit_us;    // 组提交等待窗口，只在有其他写入正在进行时等待，批次内相同目录只同步一次
+
+    BlobStoreConfig() : root("face_auth_data/faces"), fsync(true), group_commit_us(2000) {
+    }
+};
+
+// 人脸图像存储统计
+struct BlobStoreStats {
+    size_t writes;         // 实际写入的文件数
+    size_t dedup_hits;     // 内容已存在而跳过写入的次数
+    size_t bytes;          // 写入字节数
+    size_t sync_batches;   // fsync批次数
+};
+
+// 内容寻址的图像存储
+// 文件以内容SHA-256命名，按哈希前两字节分两级目录：<root>/ab/cd/<hash><ext>
+// 相同内容只保存一份；写入先写临时文件再rename，每个文件各自fdatasync，
+// 并发写入合并为一批，批次内相同目录的fsync只做一次
+class BlobStore {
+public:
+    static BlobStore& instance();
+
+    void configure(const BlobStoreConfig& config);
+
+    // 保存数据，返回相对路径，失败返回空字符串；返回时文件已落盘（fsync开启时）
+    std::string put(const std::string& data, const std::string& extension);
+
+    BlobStoreStats getStats() const;
+
+    // 按文件头判断图像扩展名（.png/.jpg，未知时为.bin）
+    static std::string imageExtension(const std::string& data);
+
+private:
+    BlobStore();
+
+    // 一次写入：临时文件已写完，等待同步与rename
+    struct PendingWrite {
+        int fd;
+        std::string temp_path;
+        std::string final_path;
+        std::string dir;
+        bool ok;
+        bool done;
+    };
+
+    // 确保两级目录存在（已创建的目录会缓存）
+    bool ensureDirectory(const std::string& dir);
+
+    // 组提交：同一批次由第一个到达的线程（leader）统一fsync、rename并同步目录
+    bool commit(PendingWrite& write);
+
+    // 写入临时文件失败，未进入commit时调用
+    void abandonWrite();
+    void syncBatch(std::vector<PendingWrite*>& batch);
+
+    BlobStoreConfig config_;
+
+    std::mutex mutex_;
+    std::condition_variable committed_;
+    std::vector<PendingWrite*> pending_;
+    bool leader_active_;
+    size_t writing_;                   // 正在写临时文件、尚未进入commit的写入数
+    std::condition_variable arrived_;  // 写入进入commit（或放弃）时通知leader
+    std::set<std::string> known_dirs_;
+
+    std::atomic<size_t> temp_counter_;
+    std::atomic<size_t> writes_;
+    std::atomic<size_t> dedup_hits_;
+    std::atomic<size_t> bytes_;
+    std::atomic<size_t> sync_batches_;
+};
+
+#endif // BLOB_STORE_H
@@ -0,0 +1,147 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <json/json.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+
+// 请求抓包配置
+struct CaptureConfig {
+    bool enabled;               // 默认关闭
+    std::string path;           // 当前抓包文件，轮转后依次为 path.1 ... path.<max_files-1>
+    double sample_rate;         // 采样率（0~1），按请求计数确定性采样
+    int64_t payload_bytes;      // 每帧保留的人脸数据字节数，-1为全部保留，0为不保留
+    size_t max_file_bytes;      // 单个文件达到该大小后轮转
+    int max_files;              // 最多保留的文件数（含当前文件）
+    size_t queue_size;          // 待写入帧的队列容量，满时丢弃，不阻塞请求线程
+    size_t ring_size;           // 内存中保留最近的帧数（调试用，与enabled无关），0为关闭
+    double ring_sample_rate;    // 放入内存环形缓冲的采样率
+
+    CaptureConfig()
+        : enabled(false), path("face_auth_data/capture/requests.fcap"), sample_rate(0.01),
+          payload_bytes(-1), max_file_bytes(64 * 1024 * 1024), max_files(4), queue_size(256),
+          ring_size(16), ring_sample_rate(1.0) {
+    }
+};
+
+// 抓包文件中的一条请求
+struct CaptureRecord {
+    uint64_t timestamp_us;      // 接收时刻（Unix时间，微秒）
+    Json::Value request;        // 请求JSON，密码已脱敏
+    std::string face_data;      // 保留的人脸数据，可能被截断或为空
+    uint32_t face_data_size;    // 原始人脸数据大小
+
+    bool payloadComplete() const { return face_data.size() == face_data_size; }
+};
+
+// 抓包文件格式：文件头 'FCAP' + 版本（4字节），之后每条记录为
+// 记录长度（4字节）+ 时间戳（8字节）+ 原始人脸数据大小（4字节）+ JSON长度（4字节）+ JSON + 保留的人脸数据
+// 整数均为小端序；进程崩溃时文件末尾可能有不完整的记录，读取时忽略
+
+// 采样记录请求帧
+// 请求线程只做计数采样并复制帧（按保留策略截断人脸数据），脱敏与写文件在后台线程完成
+class CaptureWriter {
+public:
+    CaptureWriter();
+    ~CaptureWriter();
+
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    // 打开抓包文件并启动写入线程
+    bool start(const CaptureConfig& config);
+
+    // 写完队列中剩余的帧后停止
+    void stop();
+
+    bool isRunning() const { return running_.load(std::memory_order_relaxed); }
+
+    // 提交一个已完整接收的请求帧，未被采样或队列已满时直接返回
+    void offer(const char* frame, size_t size);
+
+private:
+    struct PendingFrame {
+        uint64_t timestamp_us;
+        uint32_t face_data_size;
+        std::string frame;      // 帧头 + JSON + 保留的人脸数据
+    };
+
+    void run();
+
+    // 写入一条记录，必要时轮转文件
+    bool write(const std::string& record);
+
+    bool openFile();
+    void rotate();
+
+    CaptureConfig config_;
+    std::ofstream file_;
+    size_t file_bytes_;
+
+    std::deque<PendingFrame> queue_;
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::thread thread_;
+    std::atomic<bool> running_;
+    std::atomic<uint64_t> offered_;
+};
+
+// 最近N个请求帧的内存环形缓冲（调试用），替代逐请求写调试文件
+// 请求线程在锁外复制帧，锁内只交换槽位；按需导出为抓包文件与人脸图片
+class FrameRing {
+public:
+    FrameRing();
+
+    FrameRing(const FrameRing&) = delete;
+    FrameRing& operator=(const FrameRing&) = delete;
+
+    // 设置容量与采样率并清空已有的帧，在开始接收请求前调用
+    void configure(size_t capacity, double sample_rate);
+
+    // 提交一个已完整接收的请求帧
+    void offer(const char* frame, size_t size);
+
+    // 导出到目录：frames.fcap（密码已脱敏，可用face_auth_replay回放）与每帧的人脸数据 face-<序号>.jpg
+    // 返回导出的帧数，失败返回-1
+    int dump(const std::string& dir);
+
+private:
+    struct Slot {
+        uint64_t timestamp_us;
+        std::string frame;
+    };
+
+    std::vector<Slot> slots_;
+    size_t next_;               // 下一个写入的槽位
+    uint64_t sequence_;         // 已写入的帧数
+    double sample_rate_;
+    std::atomic<uint64_t> offered_;
+    std::mutex mutex_;
+};
+
+// 顺序读取抓包文件
+class CaptureReader {
+public:
+    CaptureReader();
+
+    bool open(const std::string& path);
+
+    // 读取下一条记录，文件结束或遇到不完整的记录时返回false
+    bool next(CaptureRecord& record);
+
+    // 是否因不完整或损坏的记录提前结束
+    bool truncated() const { return truncated_; }
+
+private:
+    std::ifstream file_;
+    bool truncated_;
+};
+
+#endif // CAPTURE_H
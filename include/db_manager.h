@@ -1,63 +1,105 @@
 #ifndef DB_MANAGER_H
 #define DB_MANAGER_H
 
+#include "storage.h"
+#include "db_pool.h"
 #include <mysql/mysql.h>
 #include <string>
 #include <vector>
 #include <map>
 
-struct UserInfo {
-    int id;
-    std::string username;
-    std::string file_path;
-    std::string created_at;
-};
-
-class DBManager {
+// MySQL存储后端
+class DBManager : public Storage {
 public:
     DBManager();
-    ~DBManager();
+    ~DBManager() override;
+    
+    const char* backendName() const override { return "mysql"; }
     
     // 连接数据库
     bool connect(const std::string& host, const std::string& user, 
                  const std::string& password, const std::string& database);
     
+    // 使用完整配置连接数据库（包括连接池参数）
+    bool connect(const DBConfig& config) override;
+    
     // 断开连接
-    void disconnect();
+    void disconnect() override;
     
     // 创建用户表
-    bool createTables();
+    bool createTables() override;
     
     // 添加用户
-    bool addUser(const std::string& username, const std::string& password, const std::string& face_data);
+    bool addUser(const std::string& username, const std::string& password,
+                 const std::vector<FaceImage>& faces) override;
     
     // 存储人脸数据
-    bool storeFaceData(int user_id, const std::string& face_data, const std::string& type);
+    bool storeFaceData(int user_id, const FaceImage& face, const std::string& type) override;
     
     // 更新用户的人脸数据
-    bool updateUserFace(int user_id, const std::string& face_data);
+    bool updateUserFace(int user_id, const std::vector<FaceImage>& faces) override;
     
-    // 获取所有用户
-    std::vector<UserInfo> getAllUsers();
+    // 流式遍历全部用户（mysql_use_result逐行读取）
+    bool forEachUser(const std::function<bool(const UserInfo&)>& visitor) override;
     
     // 根据ID获取用户
-    UserInfo getUserById(int user_id);
+    UserInfo getUserById(int user_id) override;
     
-    // 根据用户名获取用户
-    UserInfo getUserByUsername(const std::string& username);
+    // 根据用户名获取用户（一次查询同时返回密码哈希与最新注册人脸）
+    UserInfo getUserByUsername(const std::string& username) override;
     
     // 获取用户密码
-    std::string getUserPassword(int user_id);
+    std::string getUserPassword(int user_id) override;
     
     // 记录认证日志
-    bool logAuthentication(int user_id, bool success, const std::string& details);
+    bool logAuthentication(int user_id, bool success, const std::string& details) override;
     
     // 更新用户最后登录时间
-    bool updateLastLogin(int user_id);
+    bool updateLastLogin(int user_id) override;
+    
+    // 批量记录认证日志
+    bool insertAuthLogs(const std::vector<AuthLogEntry>& entries) override;
+    
+    // 批量记录登录人脸记录
+    bool insertLoginRecords(const std::vector<LoginRecord>& records) override;
+    
+    // 批量更新最后登录时间（用户ID -> 时间）
+    bool updateLastLogins(const std::map<int, std::string>& last_logins) override;
+    
+    // 在一个事务内写入预写日志段并推进检查点
+    bool applyAuthEventBatch(const std::string& source, uint64_t sequence,
+                             const std::vector<AuthLogEntry>& logs,
+                             const std::vector<LoginRecord>& logins,
+                             const std::map<int, std::string>& last_logins) override;
+    
+    // 获取预写日志检查点
+    bool getAuthEventCheckpoint(const std::string& source, uint64_t& sequence) override;
+    bool supportsAuthEventCheckpoint() const override { return true; }
+    
+    // 获取预处理语句的准备/执行统计
+    DBStatementStats getStatementStats() const override;
+    
+    // auth_logs分区维护：创建未来的日分区，删除过期分区
+    bool runMaintenance() override;
 
 private:
-    MYSQL* mysql_;
+    // 以下实现在调用方借出的连接上执行，便于在同一连接上组合多个操作
+    bool createTables(PooledConnection& conn);
+    bool storeFaceData(PooledConnection& conn, int user_id, const FaceImage& face, const std::string& type);
+    UserInfo getUserById(PooledConnection& conn, int user_id);
+    UserInfo getUserByUsername(PooledConnection& conn, const std::string& username);
+    bool getAuthLogPartitions(PooledConnection& conn, std::vector<std::string>& partitions);
+    bool insertAuthLogs(PooledConnection& conn, const std::vector<AuthLogEntry>& entries);
+    bool insertLoginRecords(PooledConnection& conn, const std::vector<LoginRecord>& records);
+    bool updateLastLogins(PooledConnection& conn, const std::map<int, std::string>& last_logins);
+    bool getAuthEventCheckpoint(PooledConnection& conn, const std::string& source,
+                                uint64_t& sequence, bool for_update);
+
+    DBConnectionPool pool_;
     bool connected_;
+    bool auth_logs_partitioned_;
+    int retention_days_;        // 认证日志保留天数，<=0表示不删除
+    int partition_ahead_days_;  // 提前创建的日分区天数
 };
 
 #endif // DB_MANAGER_H 
\ No newline at end of file
@@ -0,0 +1,109 @@
+#ifndef DB_POOL_H
+#define DB_POOL_H
+
+#include "storage.h"
+#include <mysql/mysql.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+// 连接池中的单个连接
+struct DBConnection {
+    MYSQL* mysql;
+    bool broken;                                      // 出现连接级错误，下次借出前重连
+    std::chrono::steady_clock::time_point last_used;  // 最近一次归还时间
+    std::unordered_map<std::string, MYSQL_STMT*> statements;  // 本连接上已准备的语句（按SQL文本）
+
+    DBConnection() : mysql(nullptr), broken(true) {
+    }
+};
+
+// MySQL连接池
+// 每个请求借出一个独占连接，libmysqlclient句柄不会被多个线程同时使用
+class DBConnectionPool {
+public:
+    DBConnectionPool();
+    ~DBConnectionPool();
+
+    // 建立全部连接；已有连接借出未归还时返回false
+    bool initialize(const DBConfig& config);
+
+    // 关闭全部连接
+    void shutdown();
+
+    // 借出一个可用连接，超时或重连失败返回nullptr
+    DBConnection* acquire();
+
+    // 归还连接
+    void release(DBConnection* conn);
+
+    // 获取连接上缓存的预处理语句，不存在时准备并缓存
+    MYSQL_STMT* prepare(DBConnection& conn, const char* sql);
+
+    // 执行预处理语句并计数
+    bool execute(DBConnection& conn, MYSQL_STMT* stmt);
+
+    // 获取预处理语句统计
+    DBStatementStats getStatementStats() const;
+
+    // 判断错误码是否表示连接已失效
+    static bool isConnectionError(unsigned int error_code);
+
+    bool isRunning() const;
+
+private:
+    // 打开连接（依次尝试本地socket与TCP/IP，必要时创建数据库）
+    bool openConnection(DBConnection& conn);
+
+    // 关闭连接句柄
+    void closeConnection(DBConnection& conn);
+
+    // 借出前的健康检查，必要时重连
+    bool ensureHealthy(DBConnection& conn);
+
+    DBConfig config_;
+    std::vector<std::unique_ptr<DBConnection>> connections_;
+    std::vector<DBConnection*> idle_;
+    mutable std::mutex mutex_;
+    std::condition_variable available_;
+    bool running_;
+    size_t borrowed_;    // 已借出未归还的连接数
+
+    std::atomic<size_t> prepares_;
+    std::atomic<size_t> executes_;
+    std::atomic<size_t> cache_hits_;
+};
+
+// 借出连接的RAII封装，析构时自动归还
+class PooledConnection {
+public:
+    explicit PooledConnection(DBConnectionPool& pool);
+    ~PooledConnection();
+
+    PooledConnection(const PooledConnection&) = delete;
+    PooledConnection& operator=(const PooledConnection&) = delete;
+
+    explicit operator bool() const { return conn_ != nullptr; }
+
+    MYSQL* get() const { return conn_ ? conn_->mysql : nullptr; }
+
+    // 获取（必要时准备）缓存的预处理语句，语句归连接所有，调用方不得关闭
+    MYSQL_STMT* prepare(const char* sql);
+
+    // 执行预处理语句
+    bool execute(MYSQL_STMT* stmt);
+
+    // 检查错误码，连接级错误时标记连接失效
+    void checkError(unsigned int error_code);
+
+private:
+    DBConnectionPool& pool_;
+    DBConnection* conn_;
+};
+
+#endif // DB_POOL_H
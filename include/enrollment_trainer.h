@@ -0,0 +1,115 @@
+#ifndef ENROLLMENT_TRAINER_H
+#define ENROLLMENT_TRAINER_H
+
+#include "face_recognizer.h"
+#include "storage.h"
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+
+// 注册训练配置
+struct EnrollmentTrainerConfig {
+    size_t batch_size;        // 单批最多训练的人脸数
+    int flush_interval_ms;    // 队列未满一批时的最长等待时间
+    bool reconcile_on_start;  // 启动时补训数据库中已注册但不在模型中的用户
+
+    EnrollmentTrainerConfig() : batch_size(64), flush_interval_ms(500), reconcile_on_start(true) {
+    }
+};
+
+// 注册训练统计
+struct EnrollmentTrainerStats {
+    size_t enqueued;    // 入队人脸数
+    size_t trained;     // 已加入模型的人脸数
+    size_t failed;      // 训练失败的人脸数
+    size_t batches;     // 训练批次数（每批保存一次模型）
+    size_t reconciled;  // 启动时补训的用户数
+    size_t pending;     // 等待训练的人脸数
+};
+
+// 用户在识别模型中的状态
+enum class EnrollmentStatus {
+    UNKNOWN,   // 不在模型中，也没有待训练的人脸
+    PENDING,   // 已入队，等待训练
+    LIVE,      // 已加入模型
+    FAILED     // 最近一次训练失败
+};
+
+// 后台注册训练器
+// 注册与更新人脸时模板已落盘（BlobStore与数据库），请求只需入队即可返回；
+// 后台线程按批增量更新LBPH模型并只保存一次。进程崩溃时队列中的人脸由启动时的补训恢复
+class EnrollmentTrainer {
+public:
+    EnrollmentTrainer();
+    ~EnrollmentTrainer();
+
+    EnrollmentTrainer(const EnrollmentTrainer&) = delete;
+    EnrollmentTrainer& operator=(const EnrollmentTrainer&) = delete;
+
+    // 启动训练线程（启用补训时先在训练线程上补训）
+    bool start(FaceRecognizer& recognizer, Storage& storage, const EnrollmentTrainerConfig& config);
+
+    // 停止训练线程，队列中剩余人脸全部训练完后返回
+    void stop();
+
+    // 入队待训练的人脸（未启动时直接训练）
+    void enqueue(int user_id, const cv::Mat& face);
+
+    // 查询用户的训练状态
+    EnrollmentStatus status(int user_id);
+
+    // 状态名称：unknown / pending / live / failed
+    static const char* statusName(EnrollmentStatus status);
+
+    EnrollmentTrainerStats getStats() const;
+
+private:
+    struct Job {
+        int user_id;
+        cv::Mat face;
+        uint64_t sequence;  // 入队序号
+    };
+
+    // 每个用户最近一次入队与完成的序号
+    struct UserState {
+        uint64_t queued;
+        uint64_t done;
+        bool failed;
+    };
+
+    // 训练线程
+    void run();
+
+    // 补训：数据库中有标准化人脸但不在模型中的用户
+    void reconcile();
+
+    // 训练一批人脸并更新各用户状态
+    void trainBatch(std::vector<Job>& batch);
+
+    FaceRecognizer* recognizer_;
+    Storage* storage_;
+    EnrollmentTrainerConfig config_;
+
+    std::deque<Job> queue_;
+    std::unordered_map<int, UserState> states_;
+    uint64_t next_sequence_;
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::thread thread_;
+    bool running_;
+
+    std::atomic<size_t> enqueued_;
+    std::atomic<size_t> trained_;
+    std::atomic<size_t> failed_;
+    std::atomic<size_t> batches_;
+    std::atomic<size_t> reconciled_;
+};
+
+#endif // ENROLLMENT_TRAINER_H
@@ -0,0 +1,107 @@
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <future>
+#include <type_traits>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// 线程池配置
+struct ExecutorConfig {
+    size_t threads;      // 工作线程数
+    size_t queue_size;   // 队列容量，满时提交方阻塞（背压）
+
+    ExecutorConfig() : threads(4), queue_size(4096) {
+    }
+};
+
+// 线程池统计
+struct ExecutorStats {
+    size_t threads;
+    size_t submitted;        // 提交的任务数
+    size_t completed;        // 完成的任务数
+    size_t blocked;          // 因队列满而阻塞的提交次数
+    size_t queue_depth;      // 当前排队的任务数
+    size_t max_queue_depth;  // 排队任务数峰值
+    size_t active;           // 正在执行的任务数
+    double avg_wait_us;      // 平均排队时间
+    double avg_run_us;       // 平均执行时间
+};
+
+// 固定大小的线程池，按资源类型（CPU / I/O）分别创建
+// 任务按提交顺序执行；未启动或已停止时任务在提交线程上直接执行
+class Executor {
+public:
+    explicit Executor(const std::string& name);
+    ~Executor();
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    // 启动工作线程
+    bool start(const ExecutorConfig& config);
+
+    // 停止工作线程，队列中剩余任务全部执行完后返回
+    void stop();
+
+    // 提交任务（回调风格），队列满时阻塞
+    void post(std::function<void()> task);
+
+    // 提交任务，通过future取得结果（任务抛出的异常在get()时重新抛出）
+    template <typename F>
+    std::future<typename std::result_of<F()>::type> submit(F&& func) {
+        typedef typename std::result_of<F()>::type Result;
+        std::shared_ptr<std::packaged_task<Result()>> task =
+            std::make_shared<std::packaged_task<Result()>>(std::forward<F>(func));
+        std::future<Result> result = task->get_future();
+        post([task]() { (*task)(); });
+        return result;
+    }
+
+    const std::string& name() const { return name_; }
+
+    bool isRunning() const;
+
+    ExecutorStats getStats() const;
+
+private:
+    struct Task {
+        std::function<void()> func;
+        std::chrono::steady_clock::time_point enqueued;
+    };
+
+    // 工作线程
+    void run();
+
+    // 执行任务，捕获异常避免工作线程退出
+    void execute(Task& task);
+
+    std::string name_;
+    ExecutorConfig config_;
+
+    std::deque<Task> queue_;
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::vector<std::thread> threads_;
+    bool running_;
+    size_t max_queue_depth_;
+
+    std::atomic<size_t> submitted_;
+    std::atomic<size_t> completed_;
+    std::atomic<size_t> blocked_;
+    std::atomic<size_t> active_;
+    std::atomic<uint64_t> wait_us_;
+    std::atomic<uint64_t> run_us_;
+};
+
+#endif // EXECUTOR_H
@@ -6,12 +6,18 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <utility>
+#include <mutex>
 
+// LBPH人脸识别器，可被多个线程同时使用
 class FaceRecognizer {
 public:
     FaceRecognizer();
     ~FaceRecognizer();
     
+    // 是否从磁盘加载并在训练后保存模型（默认开启），需在initialize之前设置；基准测试等场景关闭以避免磁盘I/O
+    void setPersistent(bool persistent) { persistent_ = persistent; }
+    
     // 初始化识别器
     bool initialize();
     
@@ -24,6 +30,16 @@ public:
     // 训练识别器
     bool train(int user_id, const cv::Mat& face);
     
+    // 批量训练：一次加入多张人脸（用户ID, 人脸），增量更新模型并只保存一次
+    // trained[i]表示第i张是否已加入模型，返回成功加入的张数
+    size_t trainBatch(const std::vector<std::pair<int, cv::Mat>>& samples, std::vector<bool>& trained);
+    
+    // 用户是否已在训练集中
+    bool hasUser(int user_id);
+    
+    // 训练集中的用户ID
+    std::vector<int> userIds();
+    
     // 识别人脸
     std::pair<int, double> recognize(const cv::Mat& face);
     
@@ -34,7 +50,13 @@ public:
     bool loadModel(const std::string& filename = "face_model.yml");
 
 private:
+    // 以下在持有mutex_时调用
+    void collectTrainingData(std::vector<cv::Mat>& faces, std::vector<int>& labels) const;
+    bool saveModelLocked(const std::string& filename);
+
     bool initialized_;
+    bool persistent_;
+    std::mutex mutex_;  // 保护lbph_model_与training_faces_，请求在多个线程上并发识别与训练
     cv::Ptr<cv::face::LBPHFaceRecognizer> lbph_model_;
     std::map<int, std::vector<cv::Mat>> training_faces_; // 用户ID -> 训练人脸
 };
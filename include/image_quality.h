@@ -0,0 +1,50 @@
+#ifndef IMAGE_QUALITY_H
+#define IMAGE_QUALITY_H
+
+#include <opencv2/opencv.hpp>
+
+// 人脸检测前的图像质量门限
+struct QualityConfig {
+    bool enabled;
+    int min_width;           // 原图最小宽高（像素）
+    int min_height;
+    int analysis_size;       // 在长边缩小到该尺寸的灰度图上计算下列指标
+    double min_sharpness;    // 拉普拉斯方差下限，低于时判为模糊
+    double min_brightness;   // 平均亮度范围（0~255）
+    double max_brightness;
+
+    QualityConfig()
+        : enabled(true), min_width(80), min_height(80), analysis_size(160),
+          min_sharpness(15.0), min_brightness(40.0), max_brightness(220.0) {
+    }
+};
+
+enum class QualityResult {
+    OK,
+    TOO_SMALL,
+    UNDEREXPOSED,
+    OVEREXPOSED,
+    BLURRY
+};
+
+// 质量指标（日志与基准测试）
+struct QualityMetrics {
+    double sharpness;
+    double brightness;
+
+    QualityMetrics() : sharpness(0.0), brightness(0.0) {
+    }
+};
+
+// 检查解码后的图像，依次判断分辨率、曝光与清晰度，返回第一个不满足的条件
+// 只处理缩小后的灰度图，代价远低于级联检测；metrics非空时写入计算出的指标
+QualityResult checkImageQuality(const cv::Mat& image, const QualityConfig& config,
+                                QualityMetrics* metrics = nullptr);
+
+// 拒绝原因（统计标签），OK返回"ok"
+const char* qualityReason(QualityResult result);
+
+// 返回给客户端的提示
+const char* qualityMessage(QualityResult result);
+
+#endif // IMAGE_QUALITY_H
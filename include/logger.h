@@ -0,0 +1,220 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <string>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+// 编译期最低日志级别（0=TRACE 1=DEBUG 2=INFO 3=WARN 4=ERROR），
+// 低于该级别的日志语句整体被编译器移除，参数表达式也不会求值
+#ifndef FACE_AUTH_LOG_MIN_LEVEL
+#define FACE_AUTH_LOG_MIN_LEVEL 1
+#endif
+
+// 日志级别
+enum class LogLevel {
+    TRACE = 0,
+    DEBUG = 1,
+    INFO = 2,
+    WARN = 3,
+    ERROR = 4,
+    OFF = 5
+};
+
+// 日志子系统，每个子系统的运行时级别可单独配置
+enum class LogSubsystem {
+    SERVER = 0,   // 启动、停止与配置
+    NET,          // TCP收发与协议解析
+    AUTH,         // 注册、认证流程
+    FACE,         // 人脸检测、识别与训练
+    STORAGE,      // 数据库与文件存储
+    COUNT
+};
+
+// 输出格式
+enum class LogFormat {
+    TEXT,   // 可读文本行
+    JSON    // 每行一个JSON对象，便于日志采集
+};
+
+// 日志配置
+struct LoggerConfig {
+    LogLevel level;                                        // 默认运行时级别
+    LogLevel subsystem_levels[static_cast<int>(LogSubsystem::COUNT)];  // 各子系统级别
+    LogFormat format;
+    std::string file;           // 输出文件，为空时INFO及以下写stdout，WARN及以上写stderr
+    size_t queue_size;          // 环形缓冲区容量（向上取整为2的幂），满时丢弃新日志
+    int flush_interval_ms;      // 缓冲区为空时后台线程的轮询间隔
+
+    LoggerConfig() : level(LogLevel::INFO), format(LogFormat::TEXT),
+                     queue_size(8192), flush_interval_ms(10) {
+        for (LogLevel& l : subsystem_levels) {
+            l = level;
+        }
+    }
+};
+
+// 日志统计
+struct LoggerStats {
+    size_t written;   // 已输出的日志条数
+    size_t dropped;   // 缓冲区满时丢弃的条数
+};
+
+// 单条日志记录，定长以便放入环形缓冲区，超长消息被截断
+struct LogRecord {
+    static const size_t MAX_TEXT = 232;
+
+    int64_t timestamp_us;     // 墙钟时间（微秒）
+    uint32_t thread_id;       // 进程内线程序号
+    uint8_t level;
+    uint8_t subsystem;
+    uint16_t length;
+    char text[MAX_TEXT];
+};
+
+// 有界多生产者多消费者无锁环形队列（每个槽位带序号）
+class LogRing {
+public:
+    explicit LogRing(size_t capacity);
+
+    LogRing(const LogRing&) = delete;
+    LogRing& operator=(const LogRing&) = delete;
+
+    // 入队，队列满时立即返回false
+    bool push(const LogRecord& record);
+
+    // 出队，队列空时返回false
+    bool pop(LogRecord& record);
+
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        LogRecord record;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_;
+    char pad0_[64];
+    std::atomic<size_t> enqueue_pos_;   // 生产者与消费者位置分处不同缓存行
+    char pad1_[64];
+    std::atomic<size_t> dequeue_pos_;
+};
+
+// 异步日志：请求线程只把定长记录放入无锁环形缓冲区，
+// 后台线程批量格式化并一次write输出；未启动时同步输出
+class Logger {
+public:
+    static Logger& instance();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    // 按配置启动后台输出线程
+    bool start(const LoggerConfig& config);
+
+    // 输出缓冲区中剩余的日志并停止后台线程
+    void stop();
+
+    // 判断某子系统在该级别是否输出
+    bool isEnabled(LogLevel level, LogSubsystem subsystem) const {
+        return static_cast<int>(level) >=
+               levels_[static_cast<int>(subsystem)].load(std::memory_order_relaxed);
+    }
+
+    // 运行时调整子系统级别
+    void setLevel(LogSubsystem subsystem, LogLevel level);
+
+    // 提交一条日志
+    void submit(const LogRecord& record);
+
+    LoggerStats getStats() const;
+
+    // 名称与级别、子系统、格式之间的转换，无法识别时返回false
+    static bool parseLevel(const std::string& name, LogLevel& level);
+    static bool parseSubsystem(const std::string& name, LogSubsystem& subsystem);
+    static bool parseFormat(const std::string& name, LogFormat& format);
+    static const char* levelName(LogLevel level);
+    static const char* subsystemName(LogSubsystem subsystem);
+
+private:
+    Logger();
+
+    // 后台输出线程
+    void run();
+
+    // 格式化一条记录并追加到输出缓冲区
+    void format(const LogRecord& record, std::string& out) const;
+
+    // 写出缓冲区
+    void writeAll(int fd, const std::string& data);
+
+    // 输出一条记录（未启动时直接调用）
+    void writeRecord(const LogRecord& record);
+
+    // 在调用线程上输出缓冲区中剩余的记录（持有mutex_时调用），用于后台线程退出之后
+    void drainLocked();
+
+    LoggerConfig config_;
+    std::atomic<int> levels_[static_cast<int>(LogSubsystem::COUNT)];
+    std::unique_ptr<LogRing> ring_;
+    std::thread thread_;
+    std::mutex mutex_;          // 保护启动、停止以及同步输出
+    std::atomic<bool> running_;
+    int fd_;                    // 输出文件，-1表示stdout/stderr
+
+    std::atomic<size_t> written_;
+    std::atomic<size_t> dropped_;
+};
+
+// 单条日志的构造器：在栈上的定长记录中拼接消息，析构时提交
+// 数值格式化不分配内存
+class LogLine {
+public:
+    LogLine(LogLevel level, LogSubsystem subsystem);
+    ~LogLine();
+
+    LogLine(const LogLine&) = delete;
+    LogLine& operator=(const LogLine&) = delete;
+
+    LogLine& operator<<(const char* value);
+    LogLine& operator<<(const std::string& value);
+    LogLine& operator<<(char value);
+    LogLine& operator<<(int value);
+    LogLine& operator<<(unsigned int value);
+    LogLine& operator<<(long value);
+    LogLine& operator<<(unsigned long value);
+    LogLine& operator<<(long long value);
+    LogLine& operator<<(unsigned long long value);
+    LogLine& operator<<(double value);
+
+private:
+    // 追加文本，超出容量时在UTF-8字符边界截断
+    void append(const char* data, size_t size);
+
+    LogRecord record_;
+};
+
+// 日志宏：先做编译期级别判断，再做运行时子系统级别判断，
+// 都通过时才求值消息表达式，例如 LOG_DEBUG(LogSubsystem::NET, "接收到 " << n << " 字节");
+#define FACE_AUTH_LOG(level, subsystem, expr)                                   \
+    do {                                                                        \
+        if (static_cast<int>(level) >= FACE_AUTH_LOG_MIN_LEVEL &&               \
+            Logger::instance().isEnabled(level, subsystem)) {                   \
+            LogLine face_auth_log_line_(level, subsystem);                      \
+            face_auth_log_line_ << expr;                                        \
+        }                                                                       \
+    } while (0)
+
+#define LOG_TRACE(subsystem, expr) FACE_AUTH_LOG(LogLevel::TRACE, subsystem, expr)
+#define LOG_DEBUG(subsystem, expr) FACE_AUTH_LOG(LogLevel::DEBUG, subsystem, expr)
+#define LOG_INFO(subsystem, expr) FACE_AUTH_LOG(LogLevel::INFO, subsystem, expr)
+#define LOG_WARN(subsystem, expr) FACE_AUTH_LOG(LogLevel::WARN, subsystem, expr)
+#define LOG_ERROR(subsystem, expr) FACE_AUTH_LOG(LogLevel::ERROR, subsystem, expr)
+
+#endif // LOGGER_H
@@ -0,0 +1,78 @@
+#ifndef MAT_POOL_H
+#define MAT_POOL_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <cstddef>
+
+// 内存池统计信息
+struct MatPoolStats {
+    size_t allocations;        // 经过分配器的缓冲区分配次数
+    size_t pool_hits;          // 由池中缓存块满足的次数（即避免的malloc次数）
+    size_t oversize;           // 超过最大尺寸级别、直接分配的次数
+    size_t cached_bytes;       // 当前空闲缓存在池中的字节数
+    size_t pooled_bytes;       // 池管理的全部字节数（使用中 + 空闲）
+    size_t peak_pooled_bytes;  // pooled_bytes 的峰值
+};
+
+// 按尺寸分级的cv::Mat缓冲区分配器
+// 每个线程持有一个无锁的小缓存，溢出或线程退出时归还到全局仓库，
+// 因此即使每个连接使用独立线程，整帧缓冲区也能在请求之间复用。
+class PooledMatAllocator : public cv::MatAllocator {
+public:
+    // 获取全局实例（永不析构，保证晚于所有cv::Mat释放）
+    static PooledMatAllocator& instance();
+
+    // 设置缓存上限并安装为OpenCV默认分配器
+    void install(size_t thread_cache_bytes, size_t max_cached_bytes);
+
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data,
+                           size_t* step, int flags, cv::UMatUsageFlags usageFlags) const override;
+    bool allocate(cv::UMatData* data, int accessflags, cv::UMatUsageFlags usageFlags) const override;
+    void deallocate(cv::UMatData* data) const override;
+
+    // 获取统计信息
+    MatPoolStats getStats() const;
+
+private:
+    PooledMatAllocator();
+
+    struct ThreadCache;
+
+    // 获取当前线程的缓存，线程退出过程中返回nullptr
+    ThreadCache* localCache() const;
+
+    // 根据字节数查找尺寸级别，超出范围返回-1
+    int sizeClassFor(size_t size) const;
+
+    // 获取一块指定级别的缓冲区
+    unsigned char* acquire(int size_class) const;
+
+    // 归还一块指定级别的缓冲区
+    void release(int size_class, unsigned char* block) const;
+
+    // 将线程缓存中的块归还到全局仓库
+    void flushToDepot(std::vector<unsigned char*>* lists, size_t& bytes) const;
+
+    void updatePeak(size_t pooled) const;
+
+    std::vector<size_t> class_sizes_;
+    size_t thread_cache_bytes_;
+    size_t max_cached_bytes_;
+
+    // 全局仓库：每个尺寸级别一个空闲链表
+    mutable std::mutex depot_mutex_;
+    mutable std::vector<std::vector<unsigned char*>> depot_;
+    mutable size_t depot_bytes_;
+
+    mutable std::atomic<size_t> allocations_;
+    mutable std::atomic<size_t> pool_hits_;
+    mutable std::atomic<size_t> oversize_;
+    mutable std::atomic<size_t> cached_bytes_;
+    mutable std::atomic<size_t> pooled_bytes_;
+    mutable std::atomic<size_t> peak_pooled_bytes_;
+};
+
+#endif // MAT_POOL_H
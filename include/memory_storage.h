@@ -0,0 +1,81 @@
+#ifndef MEMORY_STORAGE_H
+#define MEMORY_STORAGE_H
+
+#include "storage.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <atomic>
+#include <mutex>
+
+// 内存存储后端，用于基准测试与无外部服务的压测
+// 读操作无锁：用户记录发布后不再修改，索引为只插入的开放寻址哈希表，
+// 槽位与表指针均为原子指针；写操作由互斥锁串行化，
+// 更新用户时发布新记录替换槽位，旧记录与扩容前的旧表保留到析构时释放
+// 认证日志与登录记录只计数不保存，长时间压测内存不增长
+class MemoryStorage : public Storage {
+public:
+    MemoryStorage();
+    ~MemoryStorage() override;
+
+    const char* backendName() const override { return "memory"; }
+
+    bool connect(const DBConfig& config) override;
+    void disconnect() override;
+    bool createTables() override;
+
+    bool addUser(const std::string& username, const std::string& password,
+                 const std::vector<FaceImage>& faces) override;
+    bool storeFaceData(int user_id, const FaceImage& face, const std::string& type) override;
+    bool updateUserFace(int user_id, const std::vector<FaceImage>& faces) override;
+
+    bool forEachUser(const std::function<bool(const UserInfo&)>& visitor) override;
+    UserInfo getUserById(int user_id) override;
+    UserInfo getUserByUsername(const std::string& username) override;
+    std::string getUserPassword(int user_id) override;
+
+    bool logAuthentication(int user_id, bool success, const std::string& details) override;
+    bool updateLastLogin(int user_id) override;
+    bool insertAuthLogs(const std::vector<AuthLogEntry>& entries) override;
+    bool insertLoginRecords(const std::vector<LoginRecord>& records) override;
+    bool updateLastLogins(const std::map<int, std::string>& last_logins) override;
+
+private:
+    // 只插入的开放寻址哈希表，容量为2的幂，负载不超过1/2
+    struct Table {
+        size_t mask;
+        std::unique_ptr<std::atomic<const UserInfo*>[]> slots;
+
+        explicit Table(size_t capacity);
+    };
+
+    // 按用户名或ID查找（无锁）
+    const UserInfo* findByName(const std::string& username) const;
+    const UserInfo* findById(int user_id) const;
+
+    // 插入或替换记录（调用方持有write_mutex_）
+    void publish(const UserInfo* record);
+    void publishTo(std::atomic<Table*>& index, const UserInfo* record, bool by_name);
+
+    // 以新的注册人脸替换用户记录（调用方持有write_mutex_）
+    bool replaceFace(const UserInfo* current, const std::string& file_path);
+
+    static size_t hashName(const std::string& username);
+    static size_t hashId(int user_id);
+
+    std::atomic<Table*> by_name_;
+    std::atomic<Table*> by_id_;
+    std::atomic<int> user_count_;
+
+    std::mutex write_mutex_;
+    int next_id_;
+    std::vector<std::unique_ptr<const UserInfo>> records_;  // 所有发布过的记录
+    std::vector<std::unique_ptr<Table>> tables_;            // 所有分配过的索引表
+    std::map<int, std::string> last_logins_;
+
+    std::atomic<size_t> auth_logs_;
+    std::atomic<size_t> login_records_;
+};
+
+#endif // MEMORY_STORAGE_H
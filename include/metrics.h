@@ -0,0 +1,170 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <json/json.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <cstdint>
+
+// 直方图快照
+struct HistogramSnapshot {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+    std::vector<uint64_t> buckets;   // 各桶计数
+
+    // 分位数（q取0~1），返回所在桶的上界（不超过最大值）
+    uint64_t percentile(double q) const;
+
+    double mean() const { return count ? static_cast<double>(sum) / count : 0.0; }
+};
+
+// HDR风格的对数线性直方图：每个2的幂区间均分为16个子桶，相对误差不超过1/16，
+// 小于16的值精确记录；记录只做几次原子加法，不加锁不分配内存
+class LatencyHistogram {
+public:
+    static const int SUB_BUCKET_BITS = 4;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const int MAX_MAGNITUDE = 40;   // 超过2^40的值计入最后一个桶
+    static const int BUCKET_COUNT = SUB_BUCKETS + (MAX_MAGNITUDE - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    LatencyHistogram();
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(uint64_t value);
+
+    HistogramSnapshot snapshot() const;
+
+    // 桶序号与桶上界
+    static int bucketIndex(uint64_t value);
+    static uint64_t bucketUpperBound(int index);
+
+private:
+    std::atomic<uint64_t> buckets_[BUCKET_COUNT];
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> sum_;
+    std::atomic<uint64_t> max_;
+};
+
+// 单调递增计数器
+class Counter {
+public:
+    Counter() : value_(0) {
+    }
+
+    void increment(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+
+    uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_;
+};
+
+// 采集时计算的瞬时值（队列深度等），由调用方在导出时提供
+struct GaugeSample {
+    std::string name;
+    std::string label;   // 标签名，为空表示无标签
+    std::string value_label;
+    double value;
+
+    GaugeSample(const std::string& n, const std::string& l, const std::string& v, double val)
+        : name(n), label(l), value_label(v), value(val) {
+    }
+};
+
+// 作用域计时，析构时把经过的微秒数记录到直方图
+class ScopedLatency {
+public:
+    explicit ScopedLatency(LatencyHistogram& histogram)
+        : histogram_(histogram), start_(std::chrono::steady_clock::now()) {
+    }
+
+    ~ScopedLatency() {
+        histogram_.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start_).count()));
+    }
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+private:
+    LatencyHistogram& histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// 按枚举值缓存的一组指标引用（如按请求类型或拒绝原因区分的计数器），热路径上不再查找注册表
+// 某个值首次使用时才调用lookup注册，未出现过的标签值不会导出；并发首次使用时注册表返回同一引用
+template <typename Metric, typename Enum, size_t N>
+class EnumMetricCache {
+public:
+    explicit EnumMetricCache(std::function<Metric&(Enum)> lookup) : lookup_(lookup) {
+        for (size_t i = 0; i < N; ++i) {
+            metrics_[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    EnumMetricCache(const EnumMetricCache&) = delete;
+    EnumMetricCache& operator=(const EnumMetricCache&) = delete;
+
+    Metric& operator[](Enum value) {
+        size_t index = static_cast<size_t>(value);
+        Metric* metric = metrics_[index].load(std::memory_order_acquire);
+        if (!metric) {
+            metric = &lookup_(value);
+            metrics_[index].store(metric, std::memory_order_release);
+        }
+        return *metric;
+    }
+
+private:
+    std::function<Metric&(Enum)> lookup_;
+    std::atomic<Metric*> metrics_[N];
+};
+
+// 进程内的直方图与计数器注册表
+// 按名称和一个可选标签注册，返回的引用在进程生命周期内有效，调用方应缓存引用而不是每次查找
+class MetricsRegistry {
+public:
+    static MetricsRegistry& instance();
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    LatencyHistogram& histogram(const std::string& name, const std::string& label = "",
+                                const std::string& value = "");
+
+    Counter& counter(const std::string& name, const std::string& label = "",
+                     const std::string& value = "");
+
+    // 导出为JSON（stats消息）
+    Json::Value toJson(const std::vector<GaugeSample>& gauges) const;
+
+    // 导出为Prometheus文本格式（直方图以summary形式输出分位数）
+    std::string toPrometheus(const std::vector<GaugeSample>& gauges) const;
+
+private:
+    MetricsRegistry() {
+    }
+
+    struct Key {
+        std::string name;
+        std::string label;
+        std::string value;
+
+        bool operator<(const Key& other) const;
+    };
+
+    mutable std::mutex mutex_;
+    std::map<Key, std::unique_ptr<LatencyHistogram>> histograms_;
+    std::map<Key, std::unique_ptr<Counter>> counters_;
+};
+
+#endif // METRICS_H
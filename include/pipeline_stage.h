@@ -0,0 +1,98 @@
+#ifndef PIPELINE_STAGE_H
+#define PIPELINE_STAGE_H
+
+#include "executor.h"
+#include "metrics.h"
+#include <string>
+#include <future>
+#include <functional>
+#include <type_traits>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// 请求流水线阶段统计
+struct StageStats {
+    std::string name;
+    std::string executor;    // 所在线程池，在调用线程上执行的阶段为"inline"
+    size_t completed;
+    size_t queue_depth;      // 当前排队等待执行的任务数
+    size_t max_queue_depth;  // 排队任务数峰值
+    double avg_wait_us;      // 平均排队时间
+    double avg_run_us;       // 平均执行时间
+    uint64_t max_run_us;     // 最长执行时间
+};
+
+// 请求流水线中的一个阶段（解码、检测、匹配等）
+// 阶段绑定到与其资源类型匹配的线程池上，多个阶段可共用一个线程池，按阶段分别统计排队与执行时间
+// 排队与执行时间同时记录到 face_auth_stage_wait_us / face_auth_stage_run_us 直方图
+class PipelineStage {
+public:
+    // executor为nullptr时阶段在调用线程上执行
+    PipelineStage(const std::string& name, Executor* executor);
+
+    PipelineStage(const PipelineStage&) = delete;
+    PipelineStage& operator=(const PipelineStage&) = delete;
+
+    // 提交到阶段的线程池执行，通过future取得结果
+    template <typename F>
+    std::future<typename std::result_of<F()>::type> submit(F&& func) {
+        typedef typename std::result_of<F()>::type Result;
+        typedef typename std::decay<F>::type Func;
+        Func task(std::forward<F>(func));
+        Clock::time_point enqueued = enqueue();
+        std::function<Result()> wrapped = [this, task, enqueued]() {
+            Timer timer(*this, enqueued);
+            return task();
+        };
+        if (executor_) {
+            return executor_->submit(wrapped);
+        }
+        std::packaged_task<Result()> inline_task(wrapped);
+        std::future<Result> result = inline_task.get_future();
+        inline_task();
+        return result;
+    }
+
+    // 提交不需要结果的任务
+    void post(std::function<void()> task);
+
+    // 在调用线程上执行并计时
+    template <typename F>
+    typename std::result_of<F()>::type run(F&& func) {
+        Timer timer(*this, enqueue());
+        return func();
+    }
+
+    StageStats getStats() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    // 任务开始执行时记录排队时间，结束时记录执行时间
+    class Timer {
+    public:
+        Timer(PipelineStage& stage, Clock::time_point enqueued);
+        ~Timer();
+
+    private:
+        PipelineStage& stage_;
+        Clock::time_point start_;
+    };
+
+    Clock::time_point enqueue();
+
+    std::string name_;
+    Executor* executor_;
+    LatencyHistogram& wait_histogram_;
+    LatencyHistogram& run_histogram_;
+
+    std::atomic<size_t> queued_;
+    std::atomic<size_t> max_queued_;
+    std::atomic<size_t> completed_;
+    std::atomic<uint64_t> wait_us_;
+    std::atomic<uint64_t> run_us_;
+    std::atomic<uint64_t> max_run_us_;
+};
+
+#endif // PIPELINE_STAGE_H
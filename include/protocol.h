@@ -0,0 +1,61 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <json/json.h>
+#include <string>
+#include <map>
+#include <cstddef>
+
+// 定义通信协议的消息类型
+enum class MessageType {
+    REGISTER_USER,      // 注册用户
+    AUTHENTICATE_USER,  // 认证用户
+    UPDATE_USER_FACE,   // 更新用户人脸
+    ENROLLMENT_STATUS,  // 查询人脸训练状态
+    STATS,              // 查询服务器统计
+    SESSION_LOGIN,      // 开始多帧登录会话（携带第一帧）
+    SESSION_FRAME,      // 会话中的后续帧
+    SESSION_END,        // 客户端不再发送帧
+    TOKEN_AUTH,         // 用会话令牌认证
+    TOKEN_REVOKE,       // 吊销会话令牌
+    RESPONSE,           // 响应消息
+    ERROR               // 错误消息
+};
+
+// 通信消息结构
+struct Message {
+    MessageType type;
+    std::map<std::string, std::string> data;
+};
+
+// 帧解析结果
+enum class FrameStatus {
+    COMPLETE,     // 已解析出完整的一帧
+    INCOMPLETE,   // 数据不足一帧，需要继续接收
+    INVALID       // 格式错误
+};
+
+// 请求帧：'FACE' + JSON长度（4字节，网络字节序）+ JSON + 人脸数据（JSON中的face_data_size字节）
+// 响应帧：'RESP' + JSON长度 + JSON
+namespace protocol {
+
+    const size_t FRAME_HEADER_SIZE = 8;
+    const size_t MAX_FRAME_SIZE = 10 * 1024 * 1024;  // 单帧上限（10MB）
+
+    // 从缓冲区解析一个请求帧，不依赖套接字，可单独测试与基准测试
+    // 数据不足时返回INCOMPLETE；frame_size非空且头部与JSON已解析时写入整帧长度
+    FrameStatus parseRequestFrame(const char* data, size_t size, Message& message,
+                                  size_t* frame_size = nullptr);
+
+    // 构造请求帧（客户端工具与基准测试使用）
+    std::string buildRequestFrame(const Json::Value& request, const std::string& face_data);
+
+    // 构造响应帧
+    std::string buildResponseFrame(const Json::Value& response);
+
+    // 解析一个响应帧（客户端工具使用），返回值与frame_size含义同parseRequestFrame
+    FrameStatus parseResponseFrame(const char* data, size_t size, Json::Value& response,
+                                   size_t* frame_size = nullptr);
+}
+
+#endif // PROTOCOL_H
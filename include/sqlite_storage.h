@@ -0,0 +1,75 @@
+#ifndef SQLITE_STORAGE_H
+#define SQLITE_STORAGE_H
+
+#include "storage.h"
+#include <sqlite3.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+
+// SQLite存储后端（嵌入式，无需外部数据库服务）
+// 单个连接由互斥锁串行化访问，WAL模式下读写互不阻塞文件；预处理语句按SQL文本缓存
+class SqliteStorage : public Storage {
+public:
+    SqliteStorage();
+    ~SqliteStorage() override;
+
+    const char* backendName() const override { return "sqlite"; }
+
+    bool connect(const DBConfig& config) override;
+    void disconnect() override;
+    bool createTables() override;
+
+    bool addUser(const std::string& username, const std::string& password,
+                 const std::vector<FaceImage>& faces) override;
+    bool storeFaceData(int user_id, const FaceImage& face, const std::string& type) override;
+    bool updateUserFace(int user_id, const std::vector<FaceImage>& faces) override;
+
+    bool forEachUser(const std::function<bool(const UserInfo&)>& visitor) override;
+    UserInfo getUserById(int user_id) override;
+    UserInfo getUserByUsername(const std::string& username) override;
+    std::string getUserPassword(int user_id) override;
+
+    bool logAuthentication(int user_id, bool success, const std::string& details) override;
+    bool updateLastLogin(int user_id) override;
+    bool insertAuthLogs(const std::vector<AuthLogEntry>& entries) override;
+    bool insertLoginRecords(const std::vector<LoginRecord>& records) override;
+    bool updateLastLogins(const std::map<int, std::string>& last_logins) override;
+
+    bool applyAuthEventBatch(const std::string& source, uint64_t sequence,
+                             const std::vector<AuthLogEntry>& logs,
+                             const std::vector<LoginRecord>& logins,
+                             const std::map<int, std::string>& last_logins) override;
+    bool getAuthEventCheckpoint(const std::string& source, uint64_t& sequence) override;
+    bool supportsAuthEventCheckpoint() const override { return true; }
+
+    DBStatementStats getStatementStats() const override;
+
+private:
+    // 以下方法要求调用方持有mutex_
+    sqlite3_stmt* prepare(const char* sql);
+    bool execute(const char* sql);
+    bool storeFaceDataLocked(int user_id, const FaceImage& face, const std::string& type);
+    UserInfo readUser(sqlite3_stmt* stmt);
+    UserInfo getUserByIdLocked(int user_id);
+    UserInfo getUserByUsernameLocked(const std::string& username);
+
+    // 在调用方已开始的事务中执行，不提交
+    bool insertAuthLogsLocked(const std::vector<AuthLogEntry>& entries);
+    bool insertLoginRecordsLocked(const std::vector<LoginRecord>& records);
+    bool updateLastLoginsLocked(const std::map<int, std::string>& last_logins);
+    bool getAuthEventCheckpointLocked(const std::string& source, uint64_t& sequence);
+
+    sqlite3* db_;
+    std::unordered_map<std::string, sqlite3_stmt*> statements_;
+    std::mutex mutex_;
+
+    std::atomic<size_t> prepares_;
+    std::atomic<size_t> executes_;
+    std::atomic<size_t> cache_hits_;
+};
+
+#endif // SQLITE_STORAGE_H
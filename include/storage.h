@@ -0,0 +1,167 @@
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <functional>
+#include <cstdint>
+
+// 存储配置
+struct DBConfig {
+    std::string backend;           // 存储后端: mysql / sqlite / memory
+    std::string host;
+    std::string user;
+    std::string password;
+    std::string database;
+    std::string path;              // SQLite数据库文件路径
+    size_t pool_size;              // 连接池大小
+    int health_check_interval;     // 连接空闲超过该秒数后，借出前先ping
+    int checkout_timeout_ms;       // 等待空闲连接的超时时间
+    int connect_timeout;           // 建立连接的超时时间（秒）
+    int auth_log_retention_days;        // 认证日志保留天数，<=0表示永久保留
+    int auth_log_partition_ahead_days;  // 提前创建的认证日志日分区天数
+    int maintenance_interval;           // 存储维护任务的执行间隔（秒）
+
+    DBConfig()
+        : backend("mysql"), path("face_auth_data/face_auth.db"),
+          pool_size(8), health_check_interval(30), checkout_timeout_ms(5000), connect_timeout(5),
+          auth_log_retention_days(90), auth_log_partition_ahead_days(7), maintenance_interval(3600) {
+    }
+};
+
+// 预处理语句统计
+struct DBStatementStats {
+    size_t prepares;    // 服务器端准备次数
+    size_t executes;    // 执行次数
+    size_t cache_hits;  // 命中语句缓存的次数
+};
+
+struct UserInfo {
+    int id;
+    std::string username;
+    std::string password_hash;  // 密码SHA-256哈希
+    std::string file_path;
+    std::string created_at;
+};
+
+// 待保存的人脸图像
+struct FaceImage {
+    std::string data;   // 编码后的图像
+    bool normalized;    // 是否为预处理后的标准化人脸（灰度PNG，登录时可直接比较）
+
+    FaceImage() : normalized(false) {
+    }
+    FaceImage(const std::string& d, bool n) : data(d), normalized(n) {
+    }
+};
+
+// 认证日志记录
+struct AuthLogEntry {
+    int user_id;
+    bool success;
+    std::string details;
+    std::string created_at;
+};
+
+// 登录人脸记录
+struct LoginRecord {
+    int user_id;
+    std::string created_at;
+};
+
+// 存储后端接口，AuthServer只依赖该接口
+class Storage {
+public:
+    virtual ~Storage() {}
+
+    // 后端名称
+    virtual const char* backendName() const = 0;
+
+    // 连接存储（按需建表）
+    virtual bool connect(const DBConfig& config) = 0;
+
+    // 断开连接
+    virtual void disconnect() = 0;
+
+    // 创建表
+    virtual bool createTables() = 0;
+
+    // 添加用户，faces按顺序保存为注册人脸，最后一张为登录时使用的人脸
+    virtual bool addUser(const std::string& username, const std::string& password,
+                         const std::vector<FaceImage>& faces) = 0;
+
+    // 存储人脸数据
+    virtual bool storeFaceData(int user_id, const FaceImage& face, const std::string& type) = 0;
+
+    // 更新用户的人脸数据（规则同addUser）
+    virtual bool updateUserFace(int user_id, const std::vector<FaceImage>& faces) = 0;
+
+    // 流式遍历全部用户（每个用户只带最新的注册人脸），visitor返回false时提前结束
+    // visitor可能在持有连接或锁的线程上调用，不应长时间阻塞，也不能回调存储
+    virtual bool forEachUser(const std::function<bool(const UserInfo&)>& visitor) = 0;
+
+    // 根据ID获取用户
+    virtual UserInfo getUserById(int user_id) = 0;
+
+    // 根据用户名获取用户（同时返回密码哈希与最新注册人脸）
+    virtual UserInfo getUserByUsername(const std::string& username) = 0;
+
+    // 获取用户密码
+    virtual std::string getUserPassword(int user_id) = 0;
+
+    // 记录认证日志
+    virtual bool logAuthentication(int user_id, bool success, const std::string& details) = 0;
+
+    // 更新用户最后登录时间
+    virtual bool updateLastLogin(int user_id) = 0;
+
+    // 批量记录认证日志
+    virtual bool insertAuthLogs(const std::vector<AuthLogEntry>& entries) = 0;
+
+    // 批量记录登录人脸记录
+    virtual bool insertLoginRecords(const std::vector<LoginRecord>& records) = 0;
+
+    // 批量更新最后登录时间（用户ID -> 时间）
+    virtual bool updateLastLogins(const std::map<int, std::string>& last_logins) = 0;
+
+    // 写入预写日志中的一个段（source为日志来源，sequence为段序号，单调递增）
+    // 默认依次调用上面三个批量接口，既不原子也不幂等，重放时可能重复写入；
+    // 支持事务的后端覆盖为原子写入并记录检查点，同时覆盖supportsAuthEventCheckpoint
+    virtual bool applyAuthEventBatch(const std::string& source, uint64_t sequence,
+                                     const std::vector<AuthLogEntry>& logs,
+                                     const std::vector<LoginRecord>& logins,
+                                     const std::map<int, std::string>& last_logins);
+
+    // 获取日志来源已写入的最大段序号，没有记录时为0
+    virtual bool getAuthEventCheckpoint(const std::string& source, uint64_t& sequence);
+
+    // 是否实现了原子的applyAuthEventBatch与检查点，不支持时不能启用认证事件预写日志
+    virtual bool supportsAuthEventCheckpoint() const { return false; }
+
+    // 获取预处理语句统计，不使用预处理语句的后端返回0
+    virtual DBStatementStats getStatementStats() const;
+
+    // 周期性维护（如分区滚动），默认无操作
+    virtual bool runMaintenance();
+
+    // 获取所有用户
+    std::vector<UserInfo> getAllUsers();
+
+    // 按块流式遍历用户，visitor可以取走块中的数据（std::move）
+    bool forEachUserChunk(size_t chunk_size, const std::function<bool(std::vector<UserInfo>&)>& visitor);
+};
+
+// 按名称创建存储后端，未知或未编译的后端返回nullptr
+std::unique_ptr<Storage> createStorage(const std::string& backend);
+
+// 保存人脸图像文件，返回写入file_path列的路径，失败返回空字符串
+// 注册图像写入内容寻址的BlobStore（相同图像只存一份），登录图像不落盘
+// 标准化人脸以 .face.png 结尾，便于读取时识别
+std::string saveFaceFile(const FaceImage& face, const std::string& type);
+
+// 路径是否指向标准化人脸
+bool isNormalizedFacePath(const std::string& file_path);
+
+#endif // STORAGE_H
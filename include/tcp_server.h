@@ -2,6 +2,8 @@
 #define TCP_SERVER_H
 
 #include "auth_server.h"
+#include "protocol.h"
+#include "capture.h"
 #include <string>
 #include <map>
 #include <functional>
@@ -12,21 +14,6 @@
 #include <condition_variable>
 #include <atomic>
 
-// 定义通信协议的消息类型
-enum class MessageType {
-    REGISTER_USER,      // 注册用户
-    AUTHENTICATE_USER,  // 认证用户
-    UPDATE_USER_FACE,   // 更新用户人脸
-    RESPONSE,           // 响应消息
-    ERROR               // 错误消息
-};
-
-// 通信消息结构
-struct Message {
-    MessageType type;
-    std::map<std::string, std::string> data;
-};
-
 class TcpServer {
 public:
     TcpServer(AuthServer& auth_server, int port = 8080);
@@ -45,14 +32,20 @@ private:
     // 客户端处理线程
     void clientHandler(int client_socket);
     
-    // 接收消息
-    bool receiveMessage(int client_socket, Message& message);
+    // 接收一个完整的请求帧，buffer保存已收到但尚未解析的数据（会话中后续帧的开头）
+    bool receiveMessage(int client_socket, std::vector<char>& buffer, Message& message);
+    
+    // 从buffer开头取出一帧，完整时移除该帧；frame_size为已知的整帧长度，跨调用保留
+    FrameStatus takeFrame(std::vector<char>& buffer, Message& message, size_t& frame_size);
     
     // 发送消息
     bool sendMessage(int client_socket, const Message& message);
     
+    // 按协议格式发送JSON响应
+    bool sendJson(int client_socket, const Json::Value& json_response);
+    
     // 处理客户端消息
-    void processMessage(int client_socket, const Message& message);
+    void processMessage(int client_socket, const Message& message, std::vector<char>& buffer);
     
     // 处理注册请求
     void handleRegister(int client_socket, const Message& message);
@@ -60,9 +53,28 @@ private:
     // 处理认证请求
     void handleAuthenticate(int client_socket, const Message& message);
     
+    // 处理多帧登录会话：持续接收后续帧并提交评分，判定后立即响应
+    void handleSession(int client_socket, const Message& message, std::vector<char>& buffer);
+    
+    // 响应后丢弃客户端仍在发送的数据直到其关闭连接，避免带未读数据关闭导致RST丢失响应
+    void drainConnection(int client_socket);
+    
+    // 处理令牌认证与吊销请求
+    void handleTokenAuth(int client_socket, const Message& message);
+    void handleTokenRevoke(int client_socket, const Message& message);
+    
     // 处理更新人脸请求
     void handleUpdateFace(int client_socket, const Message& message);
     
+    // 处理人脸训练状态查询
+    void handleEnrollmentStatus(int client_socket, const Message& message);
+    
+    // 处理统计查询
+    void handleStats(int client_socket);
+    
+    // 消息类型名称（用于统计标签）
+    static const char* messageTypeName(MessageType type);
+    
     // 发送响应
     void sendResponse(int client_socket, bool success, const std::string& message, 
                      const std::map<std::string, std::string>& data = {});
@@ -77,6 +89,7 @@ private:
     std::mutex mutex_;
     std::thread server_thread_;
     std::vector<std::thread> client_threads_;
+    CaptureWriter capture_;   // 可选的请求抓包
 };
 
 #endif // TCP_SERVER_H 
\ No newline at end of file
@@ -0,0 +1,87 @@
+#ifndef TOKEN_MANAGER_H
+#define TOKEN_MANAGER_H
+
+#include <string>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+// 会话令牌配置
+struct TokenConfig {
+    bool enabled;                 // 开启后认证成功的响应附带令牌
+    int ttl_seconds;              // 令牌有效期（秒，必须为正）
+    std::string secret;           // HMAC密钥，为空时启动时随机生成（重启后已签发的令牌失效）
+    size_t revocation_capacity;   // 吊销列表容量，过期的条目自动清除，已满时淘汰最早过期的条目
+
+    TokenConfig() : enabled(false), ttl_seconds(300), revocation_capacity(1024) {
+    }
+};
+
+// 令牌中的声明
+struct TokenClaims {
+    int user_id;
+    int64_t expires;      // 过期时间（Unix时间，秒）
+    std::string id;       // 令牌ID（随机），用于吊销
+
+    TokenClaims() : user_id(0), expires(0) {
+    }
+};
+
+enum class TokenStatus {
+    VALID,
+    MALFORMED,
+    BAD_SIGNATURE,
+    EXPIRED,
+    REVOKED
+};
+
+// 签发与校验会话令牌：v1.<用户ID>.<过期时间>.<令牌ID>.<HMAC-SHA256>
+// 校验只重新计算签名并比较，不访问数据库；吊销列表只保存未过期的令牌ID
+// 吊销列表在进程内存中，不在实例间同步，也不跨重启保留：多实例共用密钥时，
+// 在一个实例上吊销的令牌在其他实例上仍然有效，直到过期（不支持多实例吊销）
+class TokenManager {
+public:
+    TokenManager();
+
+    TokenManager(const TokenManager&) = delete;
+    TokenManager& operator=(const TokenManager&) = delete;
+
+    // 设置配置与密钥，在开始处理请求前调用；无法生成随机密钥时返回false
+    bool configure(const TokenConfig& config);
+
+    bool isEnabled() const { return config_.enabled; }
+
+    // 为用户签发令牌，expires非空时写入过期时间
+    std::string issue(int user_id, int64_t* expires = nullptr) const;
+
+    // 校验令牌，有效时填写claims
+    TokenStatus verify(const std::string& token, TokenClaims& claims) const;
+
+    // 吊销一个有效的令牌；令牌无效、已过期或容量为0时返回false
+    // 吊销列表已满时淘汰最早过期的条目，该令牌在剩余的有效期内重新有效
+    bool revoke(const std::string& token);
+
+    // 当前吊销列表中的令牌数
+    size_t revokedCount() const { return revoked_count_.load(std::memory_order_relaxed); }
+
+    static const char* statusName(TokenStatus status);
+
+private:
+    // 计算payload的HMAC-SHA256（十六进制）
+    std::string sign(const std::string& payload) const;
+
+    bool isRevoked(const std::string& id) const;
+
+    // 在持有mutex_时调用
+    void purgeExpiredLocked(int64_t current);
+
+    TokenConfig config_;
+    std::string key_;
+
+    mutable std::mutex mutex_;
+    std::map<std::string, int64_t> revoked_;    // 令牌ID -> 过期时间
+    std::atomic<size_t> revoked_count_;         // 为0时校验不加锁
+};
+
+#endif // TOKEN_MANAGER_H
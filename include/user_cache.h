@@ -0,0 +1,100 @@
+#ifndef USER_CACHE_H
+#define USER_CACHE_H
+
+#include "storage.h"
+#include <string>
+#include <vector>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+
+// 用户目录缓存配置
+struct UserCacheConfig {
+    bool enabled;
+    size_t capacity;     // 最多缓存的用户数，超出时按LRU淘汰
+    int ttl_seconds;     // 条目有效期，过期后回源数据库
+    size_t shards;       // 分片数（向上取整为2的幂），每个分片独立加锁
+    size_t warm_threads;     // 预热时并行写入缓存的线程数
+    size_t warm_chunk_size;  // 预热时每块的用户数
+
+    UserCacheConfig()
+        : enabled(true), capacity(100000), ttl_seconds(300), shards(16),
+          warm_threads(4), warm_chunk_size(4096) {
+    }
+};
+
+// 用户目录缓存统计
+struct UserCacheStats {
+    size_t hits;
+    size_t misses;
+    size_t expirations;  // 因TTL过期而失效的次数
+    size_t evictions;    // 因容量上限淘汰的次数
+    size_t size;
+};
+
+// 进程内用户目录缓存：用户名 -> 用户信息（ID、密码哈希、注册人脸）
+// 按用户名哈希分片，分片内为LRU链表，读写只锁定单个分片
+class UserCache {
+public:
+    UserCache();
+
+    UserCache(const UserCache&) = delete;
+    UserCache& operator=(const UserCache&) = delete;
+
+    // 设置容量、TTL与分片数，会清空已有条目
+    void configure(const UserCacheConfig& config);
+
+    // 从数据库流式预热，读取线程按块分发给多个线程并行写入，返回载入的用户数
+    size_t warm(Storage& storage);
+
+    // 查找用户，命中且未过期返回true
+    bool get(const std::string& username, UserInfo& user);
+
+    // 写入或更新用户（写穿透）
+    void put(const UserInfo& user);
+
+    // 未命中后回源读取的结果：只在没有未过期条目时写入，不会覆盖回源期间写穿透的更新
+    void fill(const UserInfo& user);
+
+    // 删除用户
+    void erase(const std::string& username);
+
+    // 清空缓存
+    void clear();
+
+    bool isEnabled() const { return config_.enabled; }
+
+    UserCacheStats getStats() const;
+
+private:
+    struct Entry {
+        UserInfo user;
+        std::chrono::steady_clock::time_point expires_at;
+    };
+
+    // 单个分片：LRU链表头部为最近使用
+    struct Shard {
+        std::mutex mutex;
+        std::list<Entry> lru;
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    };
+
+    Shard& shardFor(const std::string& username);
+
+    // overwrite为false时保留已有的未过期条目
+    void store(const UserInfo& user, bool overwrite);
+
+    UserCacheConfig config_;
+    size_t shard_capacity_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    std::atomic<size_t> hits_;
+    std::atomic<size_t> misses_;
+    std::atomic<size_t> expirations_;
+    std::atomic<size_t> evictions_;
+};
+
+#endif // USER_CACHE_H
@@ -15,6 +15,22 @@ namespace utils {
     // Base64解码
     std::vector<unsigned char> base64Decode(const std::string& encoded_data);
     
+    // Base64编码后的长度
+    size_t base64EncodedLength(size_t length);
+    
+    // Base64解码后的最大长度（调用方据此分配缓冲区）
+    size_t base64DecodedMaxLength(size_t encoded_length);
+    
+    // Base64编码到调用方提供的缓冲区（至少base64EncodedLength字节），返回写入的字符数
+    size_t base64EncodeTo(const unsigned char* data, size_t length, char* out);
+    
+    // Base64解码到调用方提供的缓冲区（至少base64DecodedMaxLength字节），返回写入的字节数
+    // 遇到'='或非Base64字符时停止
+    size_t base64DecodeTo(const char* encoded, size_t length, unsigned char* out, size_t out_capacity);
+    
+    // 当前使用的Base64实现（avx2 / ssse3 / scalar）
+    const char* base64Implementation();
+    
     // 从Base64字符串解码图像
     cv::Mat base64ToMat(const std::string& base64_image);
     
@@ -0,0 +1,36 @@
+-- 将旧版本的未分区 auth_logs 迁移为按天RANGE分区的表
+-- 分区表不支持外键，主键需包含分区列 created_at
+-- 迁移通过重命名交换完成，不阻塞写入；旧数据按需分批回填
+-- 执行前请将下面的分区日期替换为当天及之后若干天
+
+USE face_auth_db;
+
+-- 1. 创建分区表（第一个分区同时容纳回填的历史数据）
+CREATE TABLE auth_logs_partitioned (
+  id BIGINT AUTO_INCREMENT,
+  user_id INT NOT NULL,
+  success BOOLEAN NOT NULL DEFAULT 0,
+  details TEXT,
+  created_at DATETIME NOT NULL,
+  PRIMARY KEY (id, created_at),
+  INDEX idx_auth_logs_user_created (user_id, created_at)
+) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4
+PARTITION BY RANGE COLUMNS(created_at) (
+  PARTITION p20260101 VALUES LESS THAN ('2026-01-02'),
+  PARTITION p20260102 VALUES LESS THAN ('2026-01-03'),
+  PARTITION pmax VALUES LESS THAN (MAXVALUE)
+);
+
+-- 2. 原子交换表名，新写入立即进入分区表
+RENAME TABLE auth_logs TO auth_logs_unpartitioned,
+             auth_logs_partitioned TO auth_logs;
+
+-- 3. （可选）按ID区间分批回填需要保留的历史数据，每批单独提交
+-- INSERT INTO auth_logs (user_id, success, details, created_at)
+-- SELECT user_id, success, details, created_at FROM auth_logs_unpartitioned
+-- WHERE id BETWEEN 1 AND 100000;
+
+-- 4. 确认无误后删除旧表
+-- DROP TABLE auth_logs_unpartitioned;
+
+-- 之后服务器的维护任务会自动创建新的日分区并删除过期分区
@@ -17,12 +17,23 @@ CREATE TABLE IF NOT EXISTS users (
   created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
 );
 
--- 创建认证日志表
+-- 创建认证日志表（按天RANGE分区，服务器维护任务会将pmax拆分为日分区并删除过期分区）
 CREATE TABLE IF NOT EXISTS auth_logs (
-  id INT AUTO_INCREMENT PRIMARY KEY,
-  user_id INT,
-  success BOOLEAN,
+  id BIGINT AUTO_INCREMENT,
+  user_id INT NOT NULL,
+  success BOOLEAN NOT NULL DEFAULT 0,
   details TEXT,
-  created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
-  FOREIGN KEY (user_id) REFERENCES users(id)
-); 
\ No newline at end of file
+  created_at DATETIME NOT NULL,
+  PRIMARY KEY (id, created_at),
+  INDEX idx_auth_logs_user_created (user_id, created_at)
+) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4
+PARTITION BY RANGE COLUMNS(created_at) (
+  PARTITION pmax VALUES LESS THAN (MAXVALUE)
+);
+
+-- 创建预写日志检查点表（每个日志来源已写入的最大段序号，保证崩溃后重放幂等）
+CREATE TABLE IF NOT EXISTS wal_checkpoint (
+  source VARCHAR(191) PRIMARY KEY,
+  sequence BIGINT UNSIGNED NOT NULL,
+  updated_at DATETIME NOT NULL
+) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4;
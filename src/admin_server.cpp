@@ -0,0 +1,232 @@
+#include "admin_server.h"
+#include "logger.h"
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/select.h>
+
+namespace {
+
+// 命令行的最大长度
+const size_t MAX_COMMAND_SIZE = 4096;
+
+// 写出全部数据
+bool writeAll(int fd, const std::string& data) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        ssize_t n = send(fd, data.data() + offset, data.size() - offset, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        offset += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+} // namespace
+
+AdminServer::AdminServer() : server_socket_(-1), running_(false) {
+}
+
+AdminServer::~AdminServer() {
+    stop();
+}
+
+void AdminServer::addCommand(const std::string& name, Handler handler) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (commands_.empty()) {
+        default_command_ = name;
+    }
+    commands_[name] = handler;
+}
+
+bool AdminServer::start(const std::string& socket_path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+        return true;
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (socket_path.empty() || socket_path.size() >= sizeof(addr.sun_path)) {
+        LOG_ERROR(LogSubsystem::SERVER, "无效的管理套接字路径: " << socket_path);
+        return false;
+    }
+    strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+
+    server_socket_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (server_socket_ < 0) {
+        LOG_ERROR(LogSubsystem::SERVER, "无法创建管理套接字: " << strerror(errno));
+        return false;
+    }
+
+    // 删除上次运行遗留的套接字文件
+    unlink(socket_path.c_str());
+    if (bind(server_socket_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+        LOG_ERROR(LogSubsystem::SERVER, "无法绑定管理套接字 " << socket_path << ": " << strerror(errno));
+        close(server_socket_);
+        server_socket_ = -1;
+        return false;
+    }
+
+    // 只允许服务进程所属用户访问
+    chmod(socket_path.c_str(), 0600);
+
+    if (listen(server_socket_, 4) < 0) {
+        LOG_ERROR(LogSubsystem::SERVER, "无法监听管理套接字: " << strerror(errno));
+        close(server_socket_);
+        server_socket_ = -1;
+        unlink(socket_path.c_str());
+        return false;
+    }
+
+    socket_path_ = socket_path;
+    running_ = true;
+    thread_ = std::thread(&AdminServer::serverThread, this);
+
+    LOG_INFO(LogSubsystem::SERVER, "管理套接字已启动: " << socket_path_);
+    return true;
+}
+
+void AdminServer::stop() {
+    std::thread thread;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+        thread.swap(thread_);
+    }
+
+    // 服务线程最多在一个select超时后退出；等待时不持有锁，正在处理的命令需要查找处理函数
+    if (thread.joinable()) {
+        thread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    close(server_socket_);
+    server_socket_ = -1;
+    unlink(socket_path_.c_str());
+    LOG_INFO(LogSubsystem::SERVER, "管理套接字已关闭");
+}
+
+void AdminServer::serverThread() {
+    while (running_) {
+        struct timeval timeout;
+        timeout.tv_sec = 1;
+        timeout.tv_usec = 0;
+
+        fd_set read_fds;
+        FD_ZERO(&read_fds);
+        FD_SET(server_socket_, &read_fds);
+
+        int activity = select(server_socket_ + 1, &read_fds, NULL, NULL, &timeout);
+        if (activity < 0 && errno != EINTR) {
+            LOG_ERROR(LogSubsystem::SERVER, "管理套接字select错误: " << strerror(errno));
+            break;
+        }
+        if (activity <= 0 || !running_) {
+            continue;
+        }
+
+        int client_socket = accept4(server_socket_, NULL, NULL, SOCK_CLOEXEC);
+        if (client_socket < 0) {
+            LOG_WARN(LogSubsystem::SERVER, "管理套接字接受失败: " << strerror(errno));
+            continue;
+        }
+        handleClient(client_socket);
+        close(client_socket);
+    }
+}
+
+void AdminServer::handleClient(int client_socket) {
+    // 客户端发送命令后可能不关闭写端，读到换行即开始处理
+    struct timeval tv;
+    tv.tv_sec = 2;
+    tv.tv_usec = 0;
+    setsockopt(client_socket, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    std::string request;
+    char buffer[512];
+    while (request.find('\n') == std::string::npos && request.size() < MAX_COMMAND_SIZE) {
+        ssize_t n = recv(client_socket, buffer, sizeof(buffer), 0);
+        if (n <= 0) {
+            break;
+        }
+        request.append(buffer, static_cast<size_t>(n));
+    }
+
+    std::string line = trim(request.substr(0, request.find('\n')));
+
+    // HTTP请求：取路径作为命令
+    bool http = line.compare(0, 4, "GET ") == 0;
+    if (http) {
+        size_t path_end = line.find(' ', 4);
+        line = line.substr(4, path_end == std::string::npos ? std::string::npos : path_end - 4);
+        size_t query = line.find('?');
+        if (query != std::string::npos) {
+            line = line.substr(0, query);
+        }
+        while (!line.empty() && line[0] == '/') {
+            line.erase(0, 1);
+        }
+    }
+
+    size_t space = line.find(' ');
+    std::string name = line.substr(0, space);
+    std::string args = space == std::string::npos ? "" : trim(line.substr(space + 1));
+
+    Handler handler;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (name.empty()) {
+            name = default_command_;
+        }
+        auto it = commands_.find(name);
+        if (it != commands_.end()) {
+            handler = it->second;
+        }
+    }
+
+    std::string body;
+    bool found = static_cast<bool>(handler);
+    if (found) {
+        try {
+            body = handler(args);
+        } catch (const std::exception& e) {
+            body = std::string("命令执行失败: ") + e.what() + "\n";
+        }
+    } else {
+        body = "未知命令: " + name + "\n可用命令:";
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& pair : commands_) {
+            body += " " + pair.first;
+        }
+        body += "\n";
+    }
+
+    if (http) {
+        std::string header = found ? "HTTP/1.0 200 OK\r\n" : "HTTP/1.0 404 Not Found\r\n";
+        header += "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n";
+        header += "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n";
+        body = header + body;
+    }
+    writeAll(client_socket, body);
+}
@@ -0,0 +1,39 @@
+#include "async_storage.h"
+#include <memory>
+
+AsyncStorage::AsyncStorage() : storage_(nullptr), reads_(nullptr), writes_(nullptr) {
+}
+
+void AsyncStorage::attach(Storage& storage, PipelineStage& reads, PipelineStage& writes) {
+    storage_ = &storage;
+    reads_ = &reads;
+    writes_ = &writes;
+}
+
+std::future<UserInfo> AsyncStorage::getUserByUsername(const std::string& username) {
+    Storage* storage = storage_;
+    return reads_->submit([storage, username]() { return storage->getUserByUsername(username); });
+}
+
+std::future<UserInfo> AsyncStorage::getUserById(int user_id) {
+    Storage* storage = storage_;
+    return reads_->submit([storage, user_id]() { return storage->getUserById(user_id); });
+}
+
+std::future<bool> AsyncStorage::addUser(const std::string& username, const std::string& password,
+                                        std::vector<FaceImage> faces) {
+    Storage* storage = storage_;
+    // 图像数据较大，移入共享指针，避免lambda捕获时复制
+    std::shared_ptr<std::vector<FaceImage>> shared = std::make_shared<std::vector<FaceImage>>(std::move(faces));
+    return writes_->submit([storage, username, password, shared]() {
+        return storage->addUser(username, password, *shared);
+    });
+}
+
+std::future<bool> AsyncStorage::updateUserFace(int user_id, std::vector<FaceImage> faces) {
+    Storage* storage = storage_;
+    std::shared_ptr<std::vector<FaceImage>> shared = std::make_shared<std::vector<FaceImage>>(std::move(faces));
+    return writes_->submit([storage, user_id, shared]() {
+        return storage->updateUserFace(user_id, *shared);
+    });
+}
@@ -0,0 +1,471 @@
+#include "auth_event_wal.h"
+#include "logger.h"
+#include "utils.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace {
+
+// 记录头：载荷长度与载荷的CRC32，均为小端序
+const size_t RECORD_HEADER_SIZE = 8;
+
+// 单条记录的长度上限，超过视为损坏
+const uint32_t MAX_RECORD_SIZE = 1024 * 1024;
+
+const char SEGMENT_PREFIX[] = "segment-";
+const char SEGMENT_SUFFIX[] = ".wal";
+
+// 记录已分配过的最大段序号，段全部入库删除后序号仍不回退
+const char SEQUENCE_FILE[] = "sequence";
+
+// CRC-32（IEEE 802.3）查找表
+struct Crc32Table {
+    uint32_t values[256];
+
+    Crc32Table() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            values[i] = c;
+        }
+    }
+};
+
+uint32_t crc32(const char* data, size_t size) {
+    static const Crc32Table table;
+    uint32_t c = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; ++i) {
+        c = table.values[(c ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (c >> 8);
+    }
+    return c ^ 0xFFFFFFFFu;
+}
+
+void putU16(std::string& out, uint16_t value) {
+    out += static_cast<char>(value & 0xFF);
+    out += static_cast<char>((value >> 8) & 0xFF);
+}
+
+void putU32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+uint32_t getU32(const char* p) {
+    const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+    return static_cast<uint32_t>(u[0]) | (static_cast<uint32_t>(u[1]) << 8) |
+           (static_cast<uint32_t>(u[2]) << 16) | (static_cast<uint32_t>(u[3]) << 24);
+}
+
+uint16_t getU16(const char* p) {
+    const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+    return static_cast<uint16_t>(u[0] | (u[1] << 8));
+}
+
+bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool syncDirectory(const std::string& dir) {
+    int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    bool ok = fd >= 0 && ::fsync(fd) == 0;
+    if (!ok) {
+        LOG_ERROR(LogSubsystem::STORAGE, "同步目录失败 " << dir << ": " << strerror(errno));
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    return ok;
+}
+
+// 解析段文件名中的序号
+bool parseSegmentName(const std::string& name, uint64_t& sequence) {
+    size_t prefix = sizeof(SEGMENT_PREFIX) - 1;
+    size_t suffix = sizeof(SEGMENT_SUFFIX) - 1;
+    if (name.size() <= prefix + suffix || name.compare(0, prefix, SEGMENT_PREFIX) != 0 ||
+        name.compare(name.size() - suffix, suffix, SEGMENT_SUFFIX) != 0) {
+        return false;
+    }
+    std::string digits = name.substr(prefix, name.size() - prefix - suffix);
+    if (digits.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    sequence = std::strtoull(digits.c_str(), nullptr, 10);
+    return true;
+}
+
+} // namespace
+
+AuthEventWal::AuthEventWal()
+    : leader_active_(false), fd_(-1), active_sequence_(0), active_bytes_(0),
+      appended_(0), syncs_(0), segments_(0), corrupt_tails_(0) {
+}
+
+AuthEventWal::~AuthEventWal() {
+    close();
+}
+
+bool AuthEventWal::open(const AuthEventWalConfig& config, uint64_t min_sequence) {
+    close();
+
+    std::lock_guard<std::mutex> lock(io_mutex_);
+    config_ = config;
+    if (!utils::createDirectories(config_.dir)) {
+        LOG_ERROR(LogSubsystem::STORAGE, "无法创建预写日志目录: " << config_.dir);
+        return false;
+    }
+
+    // 新段序号取目录中已有段、序号文件与检查点三者的最大值加一
+    uint64_t last = min_sequence;
+    std::ifstream sequence_file((config_.dir + "/" + SEQUENCE_FILE).c_str());
+    uint64_t stored = 0;
+    if (sequence_file >> stored) {
+        last = std::max(last, stored);
+    }
+
+    size_t existing = 0;
+    DIR* dir = opendir(config_.dir.c_str());
+    if (!dir) {
+        LOG_ERROR(LogSubsystem::STORAGE, "无法读取预写日志目录 " << config_.dir << ": " << strerror(errno));
+        return false;
+    }
+    while (struct dirent* entry = readdir(dir)) {
+        uint64_t sequence;
+        if (parseSegmentName(entry->d_name, sequence)) {
+            last = std::max(last, sequence);
+            existing++;
+        }
+    }
+    closedir(dir);
+
+    if (!openSegment(last + 1)) {
+        return false;
+    }
+
+    LOG_INFO(LogSubsystem::STORAGE, "认证事件预写日志: " << config_.dir << ", 待加载段: " << existing
+              << ", 当前段: " << active_sequence_
+              << ", fdatasync: " << (config_.sync ? "开启" : "关闭"));
+    return true;
+}
+
+void AuthEventWal::close() {
+    std::lock_guard<std::mutex> lock(io_mutex_);
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool AuthEventWal::append(const AuthEvent& event) {
+    std::string record;
+    encode(event, record);
+
+    PendingAppend pending;
+    pending.record = &record;
+    pending.ok = false;
+    pending.done = false;
+    if (!commit(pending)) {
+        return false;
+    }
+    appended_++;
+    return true;
+}
+
+void AuthEventWal::rotateIfDue() {
+    std::lock_guard<std::mutex> lock(io_mutex_);
+    if (fd_ < 0 || active_bytes_ == 0) {
+        return;
+    }
+    if (std::chrono::steady_clock::now() - active_opened_ < std::chrono::milliseconds(config_.segment_max_age_ms)) {
+        return;
+    }
+    openSegment(active_sequence_ + 1);
+}
+
+std::vector<uint64_t> AuthEventWal::closedSegments() {
+    std::string dir_path;
+    uint64_t active;
+    {
+        std::lock_guard<std::mutex> lock(io_mutex_);
+        dir_path = config_.dir;
+        // 关闭后活动段也可加载
+        active = fd_ >= 0 ? active_sequence_ : UINT64_MAX;
+    }
+
+    std::vector<uint64_t> sequences;
+    DIR* dir = opendir(dir_path.c_str());
+    if (!dir) {
+        return sequences;
+    }
+    while (struct dirent* entry = readdir(dir)) {
+        uint64_t sequence;
+        if (parseSegmentName(entry->d_name, sequence) && sequence < active) {
+            sequences.push_back(sequence);
+        }
+    }
+    closedir(dir);
+
+    std::sort(sequences.begin(), sequences.end());
+    return sequences;
+}
+
+bool AuthEventWal::readSegment(uint64_t sequence, std::vector<AuthEvent>& events) {
+    std::string path = segmentPath(sequence);
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file) {
+        LOG_ERROR(LogSubsystem::STORAGE, "无法打开预写日志段: " << path);
+        return false;
+    }
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    std::string data = buffer.str();
+
+    size_t offset = 0;
+    while (offset < data.size()) {
+        if (data.size() - offset < RECORD_HEADER_SIZE) {
+            break;
+        }
+        uint32_t length = getU32(data.data() + offset);
+        uint32_t checksum = getU32(data.data() + offset + 4);
+        if (length > MAX_RECORD_SIZE || data.size() - offset - RECORD_HEADER_SIZE < length) {
+            break;
+        }
+        const char* payload = data.data() + offset + RECORD_HEADER_SIZE;
+        AuthEvent event;
+        if (crc32(payload, length) != checksum || !decode(payload, length, event)) {
+            break;
+        }
+        events.push_back(event);
+        offset += RECORD_HEADER_SIZE + length;
+    }
+
+    if (offset < data.size()) {
+        // 崩溃时未写完的记录：之前的记录都已完整落盘，之后的内容丢弃
+        corrupt_tails_++;
+        LOG_WARN(LogSubsystem::STORAGE, "预写日志段 " << path << " 在偏移 " << offset << " 处截断，丢弃 "
+                  << (data.size() - offset) << " 字节");
+    }
+    return true;
+}
+
+void AuthEventWal::removeSegment(uint64_t sequence) {
+    std::string path = segmentPath(sequence);
+    if (::unlink(path.c_str()) != 0 && errno != ENOENT) {
+        LOG_ERROR(LogSubsystem::STORAGE, "删除预写日志段失败 " << path << ": " << strerror(errno));
+    }
+}
+
+AuthEventWalStats AuthEventWal::getStats() const {
+    AuthEventWalStats stats;
+    stats.appended = appended_.load();
+    stats.syncs = syncs_.load();
+    stats.segments = segments_.load();
+    stats.corrupt_tails = corrupt_tails_.load();
+    return stats;
+}
+
+std::string AuthEventWal::segmentPath(uint64_t sequence) const {
+    char name[64];
+    snprintf(name, sizeof(name), "%s%016llu%s", SEGMENT_PREFIX,
+             static_cast<unsigned long long>(sequence), SEGMENT_SUFFIX);
+    return config_.dir + "/" + name;
+}
+
+bool AuthEventWal::openSegment(uint64_t sequence) {
+    // 先持久化序号，再创建段文件；重启时取两者最大值，序号不会重复使用
+    std::string sequence_path = config_.dir + "/" + SEQUENCE_FILE;
+    std::string temp_path = sequence_path + ".tmp";
+    int sequence_fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    std::string text = std::to_string(sequence) + "\n";
+    bool ok = sequence_fd >= 0 && writeAll(sequence_fd, text.data(), text.size()) &&
+              (!config_.sync || ::fdatasync(sequence_fd) == 0);
+    if (sequence_fd >= 0) {
+        ::close(sequence_fd);
+    }
+    if (!ok || ::rename(temp_path.c_str(), sequence_path.c_str()) != 0) {
+        LOG_ERROR(LogSubsystem::STORAGE, "无法写入预写日志序号文件 " << sequence_path << ": " << strerror(errno));
+        return false;
+    }
+
+    std::string path = segmentPath(sequence);
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOG_ERROR(LogSubsystem::STORAGE, "无法创建预写日志段 " << path << ": " << strerror(errno));
+        return false;
+    }
+    if (config_.sync) {
+        syncDirectory(config_.dir);
+    }
+
+    if (fd_ >= 0) {
+        ::close(fd_);
+        segments_++;
+    }
+    fd_ = fd;
+    active_sequence_ = sequence;
+    active_bytes_ = 0;
+    active_opened_ = std::chrono::steady_clock::now();
+    return true;
+}
+
+bool AuthEventWal::commit(PendingAppend& append) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    pending_.push_back(&append);
+
+    // 已有leader时等待其完成本批次（或后续批次）
+    while (!append.done && leader_active_) {
+        committed_.wait(lock);
+    }
+    if (append.done) {
+        return append.ok;
+    }
+
+    // 成为leader：等待组提交窗口，让并发追加加入同一批次
+    leader_active_ = true;
+    int window_us = config_.sync ? config_.group_commit_us : 0;
+    if (window_us > 0) {
+        lock.unlock();
+        std::this_thread::sleep_for(std::chrono::microseconds(window_us));
+        lock.lock();
+    }
+
+    std::vector<PendingAppend*> batch;
+    batch.swap(pending_);
+    lock.unlock();
+
+    bool ok = writeBatch(batch);
+
+    lock.lock();
+    for (PendingAppend* item : batch) {
+        item->ok = ok;
+        item->done = true;
+    }
+    leader_active_ = false;
+    committed_.notify_all();
+    return append.ok;
+}
+
+bool AuthEventWal::writeBatch(const std::vector<PendingAppend*>& batch) {
+    std::string data;
+    for (PendingAppend* item : batch) {
+        data += *item->record;
+    }
+
+    std::lock_guard<std::mutex> lock(io_mutex_);
+    if (fd_ < 0) {
+        LOG_ERROR(LogSubsystem::STORAGE, "预写日志未打开");
+        return false;
+    }
+
+    // 失败的批次由调用方直接写入数据库，段中不能留下其中任何记录，否则加载时重复入库
+    if (!writeAll(fd_, data.data(), data.size())) {
+        LOG_ERROR(LogSubsystem::STORAGE, "写入预写日志失败: " << strerror(errno));
+        rollbackBatch();
+        return false;
+    }
+    if (config_.sync) {
+        if (::fdatasync(fd_) != 0) {
+            LOG_ERROR(LogSubsystem::STORAGE, "同步预写日志失败: " << strerror(errno));
+            rollbackBatch();
+            return false;
+        }
+        syncs_++;
+    }
+
+    active_bytes_ += data.size();
+    if (active_bytes_ >= config_.segment_bytes) {
+        openSegment(active_sequence_ + 1);
+    }
+    return true;
+}
+
+void AuthEventWal::rollbackBatch() {
+    // 段序号不重复使用，活动段从空文件开始，active_bytes_即已提交记录的长度
+    if (::ftruncate(fd_, static_cast<off_t>(active_bytes_)) != 0) {
+        // 无法截断时隔离整个段（不再匹配段文件名，不会被加载），前active_bytes_字节需人工导入
+        std::string path = segmentPath(active_sequence_);
+        std::string quarantine_path = path + ".quarantine";
+        LOG_ERROR(LogSubsystem::STORAGE, "截断预写日志段失败 " << path << ": " << strerror(errno));
+        if (::rename(path.c_str(), quarantine_path.c_str()) == 0) {
+            LOG_WARN(LogSubsystem::STORAGE, "已隔离预写日志段 " << quarantine_path << "，前 " << active_bytes_
+                      << " 字节为已提交的记录");
+        } else {
+            LOG_ERROR(LogSubsystem::STORAGE, "隔离预写日志段失败 " << path << ": " << strerror(errno));
+        }
+    } else if (config_.sync) {
+        ::fdatasync(fd_);
+    }
+    openSegment(active_sequence_ + 1);
+}
+
+void AuthEventWal::encode(const AuthEvent& event, std::string& out) {
+    std::string payload;
+    payload += static_cast<char>(event.type);
+    putU32(payload, static_cast<uint32_t>(event.user_id));
+    payload += static_cast<char>(event.success ? 1 : 0);
+    putU16(payload, static_cast<uint16_t>(event.created_at.size()));
+    payload += event.created_at;
+    // details由服务端生成，过长时截断以保证记录不超过上限
+    size_t details_size = std::min<size_t>(event.details.size(), MAX_RECORD_SIZE / 2);
+    putU32(payload, static_cast<uint32_t>(details_size));
+    payload.append(event.details, 0, details_size);
+
+    out.reserve(RECORD_HEADER_SIZE + payload.size());
+    putU32(out, static_cast<uint32_t>(payload.size()));
+    putU32(out, crc32(payload.data(), payload.size()));
+    out += payload;
+}
+
+bool AuthEventWal::decode(const char* data, size_t size, AuthEvent& event) {
+    const char* end = data + size;
+    if (size < 8) {
+        return false;
+    }
+    unsigned char type = static_cast<unsigned char>(*data++);
+    if (type > AuthEvent::LAST_LOGIN) {
+        return false;
+    }
+    event.type = static_cast<AuthEvent::Type>(type);
+    event.user_id = static_cast<int>(getU32(data));
+    data += 4;
+    event.success = *data++ != 0;
+
+    uint16_t created_size = getU16(data);
+    data += 2;
+    if (static_cast<size_t>(end - data) < created_size + 4u) {
+        return false;
+    }
+    event.created_at.assign(data, created_size);
+    data += created_size;
+
+    uint32_t details_size = getU32(data);
+    data += 4;
+    if (static_cast<size_t>(end - data) != details_size) {
+        return false;
+    }
+    event.details.assign(data, details_size);
+    return true;
+}
@@ -0,0 +1,381 @@
+#include "auth_event_writer.h"
+#include "logger.h"
+#include "utils.h"
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <algorithm>
+#include <unistd.h>
+
+AuthEventWriter::AuthEventWriter()
+    : storage_(nullptr),
+      wal_active_(false),
+      running_(false),
+      enqueued_(0),
+      written_(0),
+      batches_(0),
+      retries_(0),
+      dead_letters_(0),
+      blocked_(0),
+      wal_segments_(0),
+      wal_pending_(0) {
+}
+
+AuthEventWriter::~AuthEventWriter() {
+    stop();
+}
+
+bool AuthEventWriter::start(Storage& storage, const AuthWriterConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+        return true;
+    }
+
+    storage_ = &storage;
+    config_ = config;
+    if (config_.queue_size == 0) {
+        config_.queue_size = 1;
+    }
+    if (config_.batch_size == 0) {
+        config_.batch_size = 1;
+    }
+
+    wal_active_ = false;
+    if (config_.wal_enabled && !storage_->supportsAuthEventCheckpoint()) {
+        // 没有检查点的后端重放段时既不原子也不幂等，崩溃或部分失败会重复写入
+        LOG_WARN(LogSubsystem::STORAGE, "存储后端 " << storage_->backendName() << " 不支持预写日志检查点，改用内存队列写入认证事件");
+    } else if (config_.wal_enabled) {
+        char host[256] = {0};
+        gethostname(host, sizeof(host) - 1);
+        wal_source_ = std::string(host) + ":" + config_.wal.dir;
+
+        // 新段序号不小于数据库中的检查点，日志目录被清空后也不会被误判为已入库
+        uint64_t checkpoint = 0;
+        if (!storage_->getAuthEventCheckpoint(wal_source_, checkpoint)) {
+            LOG_WARN(LogSubsystem::STORAGE, "无法读取预写日志检查点，按本地序号继续");
+        }
+        wal_active_ = wal_.open(config_.wal, checkpoint);
+        if (!wal_active_) {
+            LOG_WARN(LogSubsystem::STORAGE, "预写日志不可用，改用内存队列写入认证事件");
+        }
+    }
+
+    running_ = true;
+    if (wal_active_) {
+        thread_ = std::thread(&AuthEventWriter::runLoader, this);
+        LOG_INFO(LogSubsystem::STORAGE, "认证事件加载线程已启动，来源: " << wal_source_
+                  << ", 加载间隔: " << config_.wal_load_interval_ms << "ms");
+    } else {
+        thread_ = std::thread(&AuthEventWriter::run, this);
+        LOG_INFO(LogSubsystem::STORAGE, "认证事件写入线程已启动，队列容量: " << config_.queue_size
+                  << ", 批大小: " << config_.batch_size
+                  << ", 刷新间隔: " << config_.flush_interval_ms << "ms");
+    }
+    return true;
+}
+
+void AuthEventWriter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    not_empty_.notify_all();
+    not_full_.notify_all();
+
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    LOG_INFO(LogSubsystem::STORAGE, "认证事件写入线程已停止，写入: " << written_.load()
+              << ", 批次: " << batches_.load()
+              << ", 重试: " << retries_.load()
+              << ", 死信: " << dead_letters_.load());
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (wal_active_) {
+        LOG_INFO(LogSubsystem::STORAGE, "预写日志已入库段: " << wal_segments_.load()
+                  << ", 待入库段: " << wal_pending_.load());
+        wal_active_ = false;
+    }
+}
+
+void AuthEventWriter::logAuthentication(int user_id, bool success, const std::string& details) {
+    AuthEvent event;
+    event.type = AuthEvent::AUTH_LOG;
+    event.user_id = user_id;
+    event.success = success;
+    event.details = details;
+    event.created_at = utils::getCurrentTimestamp();
+    enqueue(std::move(event));
+}
+
+void AuthEventWriter::recordLogin(int user_id) {
+    AuthEvent event;
+    event.type = AuthEvent::LOGIN_RECORD;
+    event.user_id = user_id;
+    event.success = true;
+    event.created_at = utils::getCurrentTimestamp();
+    enqueue(std::move(event));
+}
+
+void AuthEventWriter::updateLastLogin(int user_id) {
+    AuthEvent event;
+    event.type = AuthEvent::LAST_LOGIN;
+    event.user_id = user_id;
+    event.success = true;
+    event.created_at = utils::getCurrentTimestamp();
+    enqueue(std::move(event));
+}
+
+AuthWriterStats AuthEventWriter::getStats() const {
+    AuthWriterStats stats;
+    stats.enqueued = enqueued_.load();
+    stats.written = written_.load();
+    stats.batches = batches_.load();
+    stats.retries = retries_.load();
+    stats.dead_letters = dead_letters_.load();
+    stats.blocked = blocked_.load();
+    stats.wal_segments = wal_segments_.load();
+    stats.wal_pending = wal_pending_.load();
+    return stats;
+}
+
+void AuthEventWriter::enqueue(AuthEvent&& event) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (running_ && wal_active_) {
+        // 追加到预写日志，只依赖本地磁盘；组提交在锁外进行
+        lock.unlock();
+        if (wal_.append(event)) {
+            enqueued_++;
+            return;
+        }
+        // 本地日志写入失败（失败的批次已从段中回滚），退回同步写入数据库
+        std::vector<AuthEvent> batch;
+        batch.push_back(std::move(event));
+        flush(batch);
+        return;
+    }
+    if (running_ && queue_.size() >= config_.queue_size) {
+        blocked_++;
+        not_full_.wait(lock, [this]() { return !running_ || queue_.size() < config_.queue_size; });
+    }
+    if (!running_) {
+        // 写入线程未运行（未启动或已停止，包括等待队列空位期间被停止），直接同步写入，避免丢失事件
+        lock.unlock();
+        std::vector<AuthEvent> batch;
+        batch.push_back(std::move(event));
+        flush(batch);
+        return;
+    }
+
+    queue_.push_back(std::move(event));
+    enqueued_++;
+
+    // 攒够一批再唤醒写入线程，否则等待刷新间隔
+    if (queue_.size() >= config_.batch_size) {
+        not_empty_.notify_one();
+    }
+}
+
+void AuthEventWriter::run() {
+    std::vector<AuthEvent> batch;
+    batch.reserve(config_.batch_size);
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_empty_.wait_for(lock, std::chrono::milliseconds(config_.flush_interval_ms),
+                [this]() { return !running_ || queue_.size() >= config_.batch_size; });
+
+            if (queue_.empty()) {
+                if (!running_) {
+                    break;
+                }
+                continue;
+            }
+
+            size_t count = std::min(queue_.size(), config_.batch_size);
+            for (size_t i = 0; i < count; ++i) {
+                batch.push_back(std::move(queue_.front()));
+                queue_.pop_front();
+            }
+        }
+        not_full_.notify_all();
+
+        flush(batch);
+        batch.clear();
+    }
+}
+
+void AuthEventWriter::runLoader() {
+    while (true) {
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_empty_.wait_for(lock, std::chrono::milliseconds(config_.wal_load_interval_ms),
+                [this]() { return !running_; });
+            stopping = !running_;
+        }
+
+        if (stopping) {
+            // 关闭活动段后最后加载一轮；仍未入库的段保留在磁盘上，下次启动时加载
+            wal_.close();
+            loadSegments();
+            break;
+        }
+
+        wal_.rotateIfDue();
+        loadSegments();
+    }
+}
+
+void AuthEventWriter::loadSegments() {
+    std::vector<uint64_t> sequences = wal_.closedSegments();
+    wal_pending_ = sequences.size();
+
+    for (uint64_t sequence : sequences) {
+        std::vector<AuthEvent> events;
+        if (!wal_.readSegment(sequence, events)) {
+            return;
+        }
+
+        if (!events.empty()) {
+            std::vector<AuthLogEntry> logs;
+            std::vector<LoginRecord> logins;
+            std::map<int, std::string> last_logins;
+            aggregate(events, logs, logins, last_logins);
+
+            // 段按序号顺序入库，失败时保留该段及之后的段，下一轮重试
+            if (!storage_->applyAuthEventBatch(wal_source_, sequence, logs, logins, last_logins)) {
+                retries_++;
+                LOG_WARN(LogSubsystem::STORAGE, "预写日志段 " << sequence << " 入库失败，稍后重试");
+                return;
+            }
+            written_ += events.size();
+            batches_++;
+        }
+
+        wal_.removeSegment(sequence);
+        wal_segments_++;
+        wal_pending_--;
+    }
+}
+
+void AuthEventWriter::aggregate(const std::vector<AuthEvent>& batch,
+                                std::vector<AuthLogEntry>& logs,
+                                std::vector<LoginRecord>& logins,
+                                std::map<int, std::string>& last_logins) {
+    for (const AuthEvent& event : batch) {
+        switch (event.type) {
+        case AuthEvent::AUTH_LOG: {
+            AuthLogEntry entry;
+            entry.user_id = event.user_id;
+            entry.success = event.success;
+            entry.details = event.details;
+            entry.created_at = event.created_at;
+            logs.push_back(entry);
+            break;
+        }
+        case AuthEvent::LOGIN_RECORD: {
+            LoginRecord record;
+            record.user_id = event.user_id;
+            record.created_at = event.created_at;
+            logins.push_back(record);
+            break;
+        }
+        case AuthEvent::LAST_LOGIN: {
+            std::string& latest = last_logins[event.user_id];
+            if (event.created_at > latest) {
+                latest = event.created_at;
+            }
+            break;
+        }
+        }
+    }
+}
+
+void AuthEventWriter::flush(std::vector<AuthEvent>& batch) {
+    if (batch.empty()) {
+        return;
+    }
+
+    std::vector<AuthLogEntry> logs;
+    std::vector<LoginRecord> logins;
+    std::map<int, std::string> last_logins;
+    aggregate(batch, logs, logins, last_logins);
+
+    bool logs_done = logs.empty();
+    bool logins_done = logins.empty();
+    bool last_logins_done = last_logins.empty();
+
+    for (int attempt = 0; attempt <= config_.max_retries; ++attempt) {
+        if (attempt > 0) {
+            retries_++;
+            // 指数退避，移位次数与单次等待都有上限，max_retries很大时也不会溢出
+            int delay_ms = std::min(100 << std::min(attempt - 1, 6), 5000);
+            std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+        }
+        if (writeBatch(logs, logins, last_logins, logs_done, logins_done, last_logins_done)) {
+            break;
+        }
+    }
+
+    batches_++;
+
+    // 只把仍未写入的事件类型写入死信文件
+    std::vector<AuthEvent> failed;
+    for (AuthEvent& event : batch) {
+        bool done = (event.type == AuthEvent::AUTH_LOG && logs_done) ||
+                    (event.type == AuthEvent::LOGIN_RECORD && logins_done) ||
+                    (event.type == AuthEvent::LAST_LOGIN && last_logins_done);
+        if (done) {
+            written_++;
+        } else {
+            failed.push_back(std::move(event));
+        }
+    }
+
+    if (!failed.empty()) {
+        writeDeadLetters(failed);
+    }
+}
+
+bool AuthEventWriter::writeBatch(const std::vector<AuthLogEntry>& logs,
+                                 const std::vector<LoginRecord>& logins,
+                                 const std::map<int, std::string>& last_logins,
+                                 bool& logs_done, bool& logins_done, bool& last_logins_done) {
+    if (!storage_) {
+        return false;
+    }
+    if (!logs_done) {
+        logs_done = storage_->insertAuthLogs(logs);
+    }
+    if (!logins_done) {
+        logins_done = storage_->insertLoginRecords(logins);
+    }
+    if (!last_logins_done) {
+        last_logins_done = storage_->updateLastLogins(last_logins);
+    }
+    return logs_done && logins_done && last_logins_done;
+}
+
+void AuthEventWriter::writeDeadLetters(const std::vector<AuthEvent>& batch) {
+    std::ofstream file(config_.dead_letter_path.c_str(), std::ios::app);
+    if (!file) {
+        LOG_ERROR(LogSubsystem::STORAGE, "无法打开死信文件: " << config_.dead_letter_path
+                  << "，丢弃 " << batch.size() << " 条认证事件");
+        return;
+    }
+
+    static const char* const TYPE_NAMES[] = {"auth_log", "login_record", "last_login"};
+    for (const AuthEvent& event : batch) {
+        file << event.created_at << '\t' << TYPE_NAMES[event.type] << '\t' << event.user_id
+             << '\t' << (event.success ? 1 : 0) << '\t' << event.details << '\n';
+    }
+
+    dead_letters_ += batch.size();
+    LOG_ERROR(LogSubsystem::STORAGE, "认证事件写入失败，已写入死信文件 " << config_.dead_letter_path
+              << ": " << batch.size() << " 条");
+}
@@ -1,63 +1,184 @@
 #include "auth_server.h"
+#include "mat_pool.h"
+#include "blob_store.h"
 #include "utils.h"
 #include <fstream>
 #include <iostream>
 #include <opencv2/opencv.hpp>
 #include <json/json.h>
 #include <chrono>
+#include <future>
+#include <algorithm>
 #include <ctime>
 #include <sys/stat.h>
 #include <dirent.h>
 #include <unistd.h>
 
-AuthServer::AuthServer() : running_(false) {
+namespace {
+
+// 人脸相似度阈值（OpenCV LBPH置信度越低越相似，与MSE相反）
+const double FACE_SIMILARITY_THRESHOLD = 70.0;
+
+const size_t QUALITY_RESULT_COUNT = static_cast<size_t>(QualityResult::BLURRY) + 1;
+const size_t TOKEN_STATUS_COUNT = static_cast<size_t>(TokenStatus::REVOKED) + 1;
+
+// 按原因统计的拒绝次数；调用处用static引用缓存，不在每个请求上查找注册表
+Counter& rejectCounter(const std::string& reason) {
+    return MetricsRegistry::instance().counter("face_auth_rejects_total", "reason", reason);
+}
+
+cv::Rect largestFace(const std::vector<cv::Rect>& faces) {
+    return *std::max_element(faces.begin(), faces.end(),
+        [](const cv::Rect& a, const cv::Rect& b) { return a.area() < b.area(); });
+}
+
+} // namespace
+
+AuthServer::AuthServer()
+    : cpu_executor_("cpu"),
+      io_executor_("io"),
+      parse_stage_("parse", nullptr),
+      lookup_stage_("lookup", &io_executor_),
+      decode_stage_("decode", &cpu_executor_),
+      quality_stage_("quality", &cpu_executor_),
+      detect_stage_("detect", &cpu_executor_),
+      preprocess_stage_("preprocess", &cpu_executor_),
+      match_stage_("match", &cpu_executor_),
+      persist_stage_("persist", &io_executor_),
+      keep_original_face_(false),
+      maintenance_stop_(false),
+      running_(false) {
     // 默认配置
     model_path_ = "models/haarcascade_frontalface_default.xml";
-    db_host_ = "localhost";
-    db_user_ = "root";
-    db_password_ = "4819603p";
-    db_name_ = "face_auth_db";
+    db_config_.host = "localhost";
+    db_config_.user = "root";
+    db_config_.password = "4819603p";
+    db_config_.database = "face_auth_db";
+    mat_pool_enabled_ = true;
+    mat_pool_thread_cache_bytes_ = 32 * 1024 * 1024;
+    mat_pool_max_cached_bytes_ = 256 * 1024 * 1024;
+    cpu_executor_config_.threads = 0;  // 0表示与CPU核数相同
+    io_executor_config_.threads = 0;   // 0表示与数据库连接池大小相同
+    admin_socket_path_ = "face_auth_data/admin.sock";
+    stats_message_enabled_ = false;
 }
 
 AuthServer::~AuthServer() {
     stop();
+    stopMaintenance();
 }
 
 bool AuthServer::initialize(const std::string& config_file) {
     // 加载配置文件
     if (!loadConfig(config_file)) {
-        std::cerr << "无法加载配置" << std::endl;
+        LOG_ERROR(LogSubsystem::SERVER, "无法加载配置");
+        return false;
+    }
+
+    // 启动异步日志（此前的日志同步输出）
+    if (!Logger::instance().start(logger_config_)) {
+        std::cerr << "无法启动日志" << std::endl;
         return false;
     }
 
     // 创建必要的目录
     ensureDirectories();
 
+    // 安装图像缓冲区内存池（需在创建任何工作线程之前）
+    if (mat_pool_enabled_) {
+        PooledMatAllocator::instance().install(mat_pool_thread_cache_bytes_,
+                                               mat_pool_max_cached_bytes_);
+    }
+
     // 初始化人脸检测器
     if (!face_detector_.initialize(model_path_)) {
-        std::cerr << "无法初始化人脸检测器" << std::endl;
+        LOG_ERROR(LogSubsystem::SERVER, "无法初始化人脸检测器");
         return false;
     }
 
     // 初始化人脸识别器
     if (!face_recognizer_.initialize()) {
-        std::cerr << "无法初始化人脸识别器" << std::endl;
+        LOG_ERROR(LogSubsystem::SERVER, "无法初始化人脸识别器");
+        return false;
+    }
+
+    // 配置人脸图像存储
+    BlobStore::instance().configure(blob_store_config_);
+
+    // 创建存储后端并连接
+    storage_ = createStorage(db_config_.backend);
+    if (!storage_) {
+        LOG_ERROR(LogSubsystem::SERVER, "无法创建存储后端: " << db_config_.backend);
         return false;
     }
+    LOG_INFO(LogSubsystem::SERVER, "存储后端: " << storage_->backendName());
 
-    // 连接数据库
-    if (!db_manager_.connect(db_host_, db_user_, db_password_, db_name_)) {
-        std::cerr << "无法连接到数据库" << std::endl;
+    if (!storage_->connect(db_config_)) {
+        LOG_ERROR(LogSubsystem::SERVER, "无法连接到数据库");
         return false;
     }
 
     // 创建数据库表
-    if (!db_manager_.createTables()) {
-        std::cerr << "无法创建数据库表" << std::endl;
+    if (!storage_->createTables()) {
+        LOG_ERROR(LogSubsystem::SERVER, "无法创建数据库表");
         return false;
     }
 
-    std::cout << "认证服务器初始化成功" << std::endl;
+    // 立即执行一次存储维护（创建当天及之后的分区），之后由后台线程定期执行
+    storage_->runMaintenance();
+    startMaintenance();
+
+    // 预热用户目录缓存
+    user_cache_.configure(user_cache_config_);
+    user_cache_.warm(*storage_);
+
+    // 启动CPU与I/O线程池：CPU线程数默认等于核数；
+    // 每个I/O线程最多占用一个数据库连接，线程数默认等于连接池大小
+    ExecutorConfig cpu_config = cpu_executor_config_;
+    if (cpu_config.threads == 0) {
+        cpu_config.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    cpu_executor_.start(cpu_config);
+
+    ExecutorConfig io_config = io_executor_config_;
+    if (io_config.threads == 0) {
+        io_config.threads = db_config_.pool_size;
+    }
+    io_executor_.start(io_config);
+    async_storage_.attach(*storage_, lookup_stage_, persist_stage_);
+
+    // 启动后台注册训练线程
+    enrollment_trainer_.start(face_recognizer_, *storage_, enrollment_trainer_config_);
+
+    // 启动认证事件异步写入线程
+    if (!auth_writer_.start(*storage_, auth_writer_config_)) {
+        LOG_ERROR(LogSubsystem::SERVER, "无法启动认证事件写入线程");
+        return false;
+    }
+
+    // 会话令牌签名密钥
+    if (!token_manager_.configure(token_config_)) {
+        return false;
+    }
+
+    // 最近请求帧的内存环形缓冲，替代逐请求写调试文件
+    frame_ring_.configure(capture_config_.ring_size, capture_config_.ring_sample_rate);
+    
+    // 启动本地管理套接字（Prometheus格式指标）
+    if (!admin_socket_path_.empty()) {
+        admin_server_.addCommand("metrics", [this](const std::string&) { return getPrometheusMetrics(); });
+        admin_server_.addCommand("stats", [this](const std::string&) { return getStats().toStyledString(); });
+        admin_server_.addCommand("frames", [this](const std::string& args) { return dumpFrames(args); });
+        admin_server_.addCommand("revoke", [this](const std::string& args) {
+            return revokeToken(args)["message"].asString() + "\n";
+        });
+        if (!admin_server_.start(admin_socket_path_)) {
+            LOG_ERROR(LogSubsystem::SERVER, "无法启动管理套接字");
+            return false;
+        }
+    }
+
+    LOG_INFO(LogSubsystem::SERVER, "认证服务器初始化成功");
     return true;
 }
 
@@ -97,7 +218,7 @@ void AuthServer::ensureDirectories() {
     for (const auto& dir : dirs) {
         if (!dirExists(dir)) {
             if (createDirectory(dir)) {
-                std::cout << "创建目录: " << dir << std::endl;
+                LOG_INFO(LogSubsystem::SERVER, "创建目录: " << dir);
             } else {
                 throw std::runtime_error("无法创建目录: " + dir);
             }
@@ -111,7 +232,7 @@ void AuthServer::ensureDirectories() {
         test << "test";
         test.close();
         if (removeFile(test_file)) {
-            std::cout << "目录权限验证" << std::endl;
+            LOG_INFO(LogSubsystem::SERVER, "目录权限验证");
         } else {
             throw std::runtime_error("无法删除测试文件, 权限问题");
         }
@@ -130,8 +251,92 @@ void AuthServer::stop() {
     std::lock_guard<std::mutex> lock(mutex_);
     if (running_) {
         running_ = false;
-        // 断开数据库连接
-        db_manager_.disconnect();
+
+        admin_server_.stop();
+
+        // 先执行完在途的计算与I/O任务并写完队列中的认证事件，再断开数据库
+        cpu_executor_.stop();
+        io_executor_.stop();
+        enrollment_trainer_.stop();
+        auth_writer_.stop();
+
+        for (const StageStats& stage : getStageStats()) {
+            LOG_INFO(LogSubsystem::SERVER, "流水线阶段 " << stage.name << " (" << stage.executor << "): 完成 " << stage.completed
+                      << " 次, 平均排队 " << static_cast<long>(stage.avg_wait_us)
+                      << "us, 平均执行 " << static_cast<long>(stage.avg_run_us)
+                      << "us, 最长执行 " << stage.max_run_us
+                      << "us, 队列峰值 " << stage.max_queue_depth);
+        }
+        stopMaintenance();
+
+        if (user_cache_.isEnabled()) {
+            UserCacheStats cache_stats = user_cache_.getStats();
+            LOG_INFO(LogSubsystem::SERVER, "用户目录缓存统计: 命中 " << cache_stats.hits
+                      << " 次, 未命中 " << cache_stats.misses
+                      << " 次, 过期 " << cache_stats.expirations
+                      << " 次, 淘汰 " << cache_stats.evictions
+                      << " 次, 当前 " << cache_stats.size << " 个用户");
+        }
+
+        if (storage_) {
+            DBStatementStats stmt_stats = storage_->getStatementStats();
+            LOG_INFO(LogSubsystem::SERVER, "预处理语句统计: 准备 " << stmt_stats.prepares
+                      << " 次, 执行 " << stmt_stats.executes
+                      << " 次, 缓存命中 " << stmt_stats.cache_hits << " 次");
+
+            // 断开存储连接
+            storage_->disconnect();
+        }
+
+        BlobStoreStats blob_stats = BlobStore::instance().getStats();
+        LOG_INFO(LogSubsystem::SERVER, "人脸图像存储统计: 写入 " << blob_stats.writes
+                  << " 个文件 (" << blob_stats.bytes << " 字节), 去重 " << blob_stats.dedup_hits
+                  << " 次, fsync批次 " << blob_stats.sync_batches);
+
+        if (mat_pool_enabled_) {
+            MatPoolStats stats = PooledMatAllocator::instance().getStats();
+            LOG_INFO(LogSubsystem::SERVER, "Mat内存池统计: 分配 " << stats.allocations
+                      << " 次, 复用 " << stats.pool_hits
+                      << " 次, 超大分配 " << stats.oversize
+                      << " 次, 峰值 " << stats.peak_pooled_bytes << " 字节");
+        }
+    }
+}
+
+void AuthServer::startMaintenance() {
+    {
+        std::lock_guard<std::mutex> lock(maintenance_mutex_);
+        if (maintenance_thread_.joinable()) {
+            return;
+        }
+        maintenance_stop_ = false;
+    }
+
+    int interval = std::max(1, db_config_.maintenance_interval);
+    maintenance_thread_ = std::thread([this, interval]() {
+        std::unique_lock<std::mutex> lock(maintenance_mutex_);
+        while (!maintenance_stop_) {
+            if (maintenance_cv_.wait_for(lock, std::chrono::seconds(interval),
+                                         [this]() { return maintenance_stop_; })) {
+                break;
+            }
+            lock.unlock();
+            if (!storage_->runMaintenance()) {
+                LOG_ERROR(LogSubsystem::SERVER, "存储维护任务执行失败");
+            }
+            lock.lock();
+        }
+    });
+}
+
+void AuthServer::stopMaintenance() {
+    {
+        std::lock_guard<std::mutex> lock(maintenance_mutex_);
+        maintenance_stop_ = true;
+    }
+    maintenance_cv_.notify_all();
+    if (maintenance_thread_.joinable()) {
+        maintenance_thread_.join();
     }
 }
 
@@ -139,14 +344,14 @@ bool AuthServer::loadConfig(const std::string& config_file) {
     try {
         std::ifstream file(config_file);
         if (!file.is_open()) {
-            std::cerr << "无法打开配置文件: " << config_file << std::endl;
+            LOG_ERROR(LogSubsystem::SERVER, "无法打开配置文件: " << config_file);
             return false;
         }
 
         Json::Value root;
         Json::Reader reader;
         if (!reader.parse(file, root)) {
-            std::cerr << "无法解析配置文件: " << reader.getFormattedErrorMessages() << std::endl;
+            LOG_ERROR(LogSubsystem::SERVER, "无法解析配置文件: " << reader.getFormattedErrorMessages());
             return false;
         }
 
@@ -156,15 +361,214 @@ bool AuthServer::loadConfig(const std::string& config_file) {
 
         if (root.isMember("database")) {
             const Json::Value& db = root["database"];
-            if (db.isMember("host")) db_host_ = db["host"].asString();
-            if (db.isMember("user")) db_user_ = db["user"].asString();
-            if (db.isMember("password")) db_password_ = db["password"].asString();
-            if (db.isMember("name")) db_name_ = db["name"].asString();
+            if (db.isMember("backend")) db_config_.backend = db["backend"].asString();
+            if (db.isMember("path")) db_config_.path = db["path"].asString();
+            if (db.isMember("host")) db_config_.host = db["host"].asString();
+            if (db.isMember("user")) db_config_.user = db["user"].asString();
+            if (db.isMember("password")) db_config_.password = db["password"].asString();
+            if (db.isMember("name")) db_config_.database = db["name"].asString();
+            if (db.isMember("pool_size")) db_config_.pool_size = db["pool_size"].asUInt();
+            if (db.isMember("health_check_interval")) {
+                db_config_.health_check_interval = db["health_check_interval"].asInt();
+            }
+            if (db.isMember("checkout_timeout_ms")) {
+                db_config_.checkout_timeout_ms = db["checkout_timeout_ms"].asInt();
+            }
+            if (db.isMember("auth_log_retention_days")) {
+                db_config_.auth_log_retention_days = db["auth_log_retention_days"].asInt();
+            }
+            if (db.isMember("auth_log_partition_ahead_days")) {
+                db_config_.auth_log_partition_ahead_days = db["auth_log_partition_ahead_days"].asInt();
+            }
+            if (db.isMember("maintenance_interval")) {
+                db_config_.maintenance_interval = db["maintenance_interval"].asInt();
+            }
+        }
+
+        if (root.isMember("memory_pool")) {
+            const Json::Value& pool = root["memory_pool"];
+            if (pool.isMember("enabled")) mat_pool_enabled_ = pool["enabled"].asBool();
+            if (pool.isMember("thread_cache_mb")) {
+                mat_pool_thread_cache_bytes_ = static_cast<size_t>(pool["thread_cache_mb"].asUInt()) << 20;
+            }
+            if (pool.isMember("max_cached_mb")) {
+                mat_pool_max_cached_bytes_ = static_cast<size_t>(pool["max_cached_mb"].asUInt()) << 20;
+            }
+        }
+
+        if (root.isMember("enrollment")) {
+            const Json::Value& enrollment = root["enrollment"];
+            if (enrollment.isMember("keep_original")) {
+                keep_original_face_ = enrollment["keep_original"].asBool();
+            }
+            if (enrollment.isMember("train_batch_size")) {
+                enrollment_trainer_config_.batch_size = enrollment["train_batch_size"].asUInt();
+            }
+            if (enrollment.isMember("train_interval_ms")) {
+                enrollment_trainer_config_.flush_interval_ms = enrollment["train_interval_ms"].asInt();
+            }
+            if (enrollment.isMember("reconcile_on_start")) {
+                enrollment_trainer_config_.reconcile_on_start = enrollment["reconcile_on_start"].asBool();
+            }
+        }
+
+        if (root.isMember("metrics")) {
+            const Json::Value& metrics = root["metrics"];
+            if (metrics.isMember("admin_socket")) admin_socket_path_ = metrics["admin_socket"].asString();
+            if (metrics.isMember("stats_message")) stats_message_enabled_ = metrics["stats_message"].asBool();
+        }
+
+        if (root.isMember("capture")) {
+            const Json::Value& capture = root["capture"];
+            if (capture.isMember("enabled")) capture_config_.enabled = capture["enabled"].asBool();
+            if (capture.isMember("path")) capture_config_.path = capture["path"].asString();
+            if (capture.isMember("sample_rate")) capture_config_.sample_rate = capture["sample_rate"].asDouble();
+            if (capture.isMember("payload_bytes")) capture_config_.payload_bytes = capture["payload_bytes"].asInt64();
+            if (capture.isMember("max_file_bytes")) {
+                capture_config_.max_file_bytes = static_cast<size_t>(capture["max_file_bytes"].asUInt64());
+            }
+            if (capture.isMember("max_files")) capture_config_.max_files = capture["max_files"].asInt();
+            if (capture.isMember("queue_size")) capture_config_.queue_size = capture["queue_size"].asUInt();
+            if (capture.isMember("ring_size")) capture_config_.ring_size = capture["ring_size"].asUInt();
+            if (capture.isMember("ring_sample_rate")) {
+                capture_config_.ring_sample_rate = capture["ring_sample_rate"].asDouble();
+            }
+        }
+
+        if (root.isMember("quality")) {
+            const Json::Value& quality = root["quality"];
+            if (quality.isMember("enabled")) quality_config_.enabled = quality["enabled"].asBool();
+            if (quality.isMember("min_width")) quality_config_.min_width = quality["min_width"].asInt();
+            if (quality.isMember("min_height")) quality_config_.min_height = quality["min_height"].asInt();
+            if (quality.isMember("analysis_size")) quality_config_.analysis_size = quality["analysis_size"].asInt();
+            if (quality.isMember("min_sharpness")) quality_config_.min_sharpness = quality["min_sharpness"].asDouble();
+            if (quality.isMember("min_brightness")) quality_config_.min_brightness = quality["min_brightness"].asDouble();
+            if (quality.isMember("max_brightness")) quality_config_.max_brightness = quality["max_brightness"].asDouble();
+        }
+
+        if (root.isMember("token")) {
+            const Json::Value& token = root["token"];
+            if (token.isMember("enabled")) token_config_.enabled = token["enabled"].asBool();
+            if (token.isMember("ttl_seconds")) token_config_.ttl_seconds = token["ttl_seconds"].asInt();
+            if (token_config_.enabled && token_config_.ttl_seconds <= 0) {
+                LOG_ERROR(LogSubsystem::SERVER, "令牌有效期必须为正数: " << token_config_.ttl_seconds);
+                return false;
+            }
+            if (token.isMember("secret")) token_config_.secret = token["secret"].asString();
+            if (token.isMember("revocation_capacity")) {
+                token_config_.revocation_capacity = token["revocation_capacity"].asUInt();
+            }
+        }
+
+        if (root.isMember("session")) {
+            const Json::Value& session = root["session"];
+            if (session.isMember("enabled")) session_config_.enabled = session["enabled"].asBool();
+            if (session.isMember("max_frames")) session_config_.max_frames = session["max_frames"].asUInt();
+            if (session.isMember("max_in_flight")) session_config_.max_in_flight = session["max_in_flight"].asUInt();
+            if (session.isMember("margin")) session_config_.margin = session["margin"].asDouble();
+            if (session.isMember("accept_bound")) session_config_.accept_bound = session["accept_bound"].asDouble();
+            if (session.isMember("reject_bound")) session_config_.reject_bound = session["reject_bound"].asDouble();
+            if (session.isMember("timeout_ms")) session_config_.timeout_ms = session["timeout_ms"].asInt();
+        }
+
+        if (root.isMember("logging")) {
+            const Json::Value& logging = root["logging"];
+            if (logging.isMember("level")) {
+                if (!Logger::parseLevel(logging["level"].asString(), logger_config_.level)) {
+                    std::cerr << "未知日志级别: " << logging["level"].asString() << std::endl;
+                    return false;
+                }
+                for (LogLevel& level : logger_config_.subsystem_levels) {
+                    level = logger_config_.level;
+                }
+            }
+            // 子系统级别覆盖默认级别
+            if (logging.isMember("subsystems")) {
+                const Json::Value& subsystems = logging["subsystems"];
+                for (const std::string& name : subsystems.getMemberNames()) {
+                    LogSubsystem subsystem;
+                    LogLevel level;
+                    if (!Logger::parseSubsystem(name, subsystem) ||
+                        !Logger::parseLevel(subsystems[name].asString(), level)) {
+                        std::cerr << "无效的日志子系统配置: " << name << std::endl;
+                        return false;
+                    }
+                    logger_config_.subsystem_levels[static_cast<int>(subsystem)] = level;
+                }
+            }
+            if (logging.isMember("format") &&
+                !Logger::parseFormat(logging["format"].asString(), logger_config_.format)) {
+                std::cerr << "未知日志格式: " << logging["format"].asString() << std::endl;
+                return false;
+            }
+            if (logging.isMember("file")) logger_config_.file = logging["file"].asString();
+            if (logging.isMember("queue_size")) logger_config_.queue_size = logging["queue_size"].asUInt();
+            if (logging.isMember("flush_interval_ms")) {
+                logger_config_.flush_interval_ms = logging["flush_interval_ms"].asInt();
+            }
+        }
+
+        if (root.isMember("blob_store")) {
+            const Json::Value& blob = root["blob_store"];
+            if (blob.isMember("root")) blob_store_config_.root = blob["root"].asString();
+            if (blob.isMember("fsync")) blob_store_config_.fsync = blob["fsync"].asBool();
+            if (blob.isMember("group_commit_us")) {
+                blob_store_config_.group_commit_us = blob["group_commit_us"].asInt();
+            }
+        }
+
+        if (root.isMember("user_cache")) {
+            const Json::Value& cache = root["user_cache"];
+            if (cache.isMember("enabled")) user_cache_config_.enabled = cache["enabled"].asBool();
+            if (cache.isMember("capacity")) user_cache_config_.capacity = cache["capacity"].asUInt();
+            if (cache.isMember("ttl_seconds")) user_cache_config_.ttl_seconds = cache["ttl_seconds"].asInt();
+            if (cache.isMember("shards")) user_cache_config_.shards = cache["shards"].asUInt();
+            if (cache.isMember("warm_threads")) user_cache_config_.warm_threads = cache["warm_threads"].asUInt();
+            if (cache.isMember("warm_chunk_size")) {
+                user_cache_config_.warm_chunk_size = cache["warm_chunk_size"].asUInt();
+            }
+        }
+
+        if (root.isMember("cpu_executor")) {
+            const Json::Value& cpu = root["cpu_executor"];
+            if (cpu.isMember("threads")) cpu_executor_config_.threads = cpu["threads"].asUInt();
+            if (cpu.isMember("queue_size")) cpu_executor_config_.queue_size = cpu["queue_size"].asUInt();
+        }
+
+        if (root.isMember("io_executor")) {
+            const Json::Value& io = root["io_executor"];
+            if (io.isMember("threads")) io_executor_config_.threads = io["threads"].asUInt();
+            if (io.isMember("queue_size")) io_executor_config_.queue_size = io["queue_size"].asUInt();
+        }
+
+        if (root.isMember("auth_writer")) {
+            const Json::Value& writer = root["auth_writer"];
+            if (writer.isMember("queue_size")) auth_writer_config_.queue_size = writer["queue_size"].asUInt();
+            if (writer.isMember("batch_size")) auth_writer_config_.batch_size = writer["batch_size"].asUInt();
+            if (writer.isMember("flush_interval_ms")) {
+                auth_writer_config_.flush_interval_ms = writer["flush_interval_ms"].asInt();
+            }
+            if (writer.isMember("max_retries")) auth_writer_config_.max_retries = writer["max_retries"].asInt();
+            if (writer.isMember("wal")) {
+                const Json::Value& wal = writer["wal"];
+                AuthEventWalConfig& wal_config = auth_writer_config_.wal;
+                if (wal.isMember("enabled")) auth_writer_config_.wal_enabled = wal["enabled"].asBool();
+                if (wal.isMember("dir")) wal_config.dir = wal["dir"].asString();
+                if (wal.isMember("segment_bytes")) wal_config.segment_bytes = wal["segment_bytes"].asUInt();
+                if (wal.isMember("segment_max_age_ms")) {
+                    wal_config.segment_max_age_ms = wal["segment_max_age_ms"].asInt();
+                }
+                if (wal.isMember("sync")) wal_config.sync = wal["sync"].asBool();
+                if (wal.isMember("group_commit_us")) wal_config.group_commit_us = wal["group_commit_us"].asInt();
+                if (wal.isMember("load_interval_ms")) {
+                    auth_writer_config_.wal_load_interval_ms = wal["load_interval_ms"].asInt();
+                }
+            }
         }
 
         return true;
     } catch (const std::exception& e) {
-        std::cerr << "加载配置错误: " << e.what() << std::endl;
+        LOG_ERROR(LogSubsystem::SERVER, "加载配置错误: " << e.what());
         return false;
     }
 }
@@ -195,43 +599,63 @@ Json::Value AuthServer::registerUser(const std::string& username, const std::str
     }
 
     try {
-        // 解码人脸数据
-        cv::Mat face_image = decodeImage(face_data);
+        // 解码人脸数据并检查质量
+        QualityResult quality = QualityResult::OK;
+        cv::Mat face_image = decode_stage_.submit(
+            [this, &face_data, &quality]() { return decodeChecked(face_data, quality); }).get();
         if (face_image.empty()) {
+            static Counter& rejects = rejectCounter("register_invalid_image");
+            rejects.increment();
             response["success"] = false;
             response["message"] = "无效人脸图像数据";
             return response;
         }
 
-        // 检测人脸
-        std::vector<cv::Rect> faces = face_detector_.detectFaces(face_image);
-        if (faces.empty()) {
+        // 模糊、过暗过亮或过小的图像不进入检测
+        if (quality != QualityResult::OK) {
+            static EnumMetricCache<Counter, QualityResult, QUALITY_RESULT_COUNT> rejects([](QualityResult result) -> Counter& {
+                return rejectCounter(std::string("register_") + qualityReason(result));
+            });
+            rejects[quality].increment();
+            response["success"] = false;
+            response["message"] = qualityMessage(quality);
+            response["quality"] = qualityReason(quality);
+            return response;
+        }
+
+        // 检测人脸，提取最大的人脸区域
+        cv::Rect face;
+        if (!detectLargestFace(face_image, face)) {
+            static Counter& rejects = rejectCounter("register_no_face");
+            rejects.increment();
             response["success"] = false;
             response["message"] = "图像中未检测到人脸";
             return response;
         }
+        cv::Mat face_roi = face_image(face);
 
-        // 保存用户信息到数据库
-        if (!db_manager_.addUser(username, password, face_data)) {
+        // 保存用户信息到数据库（注册人脸保存为标准化人脸），在I/O线程上执行
+        std::vector<FaceImage> enrollment_faces = preprocess_stage_.submit(
+            [this, &face_data, &face_roi]() { return buildEnrollmentFaces(face_data, face_roi); }).get();
+        if (!async_storage_.addUser(username, password, std::move(enrollment_faces)).get()) {
             response["success"] = false;
             response["message"] = "无法将用户添加到数据库";
             return response;
         }
 
-        // 在注册时训练人脸识别模型
-        cv::Rect face = *std::max_element(faces.begin(), faces.end(), 
-            [](const cv::Rect& a, const cv::Rect& b) { return a.area() < b.area(); });
-        cv::Mat face_roi = face_image(face);
-        
-        // 获取用户ID
-        UserInfo user = db_manager_.getUserByUsername(username);
+        // 获取用户ID，同时写入用户目录缓存
+        UserInfo user = async_storage_.getUserByUsername(username).get();
         if (user.id > 0) {
-            face_recognizer_.train(user.id, face_roi);
-            std::cout << "已训练人脸识别模型，用户ID: " << user.id << std::endl;
+            user_cache_.put(user);
+
+            // 人脸模板已保存，交给后台训练器批量加入识别模型，不等待训练完成
+            enrollment_trainer_.enqueue(user.id, face_roi.clone());
+            LOG_DEBUG(LogSubsystem::AUTH, "人脸已加入训练队列，用户ID: " << user.id);
         }
 
         response["success"] = true;
         response["message"] = "用户注册成功";
+        response["enrollment_status"] = EnrollmentTrainer::statusName(enrollment_trainer_.status(user.id));
         return response;
     } catch (const std::exception& e) {
         response["success"] = false;
@@ -244,7 +668,7 @@ Json::Value AuthServer::authenticateUser(const std::string& username, const std:
     Json::Value response;
     response["type"] = "login";
 
-    std::cout << "正在认证用户: " << username << std::endl;
+    LOG_DEBUG(LogSubsystem::AUTH, "正在认证用户: " << username);
 
     // 验证用户名和密码
     if (username.empty() || password.empty()) {
@@ -261,177 +685,424 @@ Json::Value AuthServer::authenticateUser(const std::string& username, const std:
     }
 
     try {
-        // 获取用户信息
-        UserInfo user = db_manager_.getUserByUsername(username);
-        std::cout << "查询到的用户ID: " << user.id << ", 用户名: " << user.username << std::endl;
-        
-        if (user.id == 0) {
-            response["success"] = false;
-            response["message"] = "用户未找到";
-            return response;
+        // 用户查询（I/O线程池）与登录图像解码（CPU线程池）同时进行；用户目录缓存命中时不访问数据库
+        UserInfo user;
+        bool cached = user_cache_.get(username, user);
+        std::future<UserInfo> lookup;
+        if (!cached) {
+            lookup = async_storage_.getUserByUsername(username);
         }
-        
-        std::cout << "用户的人脸文件路径: " << user.file_path << std::endl;
+        QualityResult quality = QualityResult::OK;
+        std::future<cv::Mat> decoded = decode_stage_.submit(
+            [this, &face_data, &quality]() { return decodeChecked(face_data, quality); });
 
-        // 验证密码 - 从数据库获取用户的实际密码
-        std::string hashed_password = utils::sha256(password);
-        std::string stored_password = db_manager_.getUserPassword(user.id);
-        
-        std::cout << "输入的密码哈希: " << hashed_password << std::endl;
-        std::cout << "存储的密码哈希: " << stored_password << std::endl;
-        
-        if (hashed_password != stored_password) {
-            response["success"] = false;
-            response["message"] = "无效密码";
-            db_manager_.logAuthentication(user.id, false, "密码验证失败");
+        // 先等待解码：任务引用了face_data与quality，不能在其完成前返回
+        cv::Mat login_face_image = decoded.get();
+        if (!cached) {
+            user = lookup.get();
+            user_cache_.fill(user);
+        }
+        if (!verifyCredentials(user, password, response)) {
             return response;
         }
 
         // 验证人脸数据
-        cv::Mat login_face_image = decodeImage(face_data);
         if (login_face_image.empty()) {
+            static Counter& rejects = rejectCounter("invalid_image");
+            rejects.increment();
             response["success"] = false;
             response["message"] = "无效人脸图像数据";
-            db_manager_.logAuthentication(user.id, false, "无效人脸图像");
+            logAuthEvent(user.id, false, "无效人脸图像");
             return response;
         }
         
-        std::cout << "成功解码登录人脸图像，尺寸: " 
-                  << login_face_image.cols << "x" << login_face_image.rows << std::endl;
+        LOG_DEBUG(LogSubsystem::AUTH, "成功解码登录人脸图像，尺寸: " 
+                  << login_face_image.cols << "x" << login_face_image.rows);
 
-        // 检测人脸
-        std::vector<cv::Rect> login_faces = face_detector_.detectFaces(login_face_image);
-        std::cout << "登录图像中检测到 " << login_faces.size() << " 个人脸" << std::endl;
-        
-        if (login_faces.empty()) {
+        // 质量不合格的图像直接拒绝，不读取注册人脸、不做检测与匹配
+        if (quality != QualityResult::OK) {
+            static EnumMetricCache<Counter, QualityResult, QUALITY_RESULT_COUNT> rejects([](QualityResult result) -> Counter& {
+                return rejectCounter(qualityReason(result));
+            });
+            rejects[quality].increment();
             response["success"] = false;
-            response["message"] = "登录图像中未检测到人脸";
-            db_manager_.logAuthentication(user.id, false, "未检测到人脸");
+            response["message"] = qualityMessage(quality);
+            response["quality"] = qualityReason(quality);
+            logAuthEvent(user.id, false, std::string("图像质量不合格: ") + qualityReason(quality));
             return response;
         }
 
-        // 获取用户的注册人脸数据
-        cv::Mat registered_face_image;
-        if (user.file_path != "LOGIN_IMAGE_NOT_SAVED") {
-            // 尝试使用相对路径或绝对路径读取注册人脸
-            std::string absolute_path = user.file_path;
-            // 如果是相对路径，转换为绝对路径
-            if (user.file_path.find("/") != 0) {
-                // 相对于当前工作目录的路径
-                char cwd[1024];
-                if (getcwd(cwd, sizeof(cwd)) != NULL) {
-                    absolute_path = std::string(cwd) + "/" + user.file_path;
-                    std::cout << "转换为绝对路径: " << absolute_path << std::endl;
-                }
-            }
-            
-            // 从文件中读取注册人脸
-            registered_face_image = cv::imread(absolute_path);
-            std::cout << "尝试读取注册人脸图像从: " << absolute_path 
-                      << (registered_face_image.empty() ? " [失败]" : " [成功]") << std::endl;
-                      
-            // 如果读取失败，尝试其他可能的路径
-            if (registered_face_image.empty()) {
-                std::string alt_path = "face_auth_data/faces/" + username + "_register.jpg";
-                std::cout << "尝试备用路径: " << alt_path << std::endl;
-                registered_face_image = cv::imread(alt_path);
-                
-                if (!registered_face_image.empty()) {
-                    std::cout << "从备用路径成功读取图像" << std::endl;
-                }
-            }
-        }
-        
-        if (registered_face_image.empty()) {
-            response["success"] = false;
-            response["message"] = "用户没有有效的注册人脸数据";
-            db_manager_.logAuthentication(user.id, false, "没有注册人脸数据");
-            return response;
-        }
-        
-        std::cout << "成功读取注册人脸图像，尺寸: " 
-                  << registered_face_image.cols << "x" << registered_face_image.rows << std::endl;
+        // 读取注册人脸（I/O线程池）与登录图像人脸检测同时进行
+        std::future<cv::Mat> registered = lookup_stage_.submit([this, user]() { return readRegisteredFace(user); });
 
-        std::vector<cv::Rect> registered_faces = face_detector_.detectFaces(registered_face_image);
-        std::cout << "注册图像中检测到 " << registered_faces.size() << " 个人脸" << std::endl;
-        
-        if (registered_faces.empty()) {
+        // 检测人脸，提取登录图像中最大的人脸区域
+        cv::Rect login_face;
+        if (!detectLargestFace(login_face_image, login_face)) {
+            static Counter& rejects = rejectCounter("no_face");
+            rejects.increment();
             response["success"] = false;
-            response["message"] = "注册图像中未检测到人脸";
-            db_manager_.logAuthentication(user.id, false, "无效注册人脸数据");
+            response["message"] = "登录图像中未检测到人脸";
+            logAuthEvent(user.id, false, "未检测到人脸");
             return response;
         }
 
-        // 提取最大的人脸区域
-        cv::Rect login_face = *std::max_element(login_faces.begin(), login_faces.end(), 
-            [](const cv::Rect& a, const cv::Rect& b) { return a.area() < b.area(); });
-        
-        cv::Rect registered_face = *std::max_element(registered_faces.begin(), registered_faces.end(), 
-            [](const cv::Rect& a, const cv::Rect& b) { return a.area() < b.area(); });
-
-        // 提取人脸区域
+        // 预处理登录人脸，同时等待注册人脸
         cv::Mat login_face_roi = login_face_image(login_face);
-        cv::Mat registered_face_roi = registered_face_image(registered_face);
+        std::future<cv::Mat> login_preprocessed = preprocess_stage_.submit(
+            [this, login_face_roi]() { return face_recognizer_.preprocessFace(login_face_roi); });
 
-        // 预处理人脸图像
-        cv::Mat login_processed = face_recognizer_.preprocessFace(login_face_roi);
-        cv::Mat registered_processed = face_recognizer_.preprocessFace(registered_face_roi);
-        
-        // 先检查是否需要训练模型
-        bool model_trained = false;
-        try {
-            // 尝试读取用户的训练数据
-            std::pair<int, double> result = face_recognizer_.recognize(login_processed);
-            model_trained = (result.first != -1);
-        } catch (const std::exception& e) {
-            std::cout << "识别模型可能未训练: " << e.what() << std::endl;
-        }
-        
-        // 如果模型未训练，则为该用户训练模型
-        if (!model_trained) {
-            std::cout << "为用户 " << user.id << " 训练人脸识别模型" << std::endl;
-            face_recognizer_.train(user.id, registered_processed);
+        cv::Mat registered_processed = registered.get();
+        if (!prepareRegisteredFace(user, registered_processed, response)) {
+            return response;
         }
+        cv::Mat login_processed = login_preprocessed.get();
         
         // 比较人脸图像（使用LBPHFaceRecognizer）
-        double confidence = face_recognizer_.compareFaces(registered_processed, login_processed);
+        int user_id = user.id;
+        double confidence = match_stage_.submit([this, registered_processed, login_processed]() {
+            return face_recognizer_.compareFaces(registered_processed, login_processed);
+        }).get();
         
-        // 置信度阈值（OpenCV LBPH置信度越低越相似，与MSE相反）
-        const double face_similarity_threshold = 70.0;
-        bool face_verified = confidence < face_similarity_threshold;
+        bool face_verified = confidence < FACE_SIMILARITY_THRESHOLD;
 
-        std::cout << "人脸相似度: " << confidence << ", 阈值: " << face_similarity_threshold << std::endl;
-        std::cout << "人脸验证 " << (face_verified ? "通过" : "失败") << std::endl;
+        LOG_DEBUG(LogSubsystem::AUTH, "人脸相似度: " << confidence << ", 阈值: " << FACE_SIMILARITY_THRESHOLD);
+        LOG_DEBUG(LogSubsystem::AUTH, "人脸验证 " << (face_verified ? "通过" : "失败"));
 
-        // 记录人脸验证尝试
-        db_manager_.storeFaceData(user.id, face_data, "login");
+        // 记录人脸验证尝试（写入器异步批量写入）
+        auth_writer_.recordLogin(user_id);
         
         if (!face_verified) {
+            static Counter& rejects = rejectCounter("face_mismatch");
+            rejects.increment();
             response["success"] = false;
             response["message"] = "人脸验证失败";
             response["face_verified"] = false;
-            db_manager_.logAuthentication(user.id, false, "人脸验证失败, 置信度=" + std::to_string(confidence));
+            logAuthEvent(user.id, false, "人脸验证失败, 置信度=" + std::to_string(confidence));
             return response;
         }
 
         // 更新最后登录时间
-        db_manager_.updateLastLogin(user.id);
+        auth_writer_.updateLastLogin(user_id);
 
         // 认证成功
         response["success"] = true;
         response["message"] = "认证成功";
         response["face_verified"] = true;
-        db_manager_.logAuthentication(user.id, true, "认证成功");
+        attachToken(user_id, response);
+        logAuthEvent(user.id, true, "认证成功");
         
         return response;
     } catch (const std::exception& e) {
-        std::cerr << "认证错误: " << e.what() << std::endl;
+        LOG_ERROR(LogSubsystem::AUTH, "认证错误: " << e.what());
         response["success"] = false;
         response["message"] = std::string("认证错误: ") + e.what();
         return response;
     }
 }
 
+std::shared_ptr<AuthSession> AuthServer::startSession(const std::string& username, const std::string& password,
+                                                     Json::Value& response) {
+    response["type"] = "login_session";
+    if (!session_config_.enabled) {
+        response["success"] = false;
+        response["message"] = "多帧登录未启用";
+        return nullptr;
+    }
+    if (username.empty() || password.empty()) {
+        response["success"] = false;
+        response["message"] = "用户名或密码不能为空";
+        return nullptr;
+    }
+
+    try {
+        UserInfo user;
+        if (!user_cache_.get(username, user)) {
+            user = async_storage_.getUserByUsername(username).get();
+            user_cache_.fill(user);
+        }
+        if (!verifyCredentials(user, password, response)) {
+            return nullptr;
+        }
+
+        // 注册人脸在会话开始时准备一次，之后各帧只做登录侧的解码、检测与比较
+        cv::Mat registered = lookup_stage_.submit([this, user]() { return readRegisteredFace(user); }).get();
+        if (!prepareRegisteredFace(user, registered, response)) {
+            return nullptr;
+        }
+
+        std::shared_ptr<AuthSession> session =
+            std::make_shared<AuthSession>(session_config_, user.id, FACE_SIMILARITY_THRESHOLD, registered);
+        if (session->notifyFd() < 0) {
+            response["success"] = false;
+            response["message"] = "无法创建会话";
+            return nullptr;
+        }
+        LOG_DEBUG(LogSubsystem::AUTH, "用户 " << username << " 开始多帧登录会话");
+        return session;
+    } catch (const std::exception& e) {
+        LOG_ERROR(LogSubsystem::AUTH, "会话错误: " << e.what());
+        response["success"] = false;
+        response["message"] = std::string("认证错误: ") + e.what();
+        return nullptr;
+    }
+}
+
+bool AuthServer::scoreSessionFrame(const std::shared_ptr<AuthSession>& session, const std::string& face_data) {
+    if (!session->tryStartFrame()) {
+        return false;
+    }
+
+    // 整帧作为一个任务投递到CPU线程池，连接线程同时接收下一帧；
+    // 工作线程不能再向有界的同一线程池投递（队列满时会阻塞全部工作线程），各步骤在本线程上依次执行
+    std::shared_ptr<std::string> data = std::make_shared<std::string>(face_data);
+    cpu_executor_.post([this, session, data]() {
+        try {
+            runSessionFrame(*session, *data);
+        } catch (const std::exception& e) {
+            LOG_WARN(LogSubsystem::AUTH, "会话帧评分错误: " << e.what());
+            session->frameFailed();
+        }
+    });
+    return true;
+}
+
+void AuthServer::runSessionFrame(AuthSession& session, const std::string& face_data) {
+    // 每个步骤开始前检查，会话已判定时放弃该帧剩余的步骤
+    auto abandoned = [&session]() {
+        if (session.isDecided()) {
+            session.frameCancelled();
+            return true;
+        }
+        return false;
+    };
+
+    if (abandoned()) {
+        return;
+    }
+    cv::Mat image = decode_stage_.run([this, &face_data]() { return decodeImage(face_data); });
+    if (image.empty()) {
+        session.frameFailed();
+        return;
+    }
+    if (abandoned()) {
+        return;
+    }
+    QualityResult quality = quality_stage_.run([this, &image]() { return checkQuality(image); });
+    if (quality != QualityResult::OK) {
+        static EnumMetricCache<Counter, QualityResult, QUALITY_RESULT_COUNT> rejects([](QualityResult result) -> Counter& {
+            return rejectCounter(std::string("session_") + qualityReason(result));
+        });
+        rejects[quality].increment();
+        session.frameFailed();
+        return;
+    }
+    if (abandoned()) {
+        return;
+    }
+    std::vector<cv::Rect> faces = detect_stage_.run([this, &image]() { return face_detector_.detectFaces(image); });
+    if (faces.empty()) {
+        session.frameFailed();
+        return;
+    }
+    if (abandoned()) {
+        return;
+    }
+    cv::Mat roi = image(largestFace(faces));
+    cv::Mat processed = preprocess_stage_.run([this, &roi]() { return face_recognizer_.preprocessFace(roi); });
+    if (abandoned()) {
+        return;
+    }
+    session.addScore(match_stage_.run([this, &session, &processed]() {
+        return face_recognizer_.compareFaces(session.registeredFace(), processed);
+    }));
+}
+
+Json::Value AuthServer::finishSession(const std::shared_ptr<AuthSession>& session) {
+    Json::Value summary = session->summary();
+    SessionDecision decision = session->decision();
+    int user_id = session->userId();
+    uint64_t scored = summary["frames_scored"].asUInt64();
+
+    static LatencyHistogram& frames_scored = MetricsRegistry::instance().histogram("face_auth_session_frames_scored");
+    static Counter& frames_cancelled = MetricsRegistry::instance().counter("face_auth_session_frames_cancelled_total");
+    static Counter& accepted = MetricsRegistry::instance().counter("face_auth_sessions_total", "result", "accepted");
+    static Counter& rejected = MetricsRegistry::instance().counter("face_auth_sessions_total", "result", "rejected");
+    static Counter& cancelled = MetricsRegistry::instance().counter("face_auth_sessions_total", "result", "cancelled");
+    frames_scored.record(scored);
+    frames_cancelled.increment(summary["frames_cancelled"].asUInt64());
+
+    Json::Value response;
+    response["type"] = "login_session";
+    response["frames"] = summary["frames_scored"];
+    std::string details = "帧数=" + std::to_string(scored) + ", 证据=" + std::to_string(summary["evidence"].asDouble());
+
+    if (decision == SessionDecision::ACCEPTED) {
+        accepted.increment();
+        auth_writer_.recordLogin(user_id);
+        auth_writer_.updateLastLogin(user_id);
+        response["success"] = true;
+        response["message"] = "认证成功";
+        response["face_verified"] = true;
+        attachToken(user_id, response);
+        logAuthEvent(user_id, true, "多帧认证成功, " + details);
+    } else if (decision == SessionDecision::REJECTED) {
+        rejected.increment();
+        if (summary["timed_out"].asBool()) {
+            // 超时时评分中的帧被放弃，scored为0不代表图像中没有人脸
+            if (scored > 0) {
+                auth_writer_.recordLogin(user_id);
+            }
+            static Counter& rejects = rejectCounter("session_timeout");
+            rejects.increment();
+            response["message"] = "认证会话超时";
+            details += ", 超时";
+        } else if (scored > 0) {
+            auth_writer_.recordLogin(user_id);
+            static Counter& rejects = rejectCounter("face_mismatch");
+            rejects.increment();
+            response["message"] = "人脸验证失败";
+        } else {
+            static Counter& rejects = rejectCounter("no_face");
+            rejects.increment();
+            response["message"] = "登录图像中未检测到人脸";
+        }
+        response["success"] = false;
+        response["face_verified"] = false;
+        logAuthEvent(user_id, false, "多帧认证失败, " + details);
+    } else {
+        cancelled.increment();
+        response["success"] = false;
+        response["message"] = "会话已取消";
+    }
+
+    LOG_DEBUG(LogSubsystem::AUTH, "多帧登录会话结束, 用户ID: " << user_id << ", " << details);
+    return response;
+}
+
+Json::Value AuthServer::verifyToken(const std::string& token) {
+    Json::Value response;
+    response["type"] = "token_auth";
+    if (!token_manager_.isEnabled()) {
+        response["success"] = false;
+        response["message"] = "令牌认证未启用";
+        return response;
+    }
+
+    TokenClaims claims;
+    TokenStatus status = token_manager_.verify(token, claims);
+    if (status != TokenStatus::VALID) {
+        static EnumMetricCache<Counter, TokenStatus, TOKEN_STATUS_COUNT> rejects([](TokenStatus reason) -> Counter& {
+            return rejectCounter(std::string("token_") + TokenManager::statusName(reason));
+        });
+        rejects[status].increment();
+        response["success"] = false;
+        response["message"] = status == TokenStatus::EXPIRED ? "令牌已过期" :
+                              status == TokenStatus::REVOKED ? "令牌已吊销" : "无效令牌";
+        return response;
+    }
+    response["success"] = true;
+    response["message"] = "令牌有效";
+    response["user_id"] = claims.user_id;
+    response["token_expires"] = static_cast<Json::Int64>(claims.expires);
+    return response;
+}
+
+Json::Value AuthServer::revokeToken(const std::string& token) {
+    Json::Value response;
+    response["type"] = "token_revoke";
+    if (!token_manager_.isEnabled()) {
+        response["success"] = false;
+        response["message"] = "令牌认证未启用";
+        return response;
+    }
+    if (!token_manager_.revoke(token)) {
+        response["success"] = false;
+        response["message"] = "无法吊销令牌（无效、已过期或吊销列表已满）";
+        return response;
+    }
+    response["success"] = true;
+    response["message"] = "令牌已吊销";
+    return response;
+}
+
+void AuthServer::attachToken(int user_id, Json::Value& response) {
+    if (!token_manager_.isEnabled()) {
+        return;
+    }
+    int64_t expires = 0;
+    std::string token = token_manager_.issue(user_id, &expires);
+    if (token.empty()) {
+        LOG_WARN(LogSubsystem::AUTH, "无法签发令牌，用户ID: " << user_id);
+        return;
+    }
+    response["token"] = token;
+    response["token_expires"] = static_cast<Json::Int64>(expires);
+}
+
+bool AuthServer::verifyCredentials(const UserInfo& user, const std::string& password, Json::Value& response) {
+    LOG_DEBUG(LogSubsystem::AUTH, "查询到的用户ID: " << user.id << ", 用户名: " << user.username);
+    
+    if (user.id == 0) {
+        static Counter& rejects = rejectCounter("user_not_found");
+        rejects.increment();
+        response["success"] = false;
+        response["message"] = "用户未找到";
+        return false;
+    }
+    
+    LOG_DEBUG(LogSubsystem::AUTH, "用户的人脸文件路径: " << user.file_path);
+
+    // 验证密码 - 密码哈希已随用户信息一起查询返回（不写入日志）
+    if (utils::sha256(password) != user.password_hash) {
+        static Counter& rejects = rejectCounter("bad_password");
+        rejects.increment();
+        response["success"] = false;
+        response["message"] = "无效密码";
+        logAuthEvent(user.id, false, "密码验证失败");
+        return false;
+    }
+    return true;
+}
+
+bool AuthServer::prepareRegisteredFace(const UserInfo& user, cv::Mat& registered, Json::Value& response) {
+    if (registered.empty()) {
+        static Counter& rejects = rejectCounter("no_enrollment");
+        rejects.increment();
+        response["success"] = false;
+        response["message"] = "用户没有有效的注册人脸数据";
+        logAuthEvent(user.id, false, "没有注册人脸数据");
+        return false;
+    }
+
+    if (!isNormalizedFacePath(user.file_path)) {
+        // 旧数据或保留原图的注册：对原始图像重新检测并预处理
+        cv::Mat registered_face_image = registered;
+        LOG_DEBUG(LogSubsystem::AUTH, "成功读取注册人脸图像，尺寸: " 
+                  << registered_face_image.cols << "x" << registered_face_image.rows);
+
+        cv::Rect registered_face;
+        if (!detectLargestFace(registered_face_image, registered_face)) {
+            static Counter& rejects = rejectCounter("invalid_enrollment");
+            rejects.increment();
+            response["success"] = false;
+            response["message"] = "注册图像中未检测到人脸";
+            logAuthEvent(user.id, false, "无效注册人脸数据");
+            return false;
+        }
+
+        cv::Mat registered_roi = registered_face_image(registered_face);
+        registered = preprocess_stage_.submit(
+            [this, registered_roi]() { return face_recognizer_.preprocessFace(registered_roi); }).get();
+    }
+
+    // 用户不在识别模型中（如旧数据）时交给后台训练器，比较不依赖训练结果
+    if (enrollment_trainer_.status(user.id) == EnrollmentStatus::UNKNOWN) {
+        LOG_DEBUG(LogSubsystem::AUTH, "为用户 " << user.id << " 训练人脸识别模型");
+        enrollment_trainer_.enqueue(user.id, registered);
+    }
+    return true;
+}
+
 Json::Value AuthServer::updateUserFace(int user_id, const std::string& face_data) {
     Json::Value response;
     response["type"] = "update_face";
@@ -449,40 +1120,58 @@ Json::Value AuthServer::updateUserFace(int user_id, const std::string& face_data
     }
 
     try {
-        // 解码人脸数据
-        cv::Mat face_image = decodeImage(face_data);
+        // 解码人脸数据并检查质量
+        QualityResult quality = QualityResult::OK;
+        cv::Mat face_image = decode_stage_.submit(
+            [this, &face_data, &quality]() { return decodeChecked(face_data, quality); }).get();
         if (face_image.empty()) {
             response["success"] = false;
             response["message"] = "无效人脸图像数据";
             return response;
         }
 
-        // 检测人脸
-        std::vector<cv::Rect> faces = face_detector_.detectFaces(face_image);
-        if (faces.empty()) {
+        if (quality != QualityResult::OK) {
+            static EnumMetricCache<Counter, QualityResult, QUALITY_RESULT_COUNT> rejects([](QualityResult result) -> Counter& {
+                return rejectCounter(std::string("update_") + qualityReason(result));
+            });
+            rejects[quality].increment();
+            response["success"] = false;
+            response["message"] = qualityMessage(quality);
+            response["quality"] = qualityReason(quality);
+            return response;
+        }
+
+        // 检测人脸，提取最大的人脸区域
+        cv::Rect face;
+        if (!detectLargestFace(face_image, face)) {
             response["success"] = false;
             response["message"] = "图像中未检测到人脸";
             return response;
         }
+        cv::Mat face_roi = face_image(face);
 
         // 更新数据库
-        if (!db_manager_.updateUserFace(user_id, face_data)) {
+        std::vector<FaceImage> enrollment_faces = preprocess_stage_.submit(
+            [this, &face_data, &face_roi]() { return buildEnrollmentFaces(face_data, face_roi); }).get();
+        if (!async_storage_.updateUserFace(user_id, std::move(enrollment_faces)).get()) {
             response["success"] = false;
             response["message"] = "无法更新人脸数据";
             return response;
         }
 
-        // 提取最大的人脸区域并训练模型
-        cv::Rect face = *std::max_element(faces.begin(), faces.end(), 
-            [](const cv::Rect& a, const cv::Rect& b) { return a.area() < b.area(); });
-        cv::Mat face_roi = face_image(face);
-        
-        // 训练人脸识别模型
-        face_recognizer_.train(user_id, face_roi);
-        std::cout << "更新人脸识别模型，用户ID: " << user_id << std::endl;
+        // 写穿透：用最新的注册人脸刷新用户目录缓存
+        UserInfo user = async_storage_.getUserById(user_id).get();
+        if (user.id > 0) {
+            user_cache_.put(user);
+        }
+
+        // 后台训练器批量更新识别模型
+        enrollment_trainer_.enqueue(user_id, face_roi.clone());
+        LOG_DEBUG(LogSubsystem::AUTH, "更新的人脸已加入训练队列，用户ID: " << user_id);
 
         response["success"] = true;
         response["message"] = "人脸数据更新成功";
+        response["enrollment_status"] = EnrollmentTrainer::statusName(enrollment_trainer_.status(user_id));
         return response;
     } catch (const std::exception& e) {
         response["success"] = false;
@@ -491,35 +1180,240 @@ Json::Value AuthServer::updateUserFace(int user_id, const std::string& face_data
     }
 }
 
-cv::Mat AuthServer::decodeImage(const std::string& face_data) {
+Json::Value AuthServer::enrollmentStatus(const std::string& username, const std::string& password) {
+    Json::Value response;
+    response["type"] = "enrollment_status";
+
+    if (username.empty() || password.empty()) {
+        response["success"] = false;
+        response["message"] = "用户名或密码不能为空";
+        return response;
+    }
+
     try {
-        // 首先保存图像到临时文件
-        std::string temp_file = "face_auth_data/temp/temp_decode.jpg";
-        std::ofstream file(temp_file, std::ios::binary);
-        if (!file.is_open()) {
-            std::cerr << "无法创建临时文件用于图像解码" << std::endl;
-            return cv::Mat();
+        UserInfo user;
+        if (!user_cache_.get(username, user)) {
+            user = async_storage_.getUserByUsername(username).get();
+            user_cache_.fill(user);
+        }
+        if (user.id == 0) {
+            response["success"] = false;
+            response["message"] = "用户未找到";
+            return response;
+        }
+        if (utils::sha256(password) != user.password_hash) {
+            response["success"] = false;
+            response["message"] = "无效密码";
+            return response;
+        }
+
+        EnrollmentStatus status = enrollment_trainer_.status(user.id);
+        response["success"] = true;
+        response["status"] = EnrollmentTrainer::statusName(status);
+        switch (status) {
+        case EnrollmentStatus::LIVE:
+            response["message"] = "人脸已加入识别模型";
+            break;
+        case EnrollmentStatus::PENDING:
+            response["message"] = "人脸等待训练";
+            break;
+        case EnrollmentStatus::FAILED:
+            response["message"] = "人脸训练失败";
+            break;
+        default:
+            response["message"] = "人脸不在识别模型中";
+            break;
+        }
+        return response;
+    } catch (const std::exception& e) {
+        response["success"] = false;
+        response["message"] = std::string("查询错误: ") + e.what();
+        return response;
+    }
+}
+
+std::vector<FaceImage> AuthServer::buildEnrollmentFaces(const std::string& face_data, const cv::Mat& face_roi) {
+    std::vector<FaceImage> faces;
+
+    // 原图先保存，标准化人脸最后保存，成为登录时读取的最新注册人脸
+    if (keep_original_face_) {
+        faces.push_back(FaceImage(face_data, false));
+    }
+
+    // 标准化人脸即登录比较时使用的预处理结果，PNG无损保存
+    cv::Mat normalized = face_recognizer_.preprocessFace(face_roi);
+    std::vector<uchar> encoded;
+    if (!normalized.empty() && cv::imencode(".png", normalized, encoded)) {
+        faces.push_back(FaceImage(std::string(encoded.begin(), encoded.end()), true));
+    } else if (!keep_original_face_) {
+        // 无法生成标准化人脸时退回保存原图
+        LOG_WARN(LogSubsystem::AUTH, "无法生成标准化人脸，保存原始图像");
+        faces.push_back(FaceImage(face_data, false));
+    }
+
+    return faces;
+}
+
+cv::Mat AuthServer::readRegisteredFace(const UserInfo& user) {
+    if (isNormalizedFacePath(user.file_path)) {
+        // 注册时已保存标准化人脸，直接读取，无需解码整帧与再次检测
+        return cv::imread(user.file_path, cv::IMREAD_GRAYSCALE);
+    }
+
+    // 旧数据或保留原图的注册：读取原始图像
+    cv::Mat registered_face_image;
+    if (user.file_path != "LOGIN_IMAGE_NOT_SAVED") {
+        // 尝试使用相对路径或绝对路径读取注册人脸
+        std::string absolute_path = user.file_path;
+        // 如果是相对路径，转换为绝对路径
+        if (user.file_path.find("/") != 0) {
+            // 相对于当前工作目录的路径
+            char cwd[1024];
+            if (getcwd(cwd, sizeof(cwd)) != NULL) {
+                absolute_path = std::string(cwd) + "/" + user.file_path;
+                LOG_DEBUG(LogSubsystem::AUTH, "转换为绝对路径: " << absolute_path);
+            }
         }
         
-        // 将图像数据写入临时文件
-        file.write(face_data.c_str(), face_data.size());
-        file.close();
-        
-        // 使用OpenCV读取图像
-        cv::Mat image = cv::imread(temp_file);
+        // 从文件中读取注册人脸
+        registered_face_image = cv::imread(absolute_path);
+        LOG_DEBUG(LogSubsystem::AUTH, "尝试读取注册人脸图像从: " << absolute_path 
+                  << (registered_face_image.empty() ? " [失败]" : " [成功]"));
+                  
+        // 如果读取失败，尝试其他可能的路径
+        if (registered_face_image.empty()) {
+            std::string alt_path = "face_auth_data/faces/" + user.username + "_register.jpg";
+            LOG_DEBUG(LogSubsystem::AUTH, "尝试备用路径: " << alt_path);
+            registered_face_image = cv::imread(alt_path);
+            
+            if (!registered_face_image.empty()) {
+                LOG_DEBUG(LogSubsystem::AUTH, "从备用路径成功读取图像");
+            }
+        }
+    }
+    return registered_face_image;
+}
+
+bool AuthServer::detectLargestFace(const cv::Mat& image, cv::Rect& face) {
+    std::vector<cv::Rect> faces = detect_stage_.submit(
+        [this, &image]() { return face_detector_.detectFaces(image); }).get();
+    LOG_DEBUG(LogSubsystem::AUTH, "检测到 " << faces.size() << " 个人脸");
+    if (faces.empty()) {
+        return false;
+    }
+    face = largestFace(faces);
+    return true;
+}
+
+void AuthServer::logAuthEvent(int user_id, bool success, const std::string& details) {
+    auth_writer_.logAuthentication(user_id, success, details);
+}
+
+std::vector<StageStats> AuthServer::getStageStats() const {
+    std::vector<StageStats> stats;
+    stats.push_back(parse_stage_.getStats());
+    stats.push_back(lookup_stage_.getStats());
+    stats.push_back(decode_stage_.getStats());
+    stats.push_back(quality_stage_.getStats());
+    stats.push_back(detect_stage_.getStats());
+    stats.push_back(preprocess_stage_.getStats());
+    stats.push_back(match_stage_.getStats());
+    stats.push_back(persist_stage_.getStats());
+    return stats;
+}
+
+std::string AuthServer::dumpFrames(const std::string& dir) {
+    std::string target = dir;
+    if (target.empty()) {
+        target = "face_auth_data/temp/frames-" + std::to_string(static_cast<long long>(std::time(nullptr)));
+    }
+    int count = frame_ring_.dump(target);
+    if (count < 0) {
+        return "导出失败: " + target + "\n";
+    }
+    LOG_INFO(LogSubsystem::SERVER, "已导出 " << count << " 个最近请求帧到 " << target);
+    return "已导出 " + std::to_string(count) + " 个请求帧到 " + target + "\n";
+}
+
+Json::Value AuthServer::getStats() const {
+    return MetricsRegistry::instance().toJson(collectGauges());
+}
+
+std::string AuthServer::getPrometheusMetrics() const {
+    return MetricsRegistry::instance().toPrometheus(collectGauges());
+}
+
+std::vector<GaugeSample> AuthServer::collectGauges() const {
+    std::vector<GaugeSample> gauges;
+    for (const StageStats& stage : getStageStats()) {
+        gauges.push_back(GaugeSample("face_auth_stage_queue_depth", "stage", stage.name,
+                                     static_cast<double>(stage.queue_depth)));
+    }
+
+    const Executor* executors[] = {&cpu_executor_, &io_executor_};
+    for (const Executor* executor : executors) {
+        ExecutorStats stats = executor->getStats();
+        gauges.push_back(GaugeSample("face_auth_executor_queue_depth", "executor", executor->name(),
+                                     static_cast<double>(stats.queue_depth)));
+        gauges.push_back(GaugeSample("face_auth_executor_active", "executor", executor->name(),
+                                     static_cast<double>(stats.active)));
+    }
+
+    AuthWriterStats writer = auth_writer_.getStats();
+    size_t settled = writer.written + writer.dead_letters;
+    gauges.push_back(GaugeSample("face_auth_writer_backlog", "", "",
+                                 static_cast<double>(writer.enqueued > settled ? writer.enqueued - settled : 0)));
+    gauges.push_back(GaugeSample("face_auth_wal_pending_segments", "", "", static_cast<double>(writer.wal_pending)));
+    gauges.push_back(GaugeSample("face_auth_enrollment_pending", "", "",
+                                 static_cast<double>(enrollment_trainer_.getStats().pending)));
+    gauges.push_back(GaugeSample("face_auth_user_cache_size", "", "",
+                                 static_cast<double>(user_cache_.getStats().size)));
+    gauges.push_back(GaugeSample("face_auth_revoked_tokens", "", "",
+                                 static_cast<double>(token_manager_.revokedCount())));
+    gauges.push_back(GaugeSample("face_auth_log_dropped", "", "",
+                                 static_cast<double>(Logger::instance().getStats().dropped)));
+    return gauges;
+}
+
+QualityResult AuthServer::checkQuality(const cv::Mat& image) {
+    if (!quality_config_.enabled) {
+        return QualityResult::OK;
+    }
+    QualityMetrics metrics;
+    QualityResult result = checkImageQuality(image, quality_config_, &metrics);
+    // 拒绝数由调用方在凭据校验通过后计入face_auth_rejects_total，这里不计数
+    if (result != QualityResult::OK) {
+        LOG_DEBUG(LogSubsystem::AUTH, "图像质量不合格: " << qualityReason(result) << ", 尺寸: " << image.cols << "x"
+                  << image.rows << ", 亮度: " << metrics.brightness << ", 清晰度: " << metrics.sharpness);
+    }
+    return result;
+}
+
+cv::Mat AuthServer::decodeChecked(const std::string& face_data, QualityResult& quality) {
+    cv::Mat image = decodeImage(face_data);
+    quality = QualityResult::OK;
+    if (!image.empty()) {
+        quality = quality_stage_.run([this, &image]() { return checkQuality(image); });
+    }
+    return image;
+}
+
+cv::Mat AuthServer::decodeImage(const std::string& face_data) {
+    try {
+        // 直接从请求缓冲区解码，不经过临时文件；输出缓冲区由Mat内存池提供
+        cv::Mat raw(1, static_cast<int>(face_data.size()), CV_8UC1,
+                    const_cast<char*>(face_data.data()));
+        cv::Mat image = cv::imdecode(raw, cv::IMREAD_COLOR);
         
-        // 检查图像是否成功读取
+        // 检查图像是否成功解码
         if (image.empty()) {
-            std::cerr << "无法从数据解码图像" << std::endl;
+            LOG_WARN(LogSubsystem::AUTH, "无法从数据解码图像");
             return cv::Mat();
         }
         
-        // 可选：删除临时文件
-        std::remove(temp_file.c_str());
-        
         return image;
     } catch (const std::exception& e) {
-        std::cerr << "解码图像错误: " << e.what() << std::endl;
+        LOG_WARN(LogSubsystem::AUTH, "解码图像错误: " << e.what());
         return cv::Mat();
     }
 }
@@ -0,0 +1,131 @@
+#include "auth_session.h"
+#include "logger.h"
+#include <algorithm>
+#include <cstdint>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+AuthSession::AuthSession(const SessionConfig& config, int user_id, double threshold, const cv::Mat& registered_face)
+    : config_(config), user_id_(user_id), threshold_(threshold), registered_face_(registered_face),
+      notify_fd_(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)),
+      decision_(SessionDecision::PENDING), decided_(false), end_of_stream_(false), timed_out_(false),
+      submitted_(0), in_flight_(0), scored_(0), failed_(0), cancelled_(0), skipped_(0),
+      evidence_(0.0), best_distance_(-1.0) {
+    if (config_.margin <= 0) {
+        config_.margin = 1.0;
+    }
+    if (notify_fd_ < 0) {
+        LOG_WARN(LogSubsystem::AUTH, "无法创建会话通知描述符");
+    }
+}
+
+AuthSession::~AuthSession() {
+    if (notify_fd_ >= 0) {
+        close(notify_fd_);
+    }
+}
+
+bool AuthSession::tryStartFrame() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (decision_ != SessionDecision::PENDING || end_of_stream_ || submitted_ >= config_.max_frames) {
+        return false;
+    }
+    if (in_flight_ >= config_.max_in_flight) {
+        skipped_++;
+        return false;
+    }
+    submitted_++;
+    in_flight_++;
+    return true;
+}
+
+void AuthSession::addScore(double distance) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    in_flight_--;
+    scored_++;
+    if (best_distance_ < 0 || distance < best_distance_) {
+        best_distance_ = distance;
+    }
+    // LBPH距离越小越相似，低于阈值为正证据
+    double evidence = (threshold_ - distance) / config_.margin;
+    evidence_ += std::max(-1.0, std::min(1.0, evidence));
+    decideLocked();
+}
+
+void AuthSession::frameFailed() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    in_flight_--;
+    failed_++;
+    decideLocked();
+}
+
+void AuthSession::frameCancelled() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    in_flight_--;
+    cancelled_++;
+}
+
+void AuthSession::endOfStream() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    end_of_stream_ = true;
+    decideLocked();
+}
+
+void AuthSession::expire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    end_of_stream_ = true;
+    if (decision_ == SessionDecision::PENDING) {
+        timed_out_ = true;
+        setDecisionLocked(evidence_ > 0 ? SessionDecision::ACCEPTED : SessionDecision::REJECTED);
+    }
+}
+
+void AuthSession::cancel() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (decision_ == SessionDecision::PENDING) {
+        setDecisionLocked(SessionDecision::CANCELLED);
+    }
+}
+
+SessionDecision AuthSession::decision() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return decision_;
+}
+
+Json::Value AuthSession::summary() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Json::Value summary;
+    summary["frames_submitted"] = static_cast<Json::UInt64>(submitted_);
+    summary["frames_scored"] = static_cast<Json::UInt64>(scored_);
+    summary["frames_failed"] = static_cast<Json::UInt64>(failed_);
+    summary["frames_cancelled"] = static_cast<Json::UInt64>(cancelled_);
+    summary["frames_skipped"] = static_cast<Json::UInt64>(skipped_);
+    summary["timed_out"] = timed_out_;
+    summary["evidence"] = evidence_;
+    summary["best_distance"] = best_distance_;
+    return summary;
+}
+
+void AuthSession::decideLocked() {
+    if (decision_ != SessionDecision::PENDING) {
+        return;
+    }
+    if (evidence_ >= config_.accept_bound) {
+        setDecisionLocked(SessionDecision::ACCEPTED);
+    } else if (evidence_ <= -config_.reject_bound) {
+        setDecisionLocked(SessionDecision::REJECTED);
+    } else if (in_flight_ == 0 && (end_of_stream_ || submitted_ >= config_.max_frames)) {
+        // 没有更多的帧：累计证据为正时通过，单帧时即距离低于阈值
+        setDecisionLocked(evidence_ > 0 ? SessionDecision::ACCEPTED : SessionDecision::REJECTED);
+    }
+}
+
+void AuthSession::setDecisionLocked(SessionDecision decision) {
+    decision_ = decision;
+    decided_.store(true, std::memory_order_release);
+    if (notify_fd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t ignored = write(notify_fd_, &one, sizeof(one));
+        (void)ignored;
+    }
+}
@@ -0,0 +1,256 @@
+#include "blob_store.h"
+#include "logger.h"
+#include "utils.h"
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace {
+
+bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool fileExists(const std::string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0;
+}
+
+bool syncDirectory(const std::string& dir) {
+    int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    bool ok = fd >= 0 && ::fsync(fd) == 0;
+    if (!ok) {
+        LOG_ERROR(LogSubsystem::STORAGE, "同步目录失败 " << dir << ": " << strerror(errno));
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    return ok;
+}
+
+std::string parentDirectory(const std::string& path) {
+    size_t pos = path.rfind('/');
+    return pos == std::string::npos ? "." : path.substr(0, pos);
+}
+
+} // namespace
+
+BlobStore& BlobStore::instance() {
+    static BlobStore store;
+    return store;
+}
+
+BlobStore::BlobStore()
+    : leader_active_(false), writing_(0), temp_counter_(0), writes_(0), dedup_hits_(0), bytes_(0), sync_batches_(0) {
+}
+
+void BlobStore::configure(const BlobStoreConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = config;
+    known_dirs_.clear();
+    LOG_INFO(LogSubsystem::STORAGE, "人脸图像存储: " << config_.root << ", fsync: " << (config_.fsync ? "开启" : "关闭")
+              << ", 组提交窗口: " << config_.group_commit_us << "us");
+}
+
+std::string BlobStore::put(const std::string& data, const std::string& extension) {
+    std::string hash = utils::sha256(data);
+    std::string root;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        root = config_.root;
+    }
+
+    std::string dir = root + "/" + hash.substr(0, 2) + "/" + hash.substr(2, 2);
+    std::string final_path = dir + "/" + hash + extension;
+
+    // 内容相同的文件已存在，直接复用
+    if (fileExists(final_path)) {
+        dedup_hits_++;
+        return final_path;
+    }
+
+    if (!ensureDirectory(dir)) {
+        return "";
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        writing_++;
+    }
+
+    // 临时文件名包含进程与计数器，避免并发写入相同内容时互相覆盖
+    PendingWrite write;
+    write.temp_path = final_path + ".tmp." + std::to_string(getpid()) + "." + std::to_string(temp_counter_++);
+    write.final_path = final_path;
+    write.dir = dir;
+    write.ok = false;
+    write.done = false;
+    write.fd = ::open(write.temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (write.fd < 0) {
+        LOG_ERROR(LogSubsystem::STORAGE, "无法创建临时文件 " << write.temp_path << ": " << strerror(errno));
+        abandonWrite();
+        return "";
+    }
+
+    if (!writeAll(write.fd, data.data(), data.size())) {
+        LOG_ERROR(LogSubsystem::STORAGE, "写入图像失败 " << write.temp_path << ": " << strerror(errno));
+        ::close(write.fd);
+        ::unlink(write.temp_path.c_str());
+        abandonWrite();
+        return "";
+    }
+
+    if (!commit(write)) {
+        return "";
+    }
+
+    writes_++;
+    bytes_ += data.size();
+    return final_path;
+}
+
+BlobStoreStats BlobStore::getStats() const {
+    BlobStoreStats stats;
+    stats.writes = writes_.load();
+    stats.dedup_hits = dedup_hits_.load();
+    stats.bytes = bytes_.load();
+    stats.sync_batches = sync_batches_.load();
+    return stats;
+}
+
+std::string BlobStore::imageExtension(const std::string& data) {
+    if (data.size() >= 8 && memcmp(data.data(), "\x89PNG\r\n\x1a\n", 8) == 0) {
+        return ".png";
+    }
+    if (data.size() >= 3 && memcmp(data.data(), "\xff\xd8\xff", 3) == 0) {
+        return ".jpg";
+    }
+    return ".bin";
+}
+
+bool BlobStore::ensureDirectory(const std::string& dir) {
+    bool fsync;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (known_dirs_.count(dir)) {
+            return true;
+        }
+        fsync = config_.fsync;
+    }
+
+    bool existed = fileExists(dir);
+    if (!existed && !utils::createDirectories(dir)) {
+        LOG_ERROR(LogSubsystem::STORAGE, "无法创建图像目录: " << dir);
+        return false;
+    }
+
+    // 新建的两级目录需要同步其父目录，目录项才会落盘（每个目录只发生一次）
+    if (!existed && fsync) {
+        std::string parent = parentDirectory(dir);
+        syncDirectory(parent);
+        syncDirectory(parentDirectory(parent));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    known_dirs_.insert(dir);
+    return true;
+}
+
+bool BlobStore::commit(PendingWrite& write) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    pending_.push_back(&write);
+    writing_--;
+    arrived_.notify_all();
+
+    // 已有leader时等待其完成本批次（或后续批次）
+    while (!write.done && leader_active_) {
+        committed_.wait(lock);
+    }
+    if (write.done) {
+        return write.ok;
+    }
+
+    // 成为leader：有其他写入正在写临时文件时，最多等待组提交窗口让其加入同一批次；
+    // 没有并发写入时直接提交，单个写入不付出窗口延迟
+    leader_active_ = true;
+    int window_us = config_.fsync ? config_.group_commit_us : 0;
+    if (window_us > 0 && writing_ > 0) {
+        arrived_.wait_for(lock, std::chrono::microseconds(window_us), [this]() { return writing_ == 0; });
+    }
+
+    std::vector<PendingWrite*> batch;
+    batch.swap(pending_);
+    bool fsync = config_.fsync;
+    lock.unlock();
+
+    if (fsync) {
+        syncBatch(batch);
+    } else {
+        for (PendingWrite* item : batch) {
+            ::close(item->fd);
+            item->ok = ::rename(item->temp_path.c_str(), item->final_path.c_str()) == 0;
+            if (!item->ok) {
+                LOG_ERROR(LogSubsystem::STORAGE, "重命名失败 " << item->final_path << ": " << strerror(errno));
+                ::unlink(item->temp_path.c_str());
+            }
+        }
+    }
+
+    lock.lock();
+    for (PendingWrite* item : batch) {
+        item->done = true;
+    }
+    leader_active_ = false;
+    committed_.notify_all();
+    return write.ok;
+}
+
+void BlobStore::abandonWrite() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    writing_--;
+    arrived_.notify_all();
+}
+
+void BlobStore::syncBatch(std::vector<PendingWrite*>& batch) {
+    // 先同步文件数据，再rename，最后同步目录项；每个目录只同步一次
+    std::set<std::string> dirs;
+    for (PendingWrite* item : batch) {
+        item->ok = ::fdatasync(item->fd) == 0;
+        if (!item->ok) {
+            LOG_ERROR(LogSubsystem::STORAGE, "同步文件失败 " << item->temp_path << ": " << strerror(errno));
+        }
+        ::close(item->fd);
+
+        if (item->ok) {
+            item->ok = ::rename(item->temp_path.c_str(), item->final_path.c_str()) == 0;
+            if (!item->ok) {
+                LOG_ERROR(LogSubsystem::STORAGE, "重命名失败 " << item->final_path << ": " << strerror(errno));
+            }
+        }
+        if (item->ok) {
+            dirs.insert(item->dir);
+        } else {
+            ::unlink(item->temp_path.c_str());
+        }
+    }
+
+    for (const std::string& dir : dirs) {
+        syncDirectory(dir);
+    }
+
+    sync_batches_++;
+}
@@ -0,0 +1,401 @@
+#include "capture.h"
+#include "logger.h"
+#include "metrics.h"
+#include "protocol.h"
+#include "utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <arpa/inet.h>
+
+namespace {
+
+const char FILE_MAGIC[4] = {'F', 'C', 'A', 'P'};
+const uint32_t FILE_VERSION = 1;
+const size_t FILE_HEADER_SIZE = 8;
+const size_t RECORD_FIXED_SIZE = 16;   // 时间戳 + 原始人脸数据大小 + JSON长度
+
+// 脱敏后写入的密码与会话令牌
+const char* const REDACTED_PASSWORD = "***";
+
+void putU32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+void putU64(std::string& out, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        out += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+uint32_t getU32(const char* p) {
+    const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+    return static_cast<uint32_t>(u[0]) | (static_cast<uint32_t>(u[1]) << 8) |
+           (static_cast<uint32_t>(u[2]) << 16) | (static_cast<uint32_t>(u[3]) << 24);
+}
+
+uint64_t getU64(const char* p) {
+    return static_cast<uint64_t>(getU32(p)) | (static_cast<uint64_t>(getU32(p + 4)) << 32);
+}
+
+// 帧头后的JSON长度（网络字节序）
+uint32_t frameJsonLength(const char* frame) {
+    uint32_t length = 0;
+    memcpy(&length, frame + 4, 4);
+    return ntohl(length);
+}
+
+// 第n个请求在 floor(n*rate) 增加时被采样，长期比例等于采样率且不需要随机数
+bool sampled(std::atomic<uint64_t>& counter, double rate) {
+    if (rate <= 0.0) {
+        return false;
+    }
+    uint64_t n = counter.fetch_add(1, std::memory_order_relaxed);
+    return rate >= 1.0 || static_cast<uint64_t>((n + 1) * rate) != static_cast<uint64_t>(n * rate);
+}
+
+uint64_t nowMicros() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+std::string fileHeader() {
+    std::string header(FILE_MAGIC, sizeof(FILE_MAGIC));
+    putU32(header, FILE_VERSION);
+    return header;
+}
+
+// 脱敏并编码为一条记录；frame为帧头 + JSON + 保留的人脸数据
+bool encodeRecord(uint64_t timestamp_us, uint32_t face_data_size, const std::string& frame, std::string& record) {
+    size_t json_length = frameJsonLength(frame.data());
+    if (protocol::FRAME_HEADER_SIZE + json_length > frame.size()) {
+        return false;
+    }
+    const char* json_begin = frame.data() + protocol::FRAME_HEADER_SIZE;
+
+    Json::Value request;
+    Json::Reader reader;
+    if (!reader.parse(json_begin, json_begin + json_length, request)) {
+        return false;
+    }
+    if (request.isMember("password")) {
+        request["password"] = REDACTED_PASSWORD;
+    }
+    if (request.isMember("token")) {
+        request["token"] = REDACTED_PASSWORD;
+    }
+    Json::FastWriter writer;
+    std::string json = writer.write(request);
+
+    size_t retained = frame.size() - protocol::FRAME_HEADER_SIZE - json_length;
+    size_t body_size = RECORD_FIXED_SIZE + json.size() + retained;
+    record.reserve(4 + body_size);
+    putU32(record, static_cast<uint32_t>(body_size));
+    putU64(record, timestamp_us);
+    putU32(record, face_data_size);
+    putU32(record, static_cast<uint32_t>(json.size()));
+    record += json;
+    record.append(json_begin + json_length, retained);
+    return true;
+}
+
+std::string parentDirectory(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? std::string() : path.substr(0, slash);
+}
+
+} // namespace
+
+CaptureWriter::CaptureWriter() : file_bytes_(0), running_(false), offered_(0) {
+}
+
+CaptureWriter::~CaptureWriter() {
+    stop();
+}
+
+bool CaptureWriter::start(const CaptureConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+        return true;
+    }
+    config_ = config;
+    if (config_.queue_size == 0) {
+        config_.queue_size = 1;
+    }
+    if (config_.max_files < 1) {
+        config_.max_files = 1;
+    }
+
+    std::string dir = parentDirectory(config_.path);
+    if (!dir.empty() && !utils::createDirectories(dir)) {
+        LOG_ERROR(LogSubsystem::NET, "无法创建抓包目录: " << dir);
+        return false;
+    }
+    if (!openFile()) {
+        return false;
+    }
+
+    running_ = true;
+    thread_ = std::thread(&CaptureWriter::run, this);
+    LOG_INFO(LogSubsystem::NET, "请求抓包已启动: " << config_.path << "，采样率 " << config_.sample_rate);
+    return true;
+}
+
+void CaptureWriter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    not_empty_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    file_.close();
+    LOG_INFO(LogSubsystem::NET, "请求抓包已停止");
+}
+
+void CaptureWriter::offer(const char* frame, size_t size) {
+    if (!running_.load(std::memory_order_relaxed) || size < protocol::FRAME_HEADER_SIZE) {
+        return;
+    }
+
+    if (!sampled(offered_, config_.sample_rate)) {
+        return;
+    }
+
+    size_t json_end = protocol::FRAME_HEADER_SIZE + frameJsonLength(frame);
+    if (json_end > size) {
+        return;
+    }
+    size_t face_size = size - json_end;
+    size_t keep = face_size;
+    if (config_.payload_bytes >= 0 && static_cast<uint64_t>(config_.payload_bytes) < keep) {
+        keep = static_cast<size_t>(config_.payload_bytes);
+    }
+
+    static Counter& captured = MetricsRegistry::instance().counter("face_auth_capture_frames_total");
+    static Counter& dropped = MetricsRegistry::instance().counter("face_auth_capture_dropped_total");
+
+    PendingFrame pending;
+    pending.timestamp_us = nowMicros();
+    pending.face_data_size = static_cast<uint32_t>(face_size);
+    pending.frame.assign(frame, json_end + keep);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queue_.size() >= config_.queue_size) {
+            dropped.increment();
+            return;
+        }
+        queue_.push_back(std::move(pending));
+    }
+    captured.increment();
+    not_empty_.notify_one();
+}
+
+void CaptureWriter::run() {
+    while (true) {
+        PendingFrame pending;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_empty_.wait(lock, [this]() { return !running_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                break;
+            }
+            pending = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        std::string record;
+        if (encodeRecord(pending.timestamp_us, pending.face_data_size, pending.frame, record)) {
+            write(record);
+        }
+    }
+    file_.flush();
+}
+
+bool CaptureWriter::write(const std::string& record) {
+    if (file_bytes_ > FILE_HEADER_SIZE && file_bytes_ + record.size() > config_.max_file_bytes) {
+        rotate();
+    }
+    if (!file_.is_open()) {
+        return false;
+    }
+    file_.write(record.data(), record.size());
+    if (!file_) {
+        LOG_WARN(LogSubsystem::NET, "写入抓包文件失败: " << config_.path);
+        return false;
+    }
+    file_bytes_ += record.size();
+    return true;
+}
+
+bool CaptureWriter::openFile() {
+    // 已有的文件先轮转，重启后不覆盖上次的抓包
+    std::ifstream existing(config_.path.c_str(), std::ios::binary);
+    if (existing.good()) {
+        existing.close();
+        rotate();
+        return file_.is_open();
+    }
+
+    file_.open(config_.path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!file_.is_open()) {
+        LOG_ERROR(LogSubsystem::NET, "无法打开抓包文件: " << config_.path);
+        return false;
+    }
+    std::string header = fileHeader();
+    file_.write(header.data(), header.size());
+    file_bytes_ = header.size();
+    return true;
+}
+
+void CaptureWriter::rotate() {
+    if (file_.is_open()) {
+        file_.close();
+    }
+    // path.(n-2) -> path.(n-1) ... path -> path.1，超出保留数的最旧文件被覆盖
+    for (int i = config_.max_files - 1; i >= 1; --i) {
+        std::string from = i == 1 ? config_.path : config_.path + "." + std::to_string(i - 1);
+        std::string to = config_.path + "." + std::to_string(i);
+        std::rename(from.c_str(), to.c_str());
+    }
+    if (config_.max_files == 1) {
+        std::remove(config_.path.c_str());
+    }
+    file_bytes_ = 0;
+    openFile();
+}
+
+FrameRing::FrameRing() : next_(0), sequence_(0), sample_rate_(0.0), offered_(0) {
+}
+
+void FrameRing::configure(size_t capacity, double sample_rate) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    slots_.assign(capacity, Slot());
+    next_ = 0;
+    sequence_ = 0;
+    sample_rate_ = capacity > 0 ? sample_rate : 0.0;
+}
+
+void FrameRing::offer(const char* frame, size_t size) {
+    if (size < protocol::FRAME_HEADER_SIZE || !sampled(offered_, sample_rate_)) {
+        return;
+    }
+
+    Slot slot;
+    slot.timestamp_us = nowMicros();
+    slot.frame.assign(frame, size);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (slots_.empty()) {
+            return;
+        }
+        slots_[next_].timestamp_us = slot.timestamp_us;
+        slots_[next_].frame.swap(slot.frame);
+        next_ = (next_ + 1) % slots_.size();
+        sequence_++;
+    }
+    // 被替换的旧帧在锁外释放
+}
+
+int FrameRing::dump(const std::string& dir) {
+    std::vector<Slot> frames;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t count = static_cast<size_t>(std::min<uint64_t>(sequence_, slots_.size()));
+        size_t first = (next_ + slots_.size() - count) % std::max<size_t>(slots_.size(), 1);
+        for (size_t i = 0; i < count; ++i) {
+            frames.push_back(slots_[(first + i) % slots_.size()]);
+        }
+    }
+
+    if (!utils::createDirectories(dir)) {
+        return -1;
+    }
+    std::ofstream capture((dir + "/frames.fcap").c_str(), std::ios::binary | std::ios::trunc);
+    if (!capture.is_open()) {
+        return -1;
+    }
+    std::string header = fileHeader();
+    capture.write(header.data(), header.size());
+
+    int written = 0;
+    for (const Slot& slot : frames) {
+        size_t json_end = protocol::FRAME_HEADER_SIZE + frameJsonLength(slot.frame.data());
+        if (json_end > slot.frame.size()) {
+            continue;
+        }
+        std::string record;
+        uint32_t face_size = static_cast<uint32_t>(slot.frame.size() - json_end);
+        if (!encodeRecord(slot.timestamp_us, face_size, slot.frame, record)) {
+            continue;
+        }
+        capture.write(record.data(), record.size());
+
+        if (face_size > 0) {
+            std::ofstream face((dir + "/face-" + std::to_string(written) + ".jpg").c_str(),
+                               std::ios::binary | std::ios::trunc);
+            face.write(slot.frame.data() + json_end, face_size);
+        }
+        written++;
+    }
+    return capture ? written : -1;
+}
+
+CaptureReader::CaptureReader() : truncated_(false) {
+}
+
+bool CaptureReader::open(const std::string& path) {
+    file_.open(path.c_str(), std::ios::binary);
+    if (!file_.is_open()) {
+        return false;
+    }
+    char header[FILE_HEADER_SIZE];
+    if (!file_.read(header, sizeof(header)) || memcmp(header, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 ||
+        getU32(header + 4) != FILE_VERSION) {
+        file_.close();
+        return false;
+    }
+    truncated_ = false;
+    return true;
+}
+
+bool CaptureReader::next(CaptureRecord& record) {
+    char length_bytes[4];
+    if (!file_.read(length_bytes, sizeof(length_bytes))) {
+        truncated_ = file_.gcount() != 0;
+        return false;
+    }
+    uint32_t body_size = getU32(length_bytes);
+    if (body_size < RECORD_FIXED_SIZE || body_size > protocol::MAX_FRAME_SIZE + RECORD_FIXED_SIZE) {
+        truncated_ = true;
+        return false;
+    }
+    std::string body(body_size, '\0');
+    if (!file_.read(&body[0], body_size)) {
+        truncated_ = true;
+        return false;
+    }
+
+    record.timestamp_us = getU64(body.data());
+    record.face_data_size = getU32(body.data() + 8);
+    uint32_t json_length = getU32(body.data() + 12);
+    if (json_length > body_size - RECORD_FIXED_SIZE) {
+        truncated_ = true;
+        return false;
+    }
+    const char* json_begin = body.data() + RECORD_FIXED_SIZE;
+    Json::Reader reader;
+    if (!reader.parse(json_begin, json_begin + json_length, record.request)) {
+        truncated_ = true;
+        return false;
+    }
+    record.face_data.assign(json_begin + json_length, body_size - RECORD_FIXED_SIZE - json_length);
+    return true;
+}
@@ -1,17 +1,29 @@
 #include "db_manager.h"
+#include "logger.h"
 #include "utils.h"
-#include <iostream>
+#include "metrics.h"
 #include <stdexcept>
 #include <cstring>
 #include <chrono>
 #include <iomanip>
 #include <sstream>
-#include <sys/stat.h>
-#include <fstream>
 #include <algorithm>
+#include <ctime>
+#include <cstdlib>
+
+// MySQL错误码：索引名重复（ER_DUP_KEYNAME）
+static const unsigned int ER_DUP_KEYNAME_CODE = 1061;
+
+// 批量写入时单条语句包含的最大行数
+static const size_t BATCH_INSERT_ROWS = 1000;
+
+// 数据库调用延迟直方图（按操作区分）
+static LatencyHistogram& dbLatency(const char* operation) {
+    return MetricsRegistry::instance().histogram("face_auth_db_latency_us", "op", operation);
+}
 
 // 获取当前时间戳，格式为: YYYY-MM-DD HH:MM:SS
-std::string getCurrentTimestamp() {
+static std::string getCurrentTimestamp() {
     auto now = std::chrono::system_clock::now();
     time_t now_time = std::chrono::system_clock::to_time_t(now);
     
@@ -22,106 +34,85 @@ std::string getCurrentTimestamp() {
     return std::string(buffer);
 }
 
-// 构造函数
-DBManager::DBManager() : mysql_(nullptr), connected_(false) {
-    // 初始化MySQL库
-    mysql_ = mysql_init(nullptr);
-    if (!mysql_) {
-        throw std::runtime_error("初始化MySQL失败");
+// 相对今天偏移若干天的本地日期
+static std::string formatDay(int offset_days, const char* format) {
+    time_t now = time(nullptr);
+    struct tm day;
+    localtime_r(&now, &day);
+    day.tm_hour = 12;  // 取中午，避免夏令时切换影响日期计算
+    day.tm_min = 0;
+    day.tm_sec = 0;
+    day.tm_mday += offset_days;
+    mktime(&day);
+    
+    char buffer[16];
+    strftime(buffer, sizeof(buffer), format, &day);
+    return std::string(buffer);
+}
+
+// 日分区名：p + YYYYMMDD
+static std::string dayPartitionName(int offset_days) {
+    return "p" + formatDay(offset_days, "%Y%m%d");
+}
+
+// 日分区定义：保存当天（及更早未分区）的数据
+static std::string dayPartitionDefinition(int offset_days) {
+    return "PARTITION `" + dayPartitionName(offset_days) + "` VALUES LESS THAN ('" +
+           formatDay(offset_days + 1, "%Y-%m-%d") + "')";
+}
+
+// 是否为日分区名（p + 8位数字）
+static bool isDayPartition(const std::string& name) {
+    if (name.size() != 9 || name[0] != 'p') {
+        return false;
     }
+    for (size_t i = 1; i < name.size(); ++i) {
+        if (name[i] < '0' || name[i] > '9') {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 构造函数
+DBManager::DBManager()
+    : connected_(false), auth_logs_partitioned_(false), retention_days_(90), partition_ahead_days_(7) {
 }
 
 // 析构函数
 DBManager::~DBManager() {
     disconnect();
-    
-    if (mysql_) {
-        mysql_close(mysql_);
-        mysql_ = nullptr;
-    }
 }
 
 // 连接数据库
 bool DBManager::connect(const std::string& host, const std::string& user, 
                       const std::string& password, const std::string& database) {
+    DBConfig config;
+    config.host = host;
+    config.user = user;
+    config.password = password;
+    config.database = database;
+    return connect(config);
+}
+
+bool DBManager::connect(const DBConfig& config) {
     if (connected_) {
         disconnect();
     }
     
-    // 尝试socket连接
-    const char* socket_paths[] = {
-        "/tmp/mysql.sock",
-        "/var/lib/mysql/mysql.sock",
-        "/var/run/mysqld/mysqld.sock"
-    };
-    bool connected = false;
-    
-    // 先尝试连接到指定数据库
-    for (const char* socket_path : socket_paths) {
-        struct stat buf;
-        if (stat(socket_path, &buf) == 0) {
-            std::cout << "尝试通过socket连接到MySQL: " << socket_path << std::endl;
-            if (mysql_real_connect(mysql_, NULL, user.c_str(), password.c_str(), 
-                                database.c_str(), 0, socket_path, 0)) {
-                connected = true;
-                std::cout << "通过socket " << socket_path << " 连接成功" << std::endl;
-                break;
-            }
-            std::cerr << "通过socket " << socket_path << " 连接失败: " << mysql_error(mysql_) << std::endl;
-        }
-    }
+    retention_days_ = config.auth_log_retention_days;
+    partition_ahead_days_ = std::max(1, config.auth_log_partition_ahead_days);
     
-    // 如果连接失败，尝试连接到服务器并创建数据库
-    if (!connected) {
-        for (const char* socket_path : socket_paths) {
-            struct stat buf;
-            if (stat(socket_path, &buf) == 0) {
-                std::cout << "尝试通过socket连接到MySQL服务器: " << socket_path << std::endl;
-                if (mysql_real_connect(mysql_, NULL, user.c_str(), password.c_str(), 
-                                    NULL, 0, socket_path, 0)) {
-                    connected = true;
-                    std::cout << "通过socket " << socket_path << " 连接到服务器成功" << std::endl;
-                    
-                    // 创建数据库
-                    std::string query = "CREATE DATABASE IF NOT EXISTS `" + database + "`";
-                    if (mysql_query(mysql_, query.c_str())) {
-                        std::cerr << "无法创建数据库: " << mysql_error(mysql_) << std::endl;
-                        mysql_close(mysql_);
-                        mysql_ = mysql_init(nullptr);
-                        return false;
-                    }
-                    
-                    // 使用新创建的数据库
-                    if (mysql_select_db(mysql_, database.c_str())) {
-                        std::cerr << "无法选择数据库: " << mysql_error(mysql_) << std::endl;
-                        mysql_close(mysql_);
-                        mysql_ = mysql_init(nullptr);
-                        return false;
-                    }
-                    
-                    break;
-                }
-                std::cerr << "通过socket " << socket_path << " 连接到服务器失败: " << mysql_error(mysql_) << std::endl;
-            }
-        }
-    }
-    
-    // 如果仍然连接失败，尝试TCP/IP连接
-    if (!connected) {
-        std::cerr << "所有socket连接尝试失败，尝试TCP/IP连接..." << std::endl;
-        if (!mysql_real_connect(mysql_, host.c_str(), user.c_str(), password.c_str(), 
-                              database.c_str(), 0, nullptr, 0)) {
-            std::cerr << "TCP/IP连接失败: " << mysql_error(mysql_) << std::endl;
-            return false;
-        }
+    if (!pool_.initialize(config)) {
+        return false;
     }
     
     connected_ = true;
-    std::cout << "连接到数据库: " << database << std::endl;
+    LOG_INFO(LogSubsystem::STORAGE, "连接到数据库: " << config.database);
     
     // 创建表
     if (!createTables()) {
-        std::cerr << "无法创建表" << std::endl;
+        LOG_ERROR(LogSubsystem::STORAGE, "无法创建表");
         disconnect();
         return false;
     }
@@ -132,15 +123,26 @@ bool DBManager::connect(const std::string& host, const std::string& user,
 // 断开连接
 void DBManager::disconnect() {
     connected_ = false;
+    pool_.shutdown();
 }
 
 // 创建用户表
 bool DBManager::createTables() {
     if (!connected_) {
-        std::cerr << "未连接到数据库" << std::endl;
+        LOG_ERROR(LogSubsystem::STORAGE, "未连接到数据库");
         return false;
     }
     
+    PooledConnection conn(pool_);
+    if (!conn) {
+        return false;
+    }
+    return createTables(conn);
+}
+
+bool DBManager::createTables(PooledConnection& conn) {
+    MYSQL* mysql = conn.get();
+    
     // 创建用户表
     const char* create_users_table = 
         "CREATE TABLE IF NOT EXISTS `users` ("
@@ -151,8 +153,9 @@ bool DBManager::createTables() {
         "  `last_login` DATETIME"
         ") ENGINE=InnoDB DEFAULT CHARSET=utf8mb4";
     
-    if (mysql_query(mysql_, create_users_table)) {
-        std::cerr << "无法创建用户表: " << mysql_error(mysql_) << std::endl;
+    if (mysql_query(mysql, create_users_table)) {
+        conn.checkError(mysql_errno(mysql));
+        LOG_ERROR(LogSubsystem::STORAGE, "无法创建用户表: " << mysql_error(mysql));
         return false;
     }
     
@@ -164,43 +167,98 @@ bool DBManager::createTables() {
         "  `file_path` VARCHAR(255) NOT NULL,"
         "  `type` ENUM('register', 'login') NOT NULL,"
         "  `created_at` DATETIME NOT NULL,"
+        "  INDEX `idx_face_images_user_type_created` (`user_id`, `type`, `created_at`),"
         "  FOREIGN KEY (`user_id`) REFERENCES `users`(`id`) ON DELETE CASCADE"
         ") ENGINE=InnoDB DEFAULT CHARSET=utf8mb4";
     
-    if (mysql_query(mysql_, create_face_images_table)) {
-        std::cerr << "无法创建face_images表: " << mysql_error(mysql_) << std::endl;
+    if (mysql_query(mysql, create_face_images_table)) {
+        conn.checkError(mysql_errno(mysql));
+        LOG_ERROR(LogSubsystem::STORAGE, "无法创建face_images表: " << mysql_error(mysql));
+        return false;
+    }
+    
+    // 旧版本创建的表没有该索引，补建（已存在时忽略重复索引错误）
+    const char* create_face_images_index =
+        "CREATE INDEX `idx_face_images_user_type_created` "
+        "ON `face_images` (`user_id`, `type`, `created_at`)";
+    
+    if (mysql_query(mysql, create_face_images_index) && mysql_errno(mysql) != ER_DUP_KEYNAME_CODE) {
+        conn.checkError(mysql_errno(mysql));
+        LOG_ERROR(LogSubsystem::STORAGE, "无法创建face_images索引: " << mysql_error(mysql));
         return false;
     }
     
-    // 创建认证日志表
-    const char* create_auth_logs_table = 
+    // 创建认证日志表：按天RANGE分区，过期数据按分区整体删除
+    // 分区表不支持外键，主键必须包含分区列
+    std::string create_auth_logs_table = 
         "CREATE TABLE IF NOT EXISTS `auth_logs` ("
-        "  `id` INT AUTO_INCREMENT PRIMARY KEY,"
+        "  `id` BIGINT AUTO_INCREMENT,"
         "  `user_id` INT NOT NULL,"
         "  `success` BOOLEAN NOT NULL DEFAULT 0,"
         "  `details` TEXT,"
         "  `created_at` DATETIME NOT NULL,"
-        "  FOREIGN KEY (`user_id`) REFERENCES `users`(`id`) ON DELETE CASCADE"
+        "  PRIMARY KEY (`id`, `created_at`),"
+        "  INDEX `idx_auth_logs_user_created` (`user_id`, `created_at`)"
+        ") ENGINE=InnoDB DEFAULT CHARSET=utf8mb4 "
+        "PARTITION BY RANGE COLUMNS(`created_at`) (";
+    for (int day = 0; day <= partition_ahead_days_; ++day) {
+        create_auth_logs_table += dayPartitionDefinition(day) + ",";
+    }
+    create_auth_logs_table += "PARTITION `pmax` VALUES LESS THAN (MAXVALUE))";
+    
+    if (mysql_query(mysql, create_auth_logs_table.c_str())) {
+        conn.checkError(mysql_errno(mysql));
+        LOG_ERROR(LogSubsystem::STORAGE, "无法创建auth_logs表: " << mysql_error(mysql));
+        return false;
+    }
+    
+    // 创建预写日志检查点表：每个日志来源已写入的最大段序号
+    const char* create_wal_checkpoint_table =
+        "CREATE TABLE IF NOT EXISTS `wal_checkpoint` ("
+        "  `source` VARCHAR(191) PRIMARY KEY,"
+        "  `sequence` BIGINT UNSIGNED NOT NULL,"
+        "  `updated_at` DATETIME NOT NULL"
         ") ENGINE=InnoDB DEFAULT CHARSET=utf8mb4";
     
-    if (mysql_query(mysql_, create_auth_logs_table)) {
-        std::cerr << "无法创建auth_logs表: " << mysql_error(mysql_) << std::endl;
+    if (mysql_query(mysql, create_wal_checkpoint_table)) {
+        conn.checkError(mysql_errno(mysql));
+        LOG_ERROR(LogSubsystem::STORAGE, "无法创建wal_checkpoint表: " << mysql_error(mysql));
         return false;
     }
     
+    // 旧版本创建的表未分区，保留策略无法生效，提示手动迁移
+    std::vector<std::string> partitions;
+    if (!getAuthLogPartitions(conn, partitions)) {
+        return false;
+    }
+    auth_logs_partitioned_ = !partitions.empty();
+    if (!auth_logs_partitioned_) {
+        LOG_WARN(LogSubsystem::STORAGE, "auth_logs表未分区，日志保留策略不会生效，"
+                  << "请参考 scripts/migrate_auth_logs_partitioned.sql 迁移");
+    }
+    
     return true;
 }
 
 // 添加用户
-bool DBManager::addUser(const std::string& username, const std::string& password, const std::string& face_data) {
+bool DBManager::addUser(const std::string& username, const std::string& password,
+                        const std::vector<FaceImage>& faces) {
+    static LatencyHistogram& latency = dbLatency("addUser");
+    ScopedLatency timer(latency);
     if (!connected_) {
-        std::cerr << "未连接到数据库" << std::endl;
+        LOG_ERROR(LogSubsystem::STORAGE, "未连接到数据库");
+        return false;
+    }
+    
+    PooledConnection conn(pool_);
+    if (!conn) {
         return false;
     }
+    MYSQL* mysql = conn.get();
     
     // 检查用户名是否已存在
-    if (getUserByUsername(username).id != 0) {
-        std::cerr << "用户名已存在: " << username << std::endl;
+    if (getUserByUsername(conn, username).id != 0) {
+        LOG_ERROR(LogSubsystem::STORAGE, "用户名已存在: " << username);
         return false;
     }
     
@@ -211,15 +269,9 @@ bool DBManager::addUser(const std::string& username, const std::string& password
     // 准备插入用户的SQL语句
     const char* query = "INSERT INTO users (username, password, created_at) VALUES (?, ?, ?)";
     
-    MYSQL_STMT* stmt = mysql_stmt_init(mysql_);
+    // 获取本连接上缓存的预处理语句
+    MYSQL_STMT* stmt = conn.prepare(query);
     if (!stmt) {
-        std::cerr << "无法初始化语句: " << mysql_error(mysql_) << std::endl;
-        return false;
-    }
-    
-    if (mysql_stmt_prepare(stmt, query, strlen(query))) {
-        std::cerr << "无法准备语句: " << mysql_stmt_error(stmt) << std::endl;
-        mysql_stmt_close(stmt);
         return false;
     }
     
@@ -240,105 +292,64 @@ bool DBManager::addUser(const std::string& username, const std::string& password
     bind[2].buffer_length = timestamp.length();
     
     if (mysql_stmt_bind_param(stmt, bind)) {
-        std::cerr << "无法绑定参数: " << mysql_stmt_error(stmt) << std::endl;
-        mysql_stmt_close(stmt);
+        LOG_ERROR(LogSubsystem::STORAGE, "无法绑定参数: " << mysql_stmt_error(stmt));
         return false;
     }
     
     // 执行插入
-    if (mysql_stmt_execute(stmt)) {
-        std::cerr << "无法执行语句: " << mysql_stmt_error(stmt) << std::endl;
-        mysql_stmt_close(stmt);
+    if (!conn.execute(stmt)) {
+        LOG_ERROR(LogSubsystem::STORAGE, "无法执行语句: " << mysql_stmt_error(stmt));
         return false;
     }
     
     // 获取新插入用户的ID
-    int user_id = mysql_insert_id(mysql_);
-    mysql_stmt_close(stmt);
-    
+    int user_id = mysql_insert_id(mysql);
     // 保存人脸数据
-    if (!storeFaceData(user_id, face_data, "register")) {
-        std::cerr << "无法存储用户的人脸数据: " << username << std::endl;
-        
-        // 删除刚刚创建的用户记录
-        std::string delete_query = "DELETE FROM users WHERE id = " + std::to_string(user_id);
-        mysql_query(mysql_, delete_query.c_str());
-        
-        return false;
+    for (const FaceImage& face : faces) {
+        if (!storeFaceData(conn, user_id, face, "register")) {
+            LOG_ERROR(LogSubsystem::STORAGE, "无法存储用户的人脸数据: " << username);
+            
+            // 删除刚刚创建的用户记录
+            std::string delete_query = "DELETE FROM users WHERE id = " + std::to_string(user_id);
+            mysql_query(mysql, delete_query.c_str());
+            
+            return false;
+        }
     }
     
     return true;
 }
 
 // 存储人脸数据
-bool DBManager::storeFaceData(int user_id, const std::string& face_data, const std::string& type) {
+bool DBManager::storeFaceData(int user_id, const FaceImage& face, const std::string& type) {
+    static LatencyHistogram& latency = dbLatency("storeFaceData");
+    ScopedLatency timer(latency);
     if (!connected_) {
-        std::cerr << "未连接到数据库" << std::endl;
+        LOG_ERROR(LogSubsystem::STORAGE, "未连接到数据库");
         return false;
     }
     
-    std::string timestamp = getCurrentTimestamp();
-    
-    // 保存人脸图像到文件
-    std::string face_filename;
-    if (type == "register") {
-        // 获取用户名
-        UserInfo user = getUserById(user_id);
-        if (user.id == 0) {
-            std::cerr << "获取用户名失败，无法保存人脸数据" << std::endl;
-            return false;
-        }
-        face_filename = user.username + "_register.jpg";
-    } else {
-        // 登录时使用时间戳
-        face_filename = "login_" + std::to_string(user_id) + "_" + 
-                       timestamp.substr(0, 10) + "_" + timestamp.substr(11, 8) + ".jpg";
-        // 替换冒号为下划线，避免文件名问题
-        std::replace(face_filename.begin(), face_filename.end(), ':', '_');
-    }
-    
-    // 确保目录存在
-    std::string faces_dir = "face_auth_data/faces";
-    struct stat st;
-    if (stat(faces_dir.c_str(), &st) != 0) {
-        if (mkdir(faces_dir.c_str(), 0755) != 0) {
-            std::cerr << "创建faces目录失败" << std::endl;
-            return false;
-        }
+    PooledConnection conn(pool_);
+    if (!conn) {
+        return false;
     }
+    return storeFaceData(conn, user_id, face, type);
+}
+
+bool DBManager::storeFaceData(PooledConnection& conn, int user_id, const FaceImage& face, const std::string& type) {
+    std::string timestamp = getCurrentTimestamp();
     
-    // 使用相对路径以保持一致性
-    std::string file_path = faces_dir + "/" + face_filename;
-    std::cout << "保存人脸数据到：" << file_path << std::endl;
-    
-    // 如果是登录，不需要实际保存文件，只记录路径
-    if (type == "login") {
-        file_path = "LOGIN_IMAGE_NOT_SAVED";
-    } else {
-        // 保存图像到文件
-        std::ofstream outfile(file_path, std::ios::binary);
-        if (!outfile) {
-            std::cerr << "无法打开文件用于写入: " << file_path << std::endl;
-            return false;
-        }
-        outfile.write(face_data.c_str(), face_data.size());
-        outfile.close();
-        
-        std::cout << "人脸数据保存成功，大小：" << face_data.size() << " 字节" << std::endl;
+    std::string file_path = saveFaceFile(face, type);
+    if (file_path.empty()) {
+        return false;
     }
     
     // 准备插入人脸数据的SQL语句
     const char* query = "INSERT INTO face_images (user_id, file_path, type, created_at) VALUES (?, ?, ?, ?)";
     
-    MYSQL_STMT* stmt = mysql_stmt_init(mysql_);
+    // 获取本连接上缓存的预处理语句
+    MYSQL_STMT* stmt = conn.prepare(query);
     if (!stmt) {
-        std::cerr << "无法初始化语句: " << mysql_error(mysql_) << std::endl;
-        return false;
-    }
-    
-    if (mysql_stmt_prepare(stmt, query, strlen(query))) {
-        std::cerr << "无法准备语句: " << mysql_stmt_error(stmt) << std::endl;
-        mysql_stmt_close(stmt);
         return false;
     }
     
@@ -362,112 +373,155 @@ bool DBManager::storeFaceData(int user_id, const std::string& face_data, const s
     bind[3].buffer_length = timestamp.length();
     
     if (mysql_stmt_bind_param(stmt, bind)) {
-        std::cerr << "无法绑定参数: " << mysql_stmt_error(stmt) << std::endl;
-        mysql_stmt_close(stmt);
+        LOG_ERROR(LogSubsystem::STORAGE, "无法绑定参数: " << mysql_stmt_error(stmt));
         return false;
     }
     
     // 执行插入
-    if (mysql_stmt_execute(stmt)) {
-        std::cerr << "无法执行语句: " << mysql_stmt_error(stmt) << std::endl;
-        mysql_stmt_close(stmt);
+    if (!conn.execute(stmt)) {
+        LOG_ERROR(LogSubsystem::STORAGE, "无法执行语句: " << mysql_stmt_error(stmt));
         return false;
     }
     
-    mysql_stmt_close(stmt);
     return true;
 }
 
 // 更新用户的人脸数据
-bool DBManager::updateUserFace(int user_id, const std::string& face_data) {
+bool DBManager::updateUserFace(int user_id, const std::vector<FaceImage>& faces) {
+    static LatencyHistogram& latency = dbLatency("updateUserFace");
+    ScopedLatency timer(latency);
     if (!connected_) {
-        std::cerr << "未连接到数据库" << std::endl;
+        LOG_ERROR(LogSubsystem::STORAGE, "未连接到数据库");
+        return false;
+    }
+    
+    PooledConnection conn(pool_);
+    if (!conn) {
         return false;
     }
     
     // 检查用户是否存在
-    if (getUserById(user_id).id == 0) {
-        std::cerr << "用户未找到: " << user_id << std::endl;
+    if (getUserById(conn, user_id).id == 0) {
+        LOG_ERROR(LogSubsystem::STORAGE, "用户未找到: " << user_id);
         return false;
     }
     
     // 存储新的人脸数据
-    return storeFaceData(user_id, face_data, "register");
+    for (const FaceImage& face : faces) {
+        if (!storeFaceData(conn, user_id, face, "register")) {
+            return false;
+        }
+    }
+    return true;
 }
 
-// 获取所有用户
-std::vector<UserInfo> DBManager::getAllUsers() {
-    std::vector<UserInfo> users;
-    
+// 流式遍历全部用户及其最新注册人脸，结果集不在客户端缓存
+bool DBManager::forEachUser(const std::function<bool(const UserInfo&)>& visitor) {
+    static LatencyHistogram& latency = dbLatency("forEachUser");
+    ScopedLatency timer(latency);
     if (!connected_) {
-        std::cerr << "未连接到数据库" << std::endl;
-        return users;
+        LOG_ERROR(LogSubsystem::STORAGE, "未连接到数据库");
+        return false;
     }
     
-    // 查询所有用户
+    PooledConnection conn(pool_);
+    if (!conn) {
+        return false;
+    }
+    MYSQL* mysql = conn.get();
+    
+    // 每个用户一行，相关子查询走 idx_face_images_user_type_created 索引只取最新的注册人脸
     const char* query = 
-        "SELECT u.id, u.username, u.created_at, f.file_path "
+        "SELECT u.id, u.username, u.password, u.created_at, "
+        "       (SELECT f.file_path FROM face_images f "
+        "        WHERE f.user_id = u.id AND f.type = 'register' "
+        "        ORDER BY f.created_at DESC, f.id DESC LIMIT 1) "
         "FROM users u "
-        "LEFT JOIN face_images f ON u.id = f.user_id "
-        "WHERE f.type = 'register' "
-        "ORDER BY f.created_at DESC";
+        "ORDER BY u.id";
     
-    if (mysql_query(mysql_, query)) {
-        std::cerr << "查询错误: " << mysql_error(mysql_) << std::endl;
-        return users;
+    if (mysql_query(mysql, query)) {
+        conn.checkError(mysql_errno(mysql));
+        LOG_ERROR(LogSubsystem::STORAGE, "查询错误: " << mysql_error(mysql));
+        return false;
     }
     
-    MYSQL_RES* result = mysql_store_result(mysql_);
+    // mysql_use_result逐行从服务器读取，内存占用与用户数无关
+    MYSQL_RES* result = mysql_use_result(mysql);
     if (!result) {
-        std::cerr << "结果错误: " << mysql_error(mysql_) << std::endl;
-        return users;
+        conn.checkError(mysql_errno(mysql));
+        LOG_ERROR(LogSubsystem::STORAGE, "结果错误: " << mysql_error(mysql));
+        return false;
     }
     
-    // 处理查询结果
+    bool completed = true;
     MYSQL_ROW row;
+    UserInfo user;
     while ((row = mysql_fetch_row(result))) {
-        UserInfo user;
         user.id = std::stoi(row[0]);
         user.username = row[1];
-        user.created_at = row[2];
+        user.password_hash = row[2] ? row[2] : "";
+        user.created_at = row[3] ? row[3] : "";
+        user.file_path = row[4] ? row[4] : "";
         
-        if (row[3]) {
-            user.file_path = row[3];
+        if (!visitor(user)) {
+            completed = false;
+            break;
         }
-        
-        users.push_back(user);
+    }
+    
+    // 提前结束时mysql_free_result会读完剩余行，连接可以继续使用
+    bool fetch_failed = completed && mysql_errno(mysql) != 0;
+    if (fetch_failed) {
+        conn.checkError(mysql_errno(mysql));
+        LOG_ERROR(LogSubsystem::STORAGE, "读取用户结果中断: " << mysql_error(mysql));
     }
     
     mysql_free_result(result);
-    return users;
+    return !fetch_failed;
 }
 
 // 根据ID获取用户
 UserInfo DBManager::getUserById(int user_id) {
+    static LatencyHistogram& latency = dbLatency("getUserById");
+    ScopedLatency timer(latency);
     UserInfo user;
     user.id = 0; // 默认值表示未找到
     
     if (!connected_) {
-        std::cerr << "未连接到数据库" << std::endl;
+        LOG_ERROR(LogSubsystem::STORAGE, "未连接到数据库");
         return user;
     }
     
+    PooledConnection conn(pool_);
+    if (!conn) {
+        return user;
+    }
+    return getUserById(conn, user_id);
+}
+
+UserInfo DBManager::getUserById(PooledConnection& conn, int user_id) {
+    MYSQL* mysql = conn.get();
+    UserInfo user;
+    user.id = 0;
+    
     // 查询用户
     std::string query = 
-        "SELECT u.id, u.username, u.created_at, f.file_path "
+        "SELECT u.id, u.username, u.password, u.created_at, "
+        "       (SELECT f.file_path FROM face_images f "
+        "        WHERE f.user_id = u.id AND f.type = 'register' "
+        "        ORDER BY f.created_at DESC, f.id DESC LIMIT 1) "
         "FROM users u "
-        "LEFT JOIN (SELECT * FROM face_images WHERE type = 'register' "
-        "           ORDER BY created_at DESC LIMIT 1) f ON u.id = f.user_id "
         "WHERE u.id = " + std::to_string(user_id);
     
-    if (mysql_query(mysql_, query.c_str())) {
-        std::cerr << "查询错误: " << mysql_error(mysql_) << std::endl;
+    if (mysql_query(mysql, query.c_str())) {
+        conn.checkError(mysql_errno(mysql));
+        LOG_ERROR(LogSubsystem::STORAGE, "查询错误: " << mysql_error(mysql));
         return user;
     }
     
-    MYSQL_RES* result = mysql_store_result(mysql_);
+    MYSQL_RES* result = mysql_store_result(mysql);
     if (!result) {
-        std::cerr << "结果错误: " << mysql_error(mysql_) << std::endl;
+        LOG_ERROR(LogSubsystem::STORAGE, "结果错误: " << mysql_error(mysql));
         return user;
     }
     
@@ -476,10 +530,11 @@ UserInfo DBManager::getUserById(int user_id) {
     if (row) {
         user.id = std::stoi(row[0]);
         user.username = row[1];
-        user.created_at = row[2];
+        user.password_hash = row[2];
+        user.created_at = row[3];
         
-        if (row[3]) {
-            user.file_path = row[3];
+        if (row[4]) {
+            user.file_path = row[4];
         }
     }
     
@@ -489,31 +544,40 @@ UserInfo DBManager::getUserById(int user_id) {
 
 // 根据用户名获取用户
 UserInfo DBManager::getUserByUsername(const std::string& username) {
+    static LatencyHistogram& latency = dbLatency("getUserByUsername");
+    ScopedLatency timer(latency);
     UserInfo user;
     user.id = 0; // 默认值表示未找到
     
     if (!connected_) {
-        std::cerr << "未连接到数据库" << std::endl;
+        LOG_ERROR(LogSubsystem::STORAGE, "未连接到数据库");
         return user;
     }
     
-    // 准备查询语句
+    PooledConnection conn(pool_);
+    if (!conn) {
+        return user;
+    }
+    return getUserByUsername(conn, username);
+}
+
+UserInfo DBManager::getUserByUsername(PooledConnection& conn, const std::string& username) {
+    UserInfo user;
+    user.id = 0;
+    
+    // 准备查询语句：一次往返取回ID、密码哈希与最新的注册人脸
+    // 相关子查询走 idx_face_images_user_type_created 索引，只读取该用户最新的一行
     const char* query = 
-        "SELECT u.id, u.username, u.created_at, f.file_path "
+        "SELECT u.id, u.username, u.password, u.created_at, "
+        "       (SELECT f.file_path FROM face_images f "
+        "        WHERE f.user_id = u.id AND f.type = 'register' "
+        "        ORDER BY f.created_at DESC, f.id DESC LIMIT 1) "
         "FROM users u "
-        "LEFT JOIN (SELECT * FROM face_images WHERE type = 'register' "
-        "           ORDER BY created_at DESC LIMIT 1) f ON u.id = f.user_id "
         "WHERE u.username = ?";
     
-    MYSQL_STMT* stmt = mysql_stmt_init(mysql_);
+    // 获取本连接上缓存的预处理语句
+    MYSQL_STMT* stmt = conn.prepare(query);
     if (!stmt) {
-        std::cerr << "无法初始化语句: " << mysql_error(mysql_) << std::endl;
-        return user;
-    }
-    
-    if (mysql_stmt_prepare(stmt, query, strlen(query))) {
-        std::cerr << "无法准备语句: " << mysql_stmt_error(stmt) << std::endl;
-        mysql_stmt_close(stmt);
         return user;
     }
     
@@ -526,37 +590,36 @@ UserInfo DBManager::getUserByUsername(const std::string& username) {
     bind[0].buffer_length = username.length();
     
     if (mysql_stmt_bind_param(stmt, bind)) {
-        std::cerr << "无法绑定参数: " << mysql_stmt_error(stmt) << std::endl;
-        mysql_stmt_close(stmt);
+        LOG_ERROR(LogSubsystem::STORAGE, "无法绑定参数: " << mysql_stmt_error(stmt));
         return user;
     }
     
     // 执行查询
-    if (mysql_stmt_execute(stmt)) {
-        std::cerr << "无法执行语句: " << mysql_stmt_error(stmt) << std::endl;
-        mysql_stmt_close(stmt);
+    if (!conn.execute(stmt)) {
+        LOG_ERROR(LogSubsystem::STORAGE, "无法执行语句: " << mysql_stmt_error(stmt));
         return user;
     }
     
     // 准备结果集
     if (mysql_stmt_store_result(stmt)) {
-        std::cerr << "无法存储结果: " << mysql_stmt_error(stmt) << std::endl;
-        mysql_stmt_close(stmt);
+        LOG_ERROR(LogSubsystem::STORAGE, "无法存储结果: " << mysql_stmt_error(stmt));
+        mysql_stmt_free_result(stmt);
         return user;
     }
     
     // 如果有结果
     if (mysql_stmt_num_rows(stmt) > 0) {
         // 绑定结果列
-        MYSQL_BIND result_bind[4];
+        MYSQL_BIND result_bind[5];
         memset(result_bind, 0, sizeof(result_bind));
         
         int id;
         char username_buf[51];
+        char password_buf[101];
         char created_at_buf[20];
-        char face_data_buf[65536]; // 大缓冲区用于存储人脸数据
-        unsigned long username_length, created_at_length, face_data_length;
-        my_bool is_null[4];
+        char file_path_buf[256];
+        unsigned long username_length, password_length, created_at_length, file_path_length;
+        my_bool is_null[5];
         
         result_bind[0].buffer_type = MYSQL_TYPE_LONG;
         result_bind[0].buffer = (void*)&id;
@@ -569,20 +632,26 @@ UserInfo DBManager::getUserByUsername(const std::string& username) {
         result_bind[1].is_null = &is_null[1];
         
         result_bind[2].buffer_type = MYSQL_TYPE_STRING;
-        result_bind[2].buffer = created_at_buf;
-        result_bind[2].buffer_length = sizeof(created_at_buf);
-        result_bind[2].length = &created_at_length;
+        result_bind[2].buffer = password_buf;
+        result_bind[2].buffer_length = sizeof(password_buf);
+        result_bind[2].length = &password_length;
         result_bind[2].is_null = &is_null[2];
         
         result_bind[3].buffer_type = MYSQL_TYPE_STRING;
-        result_bind[3].buffer = face_data_buf;
-        result_bind[3].buffer_length = sizeof(face_data_buf);
-        result_bind[3].length = &face_data_length;
+        result_bind[3].buffer = created_at_buf;
+        result_bind[3].buffer_length = sizeof(created_at_buf);
+        result_bind[3].length = &created_at_length;
         result_bind[3].is_null = &is_null[3];
         
+        result_bind[4].buffer_type = MYSQL_TYPE_STRING;
+        result_bind[4].buffer = file_path_buf;
+        result_bind[4].buffer_length = sizeof(file_path_buf);
+        result_bind[4].length = &file_path_length;
+        result_bind[4].is_null = &is_null[4];
+        
         if (mysql_stmt_bind_result(stmt, result_bind)) {
-            std::cerr << "无法绑定结果: " << mysql_stmt_error(stmt) << std::endl;
-            mysql_stmt_close(stmt);
+            LOG_ERROR(LogSubsystem::STORAGE, "无法绑定结果: " << mysql_stmt_error(stmt));
+            mysql_stmt_free_result(stmt);
             return user;
         }
         
@@ -590,22 +659,31 @@ UserInfo DBManager::getUserByUsername(const std::string& username) {
         if (mysql_stmt_fetch(stmt) == 0) {
             user.id = id;
             user.username = std::string(username_buf, username_length);
+            user.password_hash = std::string(password_buf, password_length);
             user.created_at = std::string(created_at_buf, created_at_length);
             
-            if (!is_null[3]) {
-                user.file_path = std::string(face_data_buf, face_data_length);
+            if (!is_null[4]) {
+                user.file_path = std::string(file_path_buf, file_path_length);
             }
         }
     }
     
-    mysql_stmt_close(stmt);
+    // 释放结果集，语句留在缓存中复用
+    mysql_stmt_free_result(stmt);
     return user;
 }
 
 // 记录认证日志
 bool DBManager::logAuthentication(int user_id, bool success, const std::string& details) {
+    static LatencyHistogram& latency = dbLatency("logAuthentication");
+    ScopedLatency timer(latency);
     if (!connected_) {
-        std::cerr << "未连接到数据库" << std::endl;
+        LOG_ERROR(LogSubsystem::STORAGE, "未连接到数据库");
+        return false;
+    }
+    
+    PooledConnection conn(pool_);
+    if (!conn) {
         return false;
     }
     
@@ -614,15 +692,9 @@ bool DBManager::logAuthentication(int user_id, bool success, const std::string&
     // 准备插入日志的SQL语句
     const char* query = "INSERT INTO auth_logs (user_id, success, details, created_at) VALUES (?, ?, ?, ?)";
     
-    MYSQL_STMT* stmt = mysql_stmt_init(mysql_);
+    // 获取本连接上缓存的预处理语句
+    MYSQL_STMT* stmt = conn.prepare(query);
     if (!stmt) {
-        std::cerr << "无法初始化语句: " << mysql_error(mysql_) << std::endl;
-        return false;
-    }
-    
-    if (mysql_stmt_prepare(stmt, query, strlen(query))) {
-        std::cerr << "无法准备语句: " << mysql_stmt_error(stmt) << std::endl;
-        mysql_stmt_close(stmt);
         return false;
     }
     
@@ -647,53 +719,39 @@ bool DBManager::logAuthentication(int user_id, bool success, const std::string&
     bind[3].buffer_length = timestamp.length();
     
     if (mysql_stmt_bind_param(stmt, bind)) {
-        std::cerr << "无法绑定参数: " << mysql_stmt_error(stmt) << std::endl;
-        mysql_stmt_close(stmt);
+        LOG_ERROR(LogSubsystem::STORAGE, "无法绑定参数: " << mysql_stmt_error(stmt));
         return false;
     }
     
     // 执行插入
-    if (mysql_stmt_execute(stmt)) {
-        std::cerr << "无法执行语句: " << mysql_stmt_error(stmt) << std::endl;
-        mysql_stmt_close(stmt);
+    if (!conn.execute(stmt)) {
+        LOG_ERROR(LogSubsystem::STORAGE, "无法执行语句: " << mysql_stmt_error(stmt));
         return false;
     }
     
-    mysql_stmt_close(stmt);
-    
-    // 如果认证成功，更新用户最后登录时间
-    if (success) {
-        std::string update_query = "UPDATE users SET last_login = '" + timestamp + "' WHERE id = " + std::to_string(user_id);
-        
-        if (mysql_query(mysql_, update_query.c_str())) {
-            std::cerr << "无法更新最后登录时间: " << mysql_error(mysql_) << std::endl;
-            return false;
-        }
-    }
-    
     return true;
 }
 
 bool DBManager::updateLastLogin(int user_id) {
+    static LatencyHistogram& latency = dbLatency("updateLastLogin");
+    ScopedLatency timer(latency);
     if (!connected_) {
-        std::cerr << "未连接到数据库" << std::endl;
+        LOG_ERROR(LogSubsystem::STORAGE, "未连接到数据库");
         return false;
     }
     
+    PooledConnection conn(pool_);
+    if (!conn) {
+        return false;
+    }
     std::string timestamp = getCurrentTimestamp();
     
     // 准备更新用户最后登录时间的SQL语句
     const char* query = "UPDATE users SET last_login = ? WHERE id = ?";
     
-    MYSQL_STMT* stmt = mysql_stmt_init(mysql_);
+    // 获取本连接上缓存的预处理语句
+    MYSQL_STMT* stmt = conn.prepare(query);
     if (!stmt) {
-        std::cerr << "无法初始化语句: " << mysql_error(mysql_) << std::endl;
-        return false;
-    }
-    
-    if (mysql_stmt_prepare(stmt, query, strlen(query))) {
-        std::cerr << "无法准备语句: " << mysql_stmt_error(stmt) << std::endl;
-        mysql_stmt_close(stmt);
         return false;
     }
     
@@ -709,41 +767,421 @@ bool DBManager::updateLastLogin(int user_id) {
     bind[1].buffer = (void*)&user_id;
     
     if (mysql_stmt_bind_param(stmt, bind)) {
-        std::cerr << "无法绑定参数: " << mysql_stmt_error(stmt) << std::endl;
-        mysql_stmt_close(stmt);
+        LOG_ERROR(LogSubsystem::STORAGE, "无法绑定参数: " << mysql_stmt_error(stmt));
         return false;
     }
     
     // 执行更新
-    if (mysql_stmt_execute(stmt)) {
-        std::cerr << "无法执行语句: " << mysql_stmt_error(stmt) << std::endl;
-        mysql_stmt_close(stmt);
+    if (!conn.execute(stmt)) {
+        LOG_ERROR(LogSubsystem::STORAGE, "无法执行语句: " << mysql_stmt_error(stmt));
+        return false;
+    }
+    
+    LOG_DEBUG(LogSubsystem::STORAGE, "更新用户最后登录时间: " << user_id);
+    return true;
+}
+
+// 查询auth_logs的分区名，未分区时返回空列表
+bool DBManager::getAuthLogPartitions(PooledConnection& conn, std::vector<std::string>& partitions) {
+    MYSQL* mysql = conn.get();
+    partitions.clear();
+    
+    const char* query =
+        "SELECT PARTITION_NAME FROM information_schema.PARTITIONS "
+        "WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'auth_logs' "
+        "AND PARTITION_NAME IS NOT NULL "
+        "ORDER BY PARTITION_ORDINAL_POSITION";
+    
+    if (mysql_query(mysql, query)) {
+        conn.checkError(mysql_errno(mysql));
+        LOG_ERROR(LogSubsystem::STORAGE, "无法查询auth_logs分区: " << mysql_error(mysql));
+        return false;
+    }
+    
+    MYSQL_RES* result = mysql_store_result(mysql);
+    if (!result) {
+        LOG_ERROR(LogSubsystem::STORAGE, "结果错误: " << mysql_error(mysql));
         return false;
     }
     
-    mysql_stmt_close(stmt);
+    MYSQL_ROW row;
+    while ((row = mysql_fetch_row(result))) {
+        if (row[0]) {
+            partitions.push_back(row[0]);
+        }
+    }
     
-    std::cout << "更新用户最后登录时间: " << user_id << std::endl;
+    mysql_free_result(result);
     return true;
 }
 
+// 分区维护：提前创建未来的日分区，删除超过保留天数的分区
+bool DBManager::runMaintenance() {
+    static LatencyHistogram& latency = dbLatency("runMaintenance");
+    ScopedLatency timer(latency);
+    if (!connected_) {
+        LOG_ERROR(LogSubsystem::STORAGE, "未连接到数据库");
+        return false;
+    }
+    
+    if (!auth_logs_partitioned_) {
+        return true;
+    }
+    
+    PooledConnection conn(pool_);
+    if (!conn) {
+        return false;
+    }
+    MYSQL* mysql = conn.get();
+    
+    std::vector<std::string> partitions;
+    if (!getAuthLogPartitions(conn, partitions)) {
+        return false;
+    }
+    
+    std::string last_day;
+    bool has_pmax = false;
+    std::vector<std::string> day_partitions;
+    for (const std::string& name : partitions) {
+        if (name == "pmax") {
+            has_pmax = true;
+        } else if (isDayPartition(name)) {
+            day_partitions.push_back(name);
+            last_day = std::max(last_day, name);
+        }
+    }
+    
+    // 只能在最后一个日分区之后追加；pmax通常为空，REORGANIZE只修改元数据
+    std::string new_partitions;
+    int added = 0;
+    for (int day = 0; day <= partition_ahead_days_; ++day) {
+        if (dayPartitionName(day) > last_day) {
+            new_partitions += dayPartitionDefinition(day) + ",";
+            added++;
+        }
+    }
+    
+    if (added > 0) {
+        std::string query;
+        if (has_pmax) {
+            query = "ALTER TABLE `auth_logs` REORGANIZE PARTITION `pmax` INTO (" + new_partitions +
+                    "PARTITION `pmax` VALUES LESS THAN (MAXVALUE))";
+        } else {
+            new_partitions.resize(new_partitions.size() - 1);
+            query = "ALTER TABLE `auth_logs` ADD PARTITION (" + new_partitions + ")";
+        }
+        
+        if (mysql_query(mysql, query.c_str())) {
+            conn.checkError(mysql_errno(mysql));
+            LOG_ERROR(LogSubsystem::STORAGE, "无法创建auth_logs分区: " << mysql_error(mysql));
+            return false;
+        }
+        LOG_INFO(LogSubsystem::STORAGE, "已创建 " << added << " 个auth_logs日分区");
+    }
+    
+    // DROP PARTITION直接删除整个分区文件，不逐行删除也不长时间锁表
+    if (retention_days_ > 0) {
+        std::string cutoff = dayPartitionName(-retention_days_);
+        std::string expired;
+        int dropped = 0;
+        for (const std::string& name : day_partitions) {
+            if (name < cutoff) {
+                expired += (expired.empty() ? "`" : ",`") + name + "`";
+                dropped++;
+            }
+        }
+        
+        if (dropped > 0) {
+            std::string query = "ALTER TABLE `auth_logs` DROP PARTITION " + expired;
+            if (mysql_query(mysql, query.c_str())) {
+                conn.checkError(mysql_errno(mysql));
+                LOG_ERROR(LogSubsystem::STORAGE, "无法删除过期的auth_logs分区: " << mysql_error(mysql));
+                return false;
+            }
+            LOG_INFO(LogSubsystem::STORAGE, "已删除 " << dropped << " 个过期的auth_logs分区（保留 "
+                      << retention_days_ << " 天）");
+        }
+    }
+    
+    return true;
+}
+
+// 将字符串转义后加上引号，用于拼接多行INSERT
+static std::string quoteString(MYSQL* mysql, const std::string& value) {
+    std::string escaped(value.size() * 2 + 1, '\0');
+    unsigned long length = mysql_real_escape_string(mysql, &escaped[0], value.c_str(), value.size());
+    escaped.resize(length);
+    return "'" + escaped + "'";
+}
+
+// 批量记录认证日志（多行INSERT）
+bool DBManager::insertAuthLogs(const std::vector<AuthLogEntry>& entries) {
+    static LatencyHistogram& latency = dbLatency("insertAuthLogs");
+    ScopedLatency timer(latency);
+    if (entries.empty()) {
+        return true;
+    }
+    
+    if (!connected_) {
+        LOG_ERROR(LogSubsystem::STORAGE, "未连接到数据库");
+        return false;
+    }
+    
+    PooledConnection conn(pool_);
+    if (!conn) {
+        return false;
+    }
+    return insertAuthLogs(conn, entries);
+}
+
+bool DBManager::insertAuthLogs(PooledConnection& conn, const std::vector<AuthLogEntry>& entries) {
+    MYSQL* mysql = conn.get();
+    
+    // 按块拼接，单条语句不超过max_allowed_packet
+    for (size_t begin = 0; begin < entries.size(); begin += BATCH_INSERT_ROWS) {
+        size_t end = std::min(entries.size(), begin + BATCH_INSERT_ROWS);
+        std::string query = "INSERT INTO auth_logs (user_id, success, details, created_at) VALUES ";
+        for (size_t i = begin; i < end; ++i) {
+            const AuthLogEntry& entry = entries[i];
+            if (i > begin) {
+                query += ",";
+            }
+            query += "(" + std::to_string(entry.user_id) + "," + (entry.success ? "1" : "0") + "," +
+                     quoteString(mysql, entry.details) + "," + quoteString(mysql, entry.created_at) + ")";
+        }
+        
+        if (mysql_real_query(mysql, query.c_str(), query.size())) {
+            conn.checkError(mysql_errno(mysql));
+            LOG_ERROR(LogSubsystem::STORAGE, "批量写入认证日志失败: " << mysql_error(mysql));
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+// 批量记录登录人脸记录（登录图像不落盘，只记录时间）
+bool DBManager::insertLoginRecords(const std::vector<LoginRecord>& records) {
+    static LatencyHistogram& latency = dbLatency("insertLoginRecords");
+    ScopedLatency timer(latency);
+    if (records.empty()) {
+        return true;
+    }
+    
+    if (!connected_) {
+        LOG_ERROR(LogSubsystem::STORAGE, "未连接到数据库");
+        return false;
+    }
+    
+    PooledConnection conn(pool_);
+    if (!conn) {
+        return false;
+    }
+    return insertLoginRecords(conn, records);
+}
+
+bool DBManager::insertLoginRecords(PooledConnection& conn, const std::vector<LoginRecord>& records) {
+    MYSQL* mysql = conn.get();
+    
+    for (size_t begin = 0; begin < records.size(); begin += BATCH_INSERT_ROWS) {
+        size_t end = std::min(records.size(), begin + BATCH_INSERT_ROWS);
+        std::string query = "INSERT INTO face_images (user_id, file_path, type, created_at) VALUES ";
+        for (size_t i = begin; i < end; ++i) {
+            if (i > begin) {
+                query += ",";
+            }
+            query += "(" + std::to_string(records[i].user_id) + ",'LOGIN_IMAGE_NOT_SAVED','login'," +
+                     quoteString(mysql, records[i].created_at) + ")";
+        }
+        
+        if (mysql_real_query(mysql, query.c_str(), query.size())) {
+            conn.checkError(mysql_errno(mysql));
+            LOG_ERROR(LogSubsystem::STORAGE, "批量写入登录记录失败: " << mysql_error(mysql));
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+// 批量更新最后登录时间（UPDATE ... CASE）
+bool DBManager::updateLastLogins(const std::map<int, std::string>& last_logins) {
+    static LatencyHistogram& latency = dbLatency("updateLastLogins");
+    ScopedLatency timer(latency);
+    if (last_logins.empty()) {
+        return true;
+    }
+    
+    if (!connected_) {
+        LOG_ERROR(LogSubsystem::STORAGE, "未连接到数据库");
+        return false;
+    }
+    
+    PooledConnection conn(pool_);
+    if (!conn) {
+        return false;
+    }
+    return updateLastLogins(conn, last_logins);
+}
+
+bool DBManager::updateLastLogins(PooledConnection& conn, const std::map<int, std::string>& last_logins) {
+    MYSQL* mysql = conn.get();
+    
+    auto it = last_logins.begin();
+    while (it != last_logins.end()) {
+        std::string cases;
+        std::string ids;
+        for (size_t rows = 0; it != last_logins.end() && rows < BATCH_INSERT_ROWS; ++it, ++rows) {
+            cases += " WHEN " + std::to_string(it->first) + " THEN " + quoteString(mysql, it->second);
+            if (!ids.empty()) {
+                ids += ",";
+            }
+            ids += std::to_string(it->first);
+        }
+        
+        std::string query = "UPDATE users SET last_login = CASE id" + cases + " END WHERE id IN (" + ids + ")";
+        
+        if (mysql_real_query(mysql, query.c_str(), query.size())) {
+            conn.checkError(mysql_errno(mysql));
+            LOG_ERROR(LogSubsystem::STORAGE, "批量更新最后登录时间失败: " << mysql_error(mysql));
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+// 在一个事务内写入预写日志段并推进检查点；检查点已不小于该段序号时跳过，崩溃后重放不会重复写入
+bool DBManager::applyAuthEventBatch(const std::string& source, uint64_t sequence,
+                                    const std::vector<AuthLogEntry>& logs,
+                                    const std::vector<LoginRecord>& logins,
+                                    const std::map<int, std::string>& last_logins) {
+    static LatencyHistogram& latency = dbLatency("applyAuthEventBatch");
+    ScopedLatency timer(latency);
+    if (!connected_) {
+        LOG_ERROR(LogSubsystem::STORAGE, "未连接到数据库");
+        return false;
+    }
+    
+    PooledConnection conn(pool_);
+    if (!conn) {
+        return false;
+    }
+    MYSQL* mysql = conn.get();
+    
+    if (mysql_query(mysql, "START TRANSACTION")) {
+        conn.checkError(mysql_errno(mysql));
+        LOG_ERROR(LogSubsystem::STORAGE, "无法开始事务: " << mysql_error(mysql));
+        return false;
+    }
+    
+    // 锁定检查点行，多个加载线程使用同一来源时串行执行
+    uint64_t checkpoint = 0;
+    bool ok = getAuthEventCheckpoint(conn, source, checkpoint, true);
+    if (ok && checkpoint >= sequence) {
+        mysql_query(mysql, "ROLLBACK");
+        return true;
+    }
+    
+    ok = ok && insertAuthLogs(conn, logs) && insertLoginRecords(conn, logins) &&
+         updateLastLogins(conn, last_logins);
+    
+    if (ok) {
+        std::string query = "INSERT INTO wal_checkpoint (source, sequence, updated_at) VALUES (" +
+                            quoteString(mysql, source) + "," + std::to_string(sequence) + ",NOW()) "
+                            "ON DUPLICATE KEY UPDATE sequence = VALUES(sequence), updated_at = VALUES(updated_at)";
+        if (mysql_real_query(mysql, query.c_str(), query.size())) {
+            conn.checkError(mysql_errno(mysql));
+            LOG_ERROR(LogSubsystem::STORAGE, "更新预写日志检查点失败: " << mysql_error(mysql));
+            ok = false;
+        }
+    }
+    
+    if (ok && mysql_query(mysql, "COMMIT")) {
+        conn.checkError(mysql_errno(mysql));
+        LOG_ERROR(LogSubsystem::STORAGE, "提交事务失败: " << mysql_error(mysql));
+        ok = false;
+    }
+    if (!ok) {
+        mysql_query(mysql, "ROLLBACK");
+    }
+    return ok;
+}
+
+bool DBManager::getAuthEventCheckpoint(const std::string& source, uint64_t& sequence) {
+    static LatencyHistogram& latency = dbLatency("getAuthEventCheckpoint");
+    ScopedLatency timer(latency);
+    sequence = 0;
+    if (!connected_) {
+        LOG_ERROR(LogSubsystem::STORAGE, "未连接到数据库");
+        return false;
+    }
+    
+    PooledConnection conn(pool_);
+    if (!conn) {
+        return false;
+    }
+    return getAuthEventCheckpoint(conn, source, sequence, false);
+}
+
+bool DBManager::getAuthEventCheckpoint(PooledConnection& conn, const std::string& source,
+                                       uint64_t& sequence, bool for_update) {
+    MYSQL* mysql = conn.get();
+    sequence = 0;
+    
+    std::string query = "SELECT sequence FROM wal_checkpoint WHERE source = " + quoteString(mysql, source);
+    if (for_update) {
+        query += " FOR UPDATE";
+    }
+    if (mysql_real_query(mysql, query.c_str(), query.size())) {
+        conn.checkError(mysql_errno(mysql));
+        LOG_ERROR(LogSubsystem::STORAGE, "查询预写日志检查点失败: " << mysql_error(mysql));
+        return false;
+    }
+    
+    MYSQL_RES* result = mysql_store_result(mysql);
+    if (!result) {
+        LOG_ERROR(LogSubsystem::STORAGE, "获取预写日志检查点失败: " << mysql_error(mysql));
+        return false;
+    }
+    MYSQL_ROW row = mysql_fetch_row(result);
+    if (row && row[0]) {
+        sequence = std::strtoull(row[0], nullptr, 10);
+    }
+    mysql_free_result(result);
+    return true;
+}
+
+DBStatementStats DBManager::getStatementStats() const {
+    return pool_.getStatementStats();
+}
+
 std::string DBManager::getUserPassword(int user_id) {
-    if (!mysql_) {
-        std::cerr << "数据库连接未建立." << std::endl;
+    static LatencyHistogram& latency = dbLatency("getUserPassword");
+    ScopedLatency timer(latency);
+    if (!connected_) {
+        LOG_ERROR(LogSubsystem::STORAGE, "数据库连接未建立.");
+        return "";
+    }
+
+    PooledConnection conn(pool_);
+    if (!conn) {
         return "";
     }
+    MYSQL* mysql = conn.get();
 
     // 准备SQL查询
     std::string query = "SELECT password FROM users WHERE id = " + std::to_string(user_id);
     
-    if (mysql_query(mysql_, query.c_str())) {
-        std::cerr << "查询错误 in getUserPassword: " << mysql_error(mysql_) << std::endl;
+    if (mysql_query(mysql, query.c_str())) {
+        conn.checkError(mysql_errno(mysql));
+        LOG_ERROR(LogSubsystem::STORAGE, "查询错误 in getUserPassword: " << mysql_error(mysql));
         return "";
     }
     
-    MYSQL_RES* result = mysql_store_result(mysql_);
+    MYSQL_RES* result = mysql_store_result(mysql);
     if (!result) {
-        std::cerr << "结果错误 in getUserPassword: " << mysql_error(mysql_) << std::endl;
+        LOG_ERROR(LogSubsystem::STORAGE, "结果错误 in getUserPassword: " << mysql_error(mysql));
         return "";
     }
     
@@ -752,7 +1190,7 @@ std::string DBManager::getUserPassword(int user_id) {
     if (row) {
         password = row[0] ? row[0] : "";
     } else {
-        std::cerr << "未找到用户 ID: " << user_id << std::endl;
+        LOG_ERROR(LogSubsystem::STORAGE, "未找到用户 ID: " << user_id);
     }
     
     mysql_free_result(result);
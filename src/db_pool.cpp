@@ -0,0 +1,325 @@
+#include "db_pool.h"
+#include "logger.h"
+#include <mysql/errmsg.h>
+#include <cstring>
+#include <sys/stat.h>
+
+namespace {
+
+// 使用MySQL API的每个线程都需要线程级初始化，线程退出时释放
+struct MySQLThreadGuard {
+    MySQLThreadGuard() {
+        mysql_thread_init();
+    }
+    ~MySQLThreadGuard() {
+        mysql_thread_end();
+    }
+};
+
+void ensureThreadInit() {
+    thread_local MySQLThreadGuard guard;
+    (void)guard;
+}
+
+// 依次尝试的本地socket路径
+const char* const SOCKET_PATHS[] = {
+    "/tmp/mysql.sock",
+    "/var/lib/mysql/mysql.sock",
+    "/var/run/mysqld/mysqld.sock"
+};
+
+} // namespace
+
+DBConnectionPool::DBConnectionPool()
+    : running_(false), borrowed_(0), prepares_(0), executes_(0), cache_hits_(0) {
+}
+
+DBConnectionPool::~DBConnectionPool() {
+    shutdown();
+}
+
+bool DBConnectionPool::initialize(const DBConfig& config) {
+    shutdown();
+
+    // 多线程环境下必须在创建连接前显式初始化客户端库
+    static std::once_flag library_once;
+    std::call_once(library_once, []() { mysql_library_init(0, nullptr, nullptr); });
+    ensureThreadInit();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    // 借出的连接在归还时才关闭，此时释放连接对象会导致归还时访问已释放的内存
+    if (borrowed_ > 0) {
+        LOG_ERROR(LogSubsystem::STORAGE, "仍有 " << borrowed_ << " 个数据库连接未归还，无法重新初始化连接池");
+        return false;
+    }
+    config_ = config;
+    connections_.clear();
+    if (config_.pool_size == 0) {
+        config_.pool_size = 1;
+    }
+
+    for (size_t i = 0; i < config_.pool_size; ++i) {
+        std::unique_ptr<DBConnection> conn(new DBConnection());
+        if (!openConnection(*conn)) {
+            LOG_ERROR(LogSubsystem::STORAGE, "无法建立连接池中的第 " << (i + 1) << " 个连接");
+            for (auto& c : connections_) {
+                closeConnection(*c);
+            }
+            idle_.clear();
+            connections_.clear();
+            return false;
+        }
+        idle_.push_back(conn.get());
+        connections_.push_back(std::move(conn));
+    }
+
+    running_ = true;
+    LOG_INFO(LogSubsystem::STORAGE, "数据库连接池已建立，连接数: " << config_.pool_size);
+    return true;
+}
+
+void DBConnectionPool::shutdown() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!running_) {
+        return;
+    }
+    running_ = false;
+
+    // 关闭空闲连接；仍被借出的连接在归还时关闭
+    for (DBConnection* conn : idle_) {
+        closeConnection(*conn);
+    }
+    idle_.clear();
+    available_.notify_all();
+    LOG_INFO(LogSubsystem::STORAGE, "数据库连接池已关闭");
+}
+
+DBConnection* DBConnectionPool::acquire() {
+    ensureThreadInit();
+
+    DBConnection* conn = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        bool ok = available_.wait_for(lock, std::chrono::milliseconds(config_.checkout_timeout_ms),
+            [this]() { return !running_ || !idle_.empty(); });
+        if (!ok || !running_) {
+            LOG_ERROR(LogSubsystem::STORAGE, (running_ ? "等待数据库连接超时" : "数据库连接池未运行"));
+            return nullptr;
+        }
+        conn = idle_.back();
+        idle_.pop_back();
+        borrowed_++;
+    }
+
+    // 健康检查与重连在锁外进行，不阻塞其他线程借还连接
+    if (!ensureHealthy(*conn)) {
+        release(conn);
+        return nullptr;
+    }
+    return conn;
+}
+
+void DBConnectionPool::release(DBConnection* conn) {
+    if (!conn) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    borrowed_--;
+    if (!running_) {
+        closeConnection(*conn);
+        return;
+    }
+    conn->last_used = std::chrono::steady_clock::now();
+    idle_.push_back(conn);
+    available_.notify_one();
+}
+
+MYSQL_STMT* DBConnectionPool::prepare(DBConnection& conn, const char* sql) {
+    auto it = conn.statements.find(sql);
+    if (it != conn.statements.end()) {
+        cache_hits_++;
+        return it->second;
+    }
+
+    MYSQL_STMT* stmt = mysql_stmt_init(conn.mysql);
+    if (!stmt) {
+        LOG_ERROR(LogSubsystem::STORAGE, "无法初始化语句: " << mysql_error(conn.mysql));
+        return nullptr;
+    }
+
+    if (mysql_stmt_prepare(stmt, sql, strlen(sql))) {
+        LOG_ERROR(LogSubsystem::STORAGE, "无法准备语句: " << mysql_stmt_error(stmt));
+        if (isConnectionError(mysql_stmt_errno(stmt))) {
+            conn.broken = true;
+        }
+        mysql_stmt_close(stmt);
+        return nullptr;
+    }
+
+    prepares_++;
+    conn.statements[sql] = stmt;
+    return stmt;
+}
+
+bool DBConnectionPool::execute(DBConnection& conn, MYSQL_STMT* stmt) {
+    executes_++;
+    if (mysql_stmt_execute(stmt)) {
+        if (isConnectionError(mysql_stmt_errno(stmt))) {
+            conn.broken = true;
+        }
+        return false;
+    }
+    return true;
+}
+
+DBStatementStats DBConnectionPool::getStatementStats() const {
+    DBStatementStats stats;
+    stats.prepares = prepares_.load();
+    stats.executes = executes_.load();
+    stats.cache_hits = cache_hits_.load();
+    return stats;
+}
+
+bool DBConnectionPool::isConnectionError(unsigned int error_code) {
+    return error_code == CR_SERVER_GONE_ERROR || error_code == CR_SERVER_LOST;
+}
+
+bool DBConnectionPool::isRunning() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return running_;
+}
+
+bool DBConnectionPool::ensureHealthy(DBConnection& conn) {
+    if (!conn.broken) {
+        auto idle = std::chrono::steady_clock::now() - conn.last_used;
+        if (idle < std::chrono::seconds(config_.health_check_interval)) {
+            return true;
+        }
+        if (mysql_ping(conn.mysql) == 0) {
+            return true;
+        }
+        LOG_ERROR(LogSubsystem::STORAGE, "数据库连接健康检查失败: " << mysql_error(conn.mysql));
+    }
+
+    // 重连
+    closeConnection(conn);
+    if (!openConnection(conn)) {
+        LOG_ERROR(LogSubsystem::STORAGE, "数据库重连失败");
+        return false;
+    }
+    LOG_INFO(LogSubsystem::STORAGE, "数据库连接已重新建立");
+    return true;
+}
+
+bool DBConnectionPool::openConnection(DBConnection& conn) {
+    conn.mysql = mysql_init(nullptr);
+    if (!conn.mysql) {
+        LOG_ERROR(LogSubsystem::STORAGE, "初始化MySQL失败");
+        return false;
+    }
+
+    unsigned int timeout = static_cast<unsigned int>(config_.connect_timeout);
+    mysql_options(conn.mysql, MYSQL_OPT_CONNECT_TIMEOUT, &timeout);
+    mysql_options(conn.mysql, MYSQL_SET_CHARSET_NAME, "utf8mb4");
+
+    const std::string& user = config_.user;
+    const std::string& password = config_.password;
+    const std::string& database = config_.database;
+    bool connected = false;
+
+    // 先尝试通过socket连接到指定数据库
+    for (const char* socket_path : SOCKET_PATHS) {
+        struct stat buf;
+        if (stat(socket_path, &buf) == 0) {
+            if (mysql_real_connect(conn.mysql, NULL, user.c_str(), password.c_str(),
+                                   database.c_str(), 0, socket_path, 0)) {
+                connected = true;
+                break;
+            }
+            LOG_WARN(LogSubsystem::STORAGE, "通过socket " << socket_path << " 连接失败: " << mysql_error(conn.mysql));
+        }
+    }
+
+    // 如果连接失败，尝试连接到服务器并创建数据库
+    if (!connected) {
+        for (const char* socket_path : SOCKET_PATHS) {
+            struct stat buf;
+            if (stat(socket_path, &buf) == 0) {
+                if (mysql_real_connect(conn.mysql, NULL, user.c_str(), password.c_str(),
+                                       NULL, 0, socket_path, 0)) {
+                    LOG_INFO(LogSubsystem::STORAGE, "通过socket " << socket_path << " 连接到服务器成功");
+
+                    // 创建数据库
+                    std::string query = "CREATE DATABASE IF NOT EXISTS `" + database + "`";
+                    if (mysql_query(conn.mysql, query.c_str())) {
+                        LOG_ERROR(LogSubsystem::STORAGE, "无法创建数据库: " << mysql_error(conn.mysql));
+                        closeConnection(conn);
+                        return false;
+                    }
+
+                    // 使用新创建的数据库
+                    if (mysql_select_db(conn.mysql, database.c_str())) {
+                        LOG_ERROR(LogSubsystem::STORAGE, "无法选择数据库: " << mysql_error(conn.mysql));
+                        closeConnection(conn);
+                        return false;
+                    }
+
+                    connected = true;
+                    break;
+                }
+                LOG_WARN(LogSubsystem::STORAGE, "通过socket " << socket_path << " 连接到服务器失败: " << mysql_error(conn.mysql));
+            }
+        }
+    }
+
+    // 如果仍然连接失败，尝试TCP/IP连接
+    if (!connected) {
+        if (!mysql_real_connect(conn.mysql, config_.host.c_str(), user.c_str(), password.c_str(),
+                                database.c_str(), 0, nullptr, 0)) {
+            LOG_ERROR(LogSubsystem::STORAGE, "TCP/IP连接失败: " << mysql_error(conn.mysql));
+            closeConnection(conn);
+            return false;
+        }
+    }
+
+    conn.broken = false;
+    conn.last_used = std::chrono::steady_clock::now();
+    return true;
+}
+
+void DBConnectionPool::closeConnection(DBConnection& conn) {
+    // 预处理语句与连接绑定，重连后需要重新准备
+    for (auto& pair : conn.statements) {
+        mysql_stmt_close(pair.second);
+    }
+    conn.statements.clear();
+
+    if (conn.mysql) {
+        mysql_close(conn.mysql);
+        conn.mysql = nullptr;
+    }
+    conn.broken = true;
+}
+
+PooledConnection::PooledConnection(DBConnectionPool& pool)
+    : pool_(pool), conn_(pool.acquire()) {
+}
+
+PooledConnection::~PooledConnection() {
+    pool_.release(conn_);
+}
+
+MYSQL_STMT* PooledConnection::prepare(const char* sql) {
+    return conn_ ? pool_.prepare(*conn_, sql) : nullptr;
+}
+
+bool PooledConnection::execute(MYSQL_STMT* stmt) {
+    return conn_ && pool_.execute(*conn_, stmt);
+}
+
+void PooledConnection::checkError(unsigned int error_code) {
+    if (conn_ && DBConnectionPool::isConnectionError(error_code)) {
+        conn_->broken = true;
+    }
+}
@@ -0,0 +1,230 @@
+#include "enrollment_trainer.h"
+#include "logger.h"
+#include <algorithm>
+#include <chrono>
+
+EnrollmentTrainer::EnrollmentTrainer()
+    : recognizer_(nullptr),
+      storage_(nullptr),
+      next_sequence_(0),
+      running_(false),
+      enqueued_(0),
+      trained_(0),
+      failed_(0),
+      batches_(0),
+      reconciled_(0) {
+}
+
+EnrollmentTrainer::~EnrollmentTrainer() {
+    stop();
+}
+
+bool EnrollmentTrainer::start(FaceRecognizer& recognizer, Storage& storage, const EnrollmentTrainerConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+        return true;
+    }
+
+    recognizer_ = &recognizer;
+    storage_ = &storage;
+    config_ = config;
+    if (config_.batch_size == 0) {
+        config_.batch_size = 1;
+    }
+
+    running_ = true;
+    thread_ = std::thread(&EnrollmentTrainer::run, this);
+
+    LOG_INFO(LogSubsystem::FACE, "注册训练线程已启动，批大小: " << config_.batch_size
+              << ", 刷新间隔: " << config_.flush_interval_ms << "ms"
+              << ", 启动补训: " << (config_.reconcile_on_start ? "开启" : "关闭"));
+    return true;
+}
+
+void EnrollmentTrainer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    not_empty_.notify_all();
+
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    LOG_INFO(LogSubsystem::FACE, "注册训练线程已停止，训练: " << trained_.load()
+              << ", 失败: " << failed_.load()
+              << ", 批次: " << batches_.load()
+              << ", 补训用户: " << reconciled_.load());
+}
+
+void EnrollmentTrainer::enqueue(int user_id, const cv::Mat& face) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    Job job;
+    job.user_id = user_id;
+    job.face = face;
+    job.sequence = ++next_sequence_;
+
+    UserState& state = states_[user_id];
+    state.queued = job.sequence;
+    state.failed = false;
+    enqueued_++;
+
+    if (!running_) {
+        // 训练线程未运行（未启动或已停止），直接训练
+        lock.unlock();
+        std::vector<Job> batch;
+        batch.push_back(job);
+        trainBatch(batch);
+        return;
+    }
+
+    queue_.push_back(job);
+    // 攒够一批再唤醒训练线程，否则等待刷新间隔
+    if (queue_.size() >= config_.batch_size) {
+        not_empty_.notify_one();
+    }
+}
+
+EnrollmentStatus EnrollmentTrainer::status(int user_id) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = states_.find(user_id);
+        if (it != states_.end()) {
+            const UserState& state = it->second;
+            if (state.done < state.queued) {
+                return EnrollmentStatus::PENDING;
+            }
+            return state.failed ? EnrollmentStatus::FAILED : EnrollmentStatus::LIVE;
+        }
+    }
+
+    // 本次启动后没有入队过：以模型中是否已有该用户为准
+    if (recognizer_ && recognizer_->hasUser(user_id)) {
+        return EnrollmentStatus::LIVE;
+    }
+    return EnrollmentStatus::UNKNOWN;
+}
+
+const char* EnrollmentTrainer::statusName(EnrollmentStatus status) {
+    switch (status) {
+    case EnrollmentStatus::PENDING:
+        return "pending";
+    case EnrollmentStatus::LIVE:
+        return "live";
+    case EnrollmentStatus::FAILED:
+        return "failed";
+    default:
+        return "unknown";
+    }
+}
+
+EnrollmentTrainerStats EnrollmentTrainer::getStats() const {
+    EnrollmentTrainerStats stats;
+    stats.enqueued = enqueued_.load();
+    stats.trained = trained_.load();
+    stats.failed = failed_.load();
+    stats.batches = batches_.load();
+    stats.reconciled = reconciled_.load();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.pending = queue_.size();
+    }
+    return stats;
+}
+
+void EnrollmentTrainer::run() {
+    if (config_.reconcile_on_start) {
+        reconcile();
+    }
+
+    std::vector<Job> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_empty_.wait_for(lock, std::chrono::milliseconds(config_.flush_interval_ms),
+                [this]() { return !running_ || queue_.size() >= config_.batch_size; });
+
+            if (queue_.empty()) {
+                if (!running_) {
+                    break;
+                }
+                continue;
+            }
+
+            size_t count = std::min(queue_.size(), config_.batch_size);
+            for (size_t i = 0; i < count; ++i) {
+                batch.push_back(queue_.front());
+                queue_.pop_front();
+            }
+        }
+
+        trainBatch(batch);
+        batch.clear();
+    }
+}
+
+void EnrollmentTrainer::reconcile() {
+    std::vector<int> trained = recognizer_->userIds();
+    std::sort(trained.begin(), trained.end());
+
+    // 遍历时只收集路径，读取图像在遍历结束后进行（visitor不应长时间阻塞）
+    std::vector<std::pair<int, std::string>> missing;
+    bool ok = storage_->forEachUser([&](const UserInfo& user) {
+        if (isNormalizedFacePath(user.file_path) &&
+            !std::binary_search(trained.begin(), trained.end(), user.id)) {
+            missing.push_back(std::make_pair(user.id, user.file_path));
+        }
+        return true;
+    });
+    if (!ok) {
+        LOG_ERROR(LogSubsystem::FACE, "注册训练补训失败：无法读取用户列表");
+        return;
+    }
+
+    // 旧数据只有原始图像，需要人脸检测，仍由登录时的训练处理
+    for (const auto& entry : missing) {
+        cv::Mat face = cv::imread(entry.second, cv::IMREAD_GRAYSCALE);
+        if (face.empty()) {
+            LOG_ERROR(LogSubsystem::FACE, "补训时无法读取用户 " << entry.first << " 的注册人脸: " << entry.second);
+            continue;
+        }
+        enqueue(entry.first, face);
+        reconciled_++;
+    }
+
+    if (!missing.empty()) {
+        LOG_INFO(LogSubsystem::FACE, "注册训练补训: " << reconciled_.load() << " 个用户已入队");
+    }
+}
+
+void EnrollmentTrainer::trainBatch(std::vector<Job>& batch) {
+    if (batch.empty()) {
+        return;
+    }
+
+    std::vector<std::pair<int, cv::Mat>> samples;
+    samples.reserve(batch.size());
+    for (const Job& job : batch) {
+        samples.push_back(std::make_pair(job.user_id, job.face));
+    }
+
+    std::vector<bool> trained;
+    size_t count = recognizer_ ? recognizer_->trainBatch(samples, trained) : 0;
+    trained.resize(batch.size(), false);
+    batches_++;
+    trained_ += count;
+    failed_ += batch.size() - count;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < batch.size(); ++i) {
+        UserState& state = states_[batch[i].user_id];
+        state.done = std::max(state.done, batch[i].sequence);
+        if (!trained[i] && batch[i].sequence == state.queued) {
+            state.failed = true;
+        }
+    }
+}
@@ -0,0 +1,159 @@
+#include "executor.h"
+#include "logger.h"
+#include <algorithm>
+
+namespace {
+
+uint64_t elapsedMicros(std::chrono::steady_clock::time_point start,
+                       std::chrono::steady_clock::time_point end) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+}
+
+} // namespace
+
+Executor::Executor(const std::string& name)
+    : name_(name),
+      running_(false),
+      max_queue_depth_(0),
+      submitted_(0),
+      completed_(0),
+      blocked_(0),
+      active_(0),
+      wait_us_(0),
+      run_us_(0) {
+}
+
+Executor::~Executor() {
+    stop();
+}
+
+bool Executor::start(const ExecutorConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+        return true;
+    }
+
+    config_ = config;
+    if (config_.threads == 0) {
+        config_.threads = 1;
+    }
+    if (config_.queue_size == 0) {
+        config_.queue_size = 1;
+    }
+
+    running_ = true;
+    for (size_t i = 0; i < config_.threads; ++i) {
+        threads_.push_back(std::thread(&Executor::run, this));
+    }
+
+    LOG_INFO(LogSubsystem::SERVER, "线程池 " << name_ << " 已启动，线程数: " << config_.threads
+              << ", 队列容量: " << config_.queue_size);
+    return true;
+}
+
+void Executor::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    not_empty_.notify_all();
+    not_full_.notify_all();
+
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    threads_.clear();
+
+    ExecutorStats stats = getStats();
+    LOG_INFO(LogSubsystem::SERVER, "线程池 " << name_ << " 已停止，完成任务: " << stats.completed
+              << ", 队列峰值: " << stats.max_queue_depth
+              << ", 平均排队: " << static_cast<long>(stats.avg_wait_us) << "us"
+              << ", 平均执行: " << static_cast<long>(stats.avg_run_us) << "us");
+}
+
+void Executor::post(std::function<void()> task) {
+    Task item;
+    item.func = std::move(task);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    submitted_++;
+    if (running_ && queue_.size() >= config_.queue_size) {
+        blocked_++;
+        not_full_.wait(lock, [this]() { return !running_ || queue_.size() < config_.queue_size; });
+    }
+    if (!running_) {
+        // 线程池未运行（未启动或已停止，包括等待队列空位期间被停止），在提交线程上直接执行
+        lock.unlock();
+        item.enqueued = std::chrono::steady_clock::now();
+        execute(item);
+        return;
+    }
+
+    item.enqueued = std::chrono::steady_clock::now();
+    queue_.push_back(std::move(item));
+    max_queue_depth_ = std::max(max_queue_depth_, queue_.size());
+    not_empty_.notify_one();
+}
+
+bool Executor::isRunning() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return running_;
+}
+
+ExecutorStats Executor::getStats() const {
+    ExecutorStats stats;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.threads = threads_.size();
+        stats.queue_depth = queue_.size();
+        stats.max_queue_depth = max_queue_depth_;
+    }
+    stats.submitted = submitted_.load();
+    stats.completed = completed_.load();
+    stats.blocked = blocked_.load();
+    stats.active = active_.load();
+    stats.avg_wait_us = stats.completed ? static_cast<double>(wait_us_.load()) / stats.completed : 0.0;
+    stats.avg_run_us = stats.completed ? static_cast<double>(run_us_.load()) / stats.completed : 0.0;
+    return stats;
+}
+
+void Executor::run() {
+    while (true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_empty_.wait(lock, [this]() { return !running_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            task = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        not_full_.notify_one();
+        execute(task);
+    }
+}
+
+void Executor::execute(Task& task) {
+    auto start = std::chrono::steady_clock::now();
+    wait_us_ += elapsedMicros(task.enqueued, start);
+    active_++;
+
+    try {
+        task.func();
+    } catch (const std::exception& e) {
+        LOG_ERROR(LogSubsystem::SERVER, "线程池 " << name_ << " 任务异常: " << e.what());
+    } catch (...) {
+        LOG_ERROR(LogSubsystem::SERVER, "线程池 " << name_ << " 任务异常");
+    }
+
+    active_--;
+    run_us_ += elapsedMicros(start, std::chrono::steady_clock::now());
+    completed_++;
+}
@@ -1,5 +1,5 @@
 #include "face_detector.h"
-#include <iostream>
+#include "logger.h"
 
 FaceDetector::FaceDetector() : initialized_(false) {
 }
@@ -10,7 +10,7 @@ FaceDetector::~FaceDetector() {
 bool FaceDetector::initialize(const std::string& face_cascade_path) {
     // 加载人脸分类器
     if (!face_cascade_.load(face_cascade_path)) {
-        std::cerr << "Error: 无法加载人脸分类器: " << face_cascade_path << std::endl;
+        LOG_ERROR(LogSubsystem::FACE, "无法加载人脸分类器: " << face_cascade_path);
         return false;
     }
     
@@ -20,7 +20,7 @@ bool FaceDetector::initialize(const std::string& face_cascade_path) {
 
 std::vector<cv::Rect> FaceDetector::detectFaces(const cv::Mat& image) {
     if (!initialized_) {
-        std::cerr << "Error: 人脸检测器未初始化" << std::endl;
+        LOG_ERROR(LogSubsystem::FACE, "人脸检测器未初始化");
         return std::vector<cv::Rect>();
     }
     
@@ -1,10 +1,10 @@
 #include "face_recognizer.h"
-#include <iostream>
+#include "logger.h"
 #include <fstream>
 #include <sys/stat.h>
 #include <sys/types.h>
 
-FaceRecognizer::FaceRecognizer() : initialized_(false) {
+FaceRecognizer::FaceRecognizer() : initialized_(false), persistent_(true) {
 }
 
 FaceRecognizer::~FaceRecognizer() {
@@ -27,25 +27,27 @@ bool FaceRecognizer::initialize() {
         );
         
         // 尝试加载已有模型
-        if (!loadModel()) {
+        if (!persistent_) {
+            LOG_INFO(LogSubsystem::FACE, "模型持久化已关闭，使用空的LBPH模型");
+        } else if (!loadModel()) {
             // 如果不存在已有模型，则创建新模型
-            std::cout << "未找到现有模型，创建新的LBPH模型" << std::endl;
+            LOG_INFO(LogSubsystem::FACE, "未找到现有模型，创建新的LBPH模型");
         } else {
-            std::cout << "成功加载现有LBPH模型" << std::endl;
+            LOG_INFO(LogSubsystem::FACE, "成功加载现有LBPH模型");
         }
         
         initialized_ = true;
-        std::cout << "LBPH人脸识别器初始化成功，使用增强参数配置" << std::endl;
+        LOG_INFO(LogSubsystem::FACE, "LBPH人脸识别器初始化成功，使用增强参数配置");
         return true;
     } catch (const cv::Exception& e) {
-        std::cerr << "初始化人脸识别器失败: " << e.what() << std::endl;
+        LOG_ERROR(LogSubsystem::FACE, "初始化人脸识别器失败: " << e.what());
         return false;
     }
 }
 
 double FaceRecognizer::compareFaces(const cv::Mat& face1, const cv::Mat& face2) {
     if (!initialized_) {
-        std::cerr << "错误: 人脸识别器未初始化" << std::endl;
+        LOG_ERROR(LogSubsystem::FACE, "人脸识别器未初始化");
         return 9999.0; // 返回一个很大的值表示不相似
     }
     
@@ -55,31 +57,24 @@ double FaceRecognizer::compareFaces(const cv::Mat& face1, const cv::Mat& face2)
         cv::Mat processed_face2 = preprocessFace(face2);
         
         if (processed_face1.empty() || processed_face2.empty()) {
-            std::cerr << "错误: 无法预处理人脸用于比较" << std::endl;
+            LOG_ERROR(LogSubsystem::FACE, "无法预处理人脸用于比较");
             return 9999.0;
         }
         
         // 方法1：使用现有模型进行比较
-        // 将face1临时添加到训练数据中，并标记为一个特殊ID
+        // 以当前训练集加上face1（标记为一个特殊ID）训练临时模型；
+        // 只在锁内复制训练集（Mat为引用计数，不复制像素），不修改共享的训练数据
         const int temp_id = -999; // 使用不太可能与实际用户ID冲突的值
         
-        // 备份当前训练数据和模型
-        std::map<int, std::vector<cv::Mat>> backup_training_faces = training_faces_;
-        
-        // 临时添加人脸到训练集
-        training_faces_[temp_id].push_back(processed_face1);
-        
         // 准备训练数据
         std::vector<cv::Mat> faces;
         std::vector<int> labels;
-        
-        for (const auto& pair : training_faces_) {
-            int id = pair.first;
-            for (const auto& f : pair.second) {
-                faces.push_back(f);
-                labels.push_back(id);
-            }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            collectTrainingData(faces, labels);
         }
+        faces.push_back(processed_face1);
+        labels.push_back(temp_id);
         
         // 在当前LBPH模型上临时训练
         cv::Ptr<cv::face::LBPHFaceRecognizer> temp_model = cv::face::LBPHFaceRecognizer::create();
@@ -90,26 +85,23 @@ double FaceRecognizer::compareFaces(const cv::Mat& face1, const cv::Mat& face2)
         double confidence = 0.0;
         temp_model->predict(processed_face2, label, confidence);
         
-        // 恢复原始训练数据
-        training_faces_ = backup_training_faces;
-        
         // 返回置信度作为相似度度量（值越低越相似）
         return confidence;
     } catch (const cv::Exception& e) {
-        std::cerr << "错误: 比较人脸失败: " << e.what() << std::endl;
+        LOG_ERROR(LogSubsystem::FACE, "比较人脸失败: " << e.what());
         return 9999.0;
     }
 }
 
 cv::Mat FaceRecognizer::preprocessFace(const cv::Mat& face) {
     if (!initialized_) {
-        std::cerr << "错误: 人脸识别器未初始化" << std::endl;
+        LOG_ERROR(LogSubsystem::FACE, "人脸识别器未初始化");
         return cv::Mat();
     }
     
     try {
         if (face.empty()) {
-            std::cerr << "错误: 输入人脸图像为空" << std::endl;
+            LOG_ERROR(LogSubsystem::FACE, "输入人脸图像为空");
             return cv::Mat();
         }
         
@@ -141,69 +133,143 @@ cv::Mat FaceRecognizer::preprocessFace(const cv::Mat& face) {
         
         return clahe_img;
     } catch (const cv::Exception& e) {
-        std::cerr << "错误: 预处理人脸失败: " << e.what() << std::endl;
+        LOG_ERROR(LogSubsystem::FACE, "预处理人脸失败: " << e.what());
         return cv::Mat();
     }
 }
 
 bool FaceRecognizer::train(int user_id, const cv::Mat& face) {
     if (!initialized_) {
-        std::cerr << "错误: 人脸识别器未初始化" << std::endl;
+        LOG_ERROR(LogSubsystem::FACE, "人脸识别器未初始化");
         return false;
     }
     
     try {
         cv::Mat processed_face = preprocessFace(face);
         if (processed_face.empty()) {
-            std::cerr << "错误: 无法预处理人脸用于训练" << std::endl;
+            LOG_ERROR(LogSubsystem::FACE, "无法预处理人脸用于训练");
             return false;
         }
         
+        std::lock_guard<std::mutex> lock(mutex_);
+        
         // 添加到训练集
         training_faces_[user_id].push_back(processed_face);
         
         // 准备训练数据
         std::vector<cv::Mat> faces;
         std::vector<int> labels;
-        
-        for (const auto& pair : training_faces_) {
-            int id = pair.first;
-            for (const auto& f : pair.second) {
-                faces.push_back(f);
-                labels.push_back(id);
-            }
-        }
+        collectTrainingData(faces, labels);
         
         // 训练模型
         lbph_model_->train(faces, labels);
         
         // 保存模型
-        saveModel();
+        if (persistent_) {
+            saveModelLocked("face_model.yml");
+        }
         
-        std::cout << "模型训练成功，当前有 " << faces.size() << " 张训练图像" << std::endl;
+        LOG_INFO(LogSubsystem::FACE, "模型训练成功，当前有 " << faces.size() << " 张训练图像");
         return true;
     } catch (const cv::Exception& e) {
-        std::cerr << "错误: 训练模型失败: " << e.what() << std::endl;
+        LOG_ERROR(LogSubsystem::FACE, "训练模型失败: " << e.what());
         return false;
     }
 }
 
+size_t FaceRecognizer::trainBatch(const std::vector<std::pair<int, cv::Mat>>& samples,
+                                  std::vector<bool>& trained) {
+    trained.assign(samples.size(), false);
+    if (!initialized_) {
+        LOG_ERROR(LogSubsystem::FACE, "人脸识别器未初始化");
+        return 0;
+    }
+    
+    // 预处理在锁外进行
+    std::vector<cv::Mat> faces;
+    std::vector<int> labels;
+    std::vector<size_t> indexes;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        cv::Mat processed_face = preprocessFace(samples[i].second);
+        if (processed_face.empty()) {
+            LOG_ERROR(LogSubsystem::FACE, "无法预处理用户 " << samples[i].first << " 的人脸用于训练");
+            continue;
+        }
+        faces.push_back(processed_face);
+        labels.push_back(samples[i].first);
+        indexes.push_back(i);
+    }
+    if (faces.empty()) {
+        return 0;
+    }
+    
+    try {
+        std::lock_guard<std::mutex> lock(mutex_);
+        
+        // 模型已有训练数据时增量更新（只计算新样本的直方图），否则完整训练
+        bool incremental = !training_faces_.empty();
+        for (size_t i = 0; i < faces.size(); ++i) {
+            training_faces_[labels[i]].push_back(faces[i]);
+        }
+        if (incremental) {
+            lbph_model_->update(faces, labels);
+        } else {
+            std::vector<cv::Mat> all_faces;
+            std::vector<int> all_labels;
+            collectTrainingData(all_faces, all_labels);
+            lbph_model_->train(all_faces, all_labels);
+        }
+        
+        // 整批只保存一次模型
+        if (persistent_) {
+            saveModelLocked("face_model.yml");
+        }
+        
+        LOG_INFO(LogSubsystem::FACE, "批量训练完成，新增 " << faces.size() << " 张人脸，当前有 "
+                  << training_faces_.size() << " 个用户");
+        for (size_t index : indexes) {
+            trained[index] = true;
+        }
+        return faces.size();
+    } catch (const cv::Exception& e) {
+        LOG_ERROR(LogSubsystem::FACE, "批量训练模型失败: " << e.what());
+        return 0;
+    }
+}
+
+bool FaceRecognizer::hasUser(int user_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return training_faces_.count(user_id) > 0;
+}
+
+std::vector<int> FaceRecognizer::userIds() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<int> ids;
+    ids.reserve(training_faces_.size());
+    for (const auto& pair : training_faces_) {
+        ids.push_back(pair.first);
+    }
+    return ids;
+}
+
 std::pair<int, double> FaceRecognizer::recognize(const cv::Mat& face) {
     if (!initialized_) {
-        std::cerr << "错误: 人脸识别器未初始化" << std::endl;
+        LOG_ERROR(LogSubsystem::FACE, "人脸识别器未初始化");
         return {-1, 9999.0};
     }
     
     try {
         cv::Mat processed_face = preprocessFace(face);
         if (processed_face.empty()) {
-            std::cerr << "错误: 无法预处理人脸用于识别" << std::endl;
+            LOG_ERROR(LogSubsystem::FACE, "无法预处理人脸用于识别");
             return {-1, 9999.0};
         }
         
+        std::lock_guard<std::mutex> lock(mutex_);
+        
         // 如果模型未训练，返回错误
         if (training_faces_.empty()) {
-            std::cerr << "错误: 没有训练数据可用" << std::endl;
+            LOG_ERROR(LogSubsystem::FACE, "没有训练数据可用");
             return {-1, 9999.0};
         }
         
@@ -214,14 +280,29 @@ std::pair<int, double> FaceRecognizer::recognize(const cv::Mat& face) {
         
         return {label, confidence};
     } catch (const cv::Exception& e) {
-        std::cerr << "错误: 识别人脸失败: " << e.what() << std::endl;
+        LOG_ERROR(LogSubsystem::FACE, "识别人脸失败: " << e.what());
         return {-1, 9999.0};
     }
 }
 
 bool FaceRecognizer::saveModel(const std::string& filename) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return saveModelLocked(filename);
+}
+
+void FaceRecognizer::collectTrainingData(std::vector<cv::Mat>& faces, std::vector<int>& labels) const {
+    for (const auto& pair : training_faces_) {
+        int id = pair.first;
+        for (const auto& f : pair.second) {
+            faces.push_back(f);
+            labels.push_back(id);
+        }
+    }
+}
+
+bool FaceRecognizer::saveModelLocked(const std::string& filename) {
     if (!initialized_ || !lbph_model_) {
-        std::cerr << "错误: 人脸识别器未初始化" << std::endl;
+        LOG_ERROR(LogSubsystem::FACE, "人脸识别器未初始化");
         return false;
     }
     
@@ -232,7 +313,7 @@ bool FaceRecognizer::saveModel(const std::string& filename) {
         if (stat(dir.c_str(), &st) != 0) {
             // 目录不存在，创建它
             if (mkdir(dir.c_str(), 0755) != 0) {
-                std::cerr << "错误: 无法创建目录: " << dir << std::endl;
+                LOG_ERROR(LogSubsystem::FACE, "无法创建目录: " << dir);
                 return false;
             }
         }
@@ -244,7 +325,7 @@ bool FaceRecognizer::saveModel(const std::string& filename) {
         std::string training_data_path = dir + "/training_data.dat";
         std::ofstream ofs(training_data_path, std::ios::binary);
         if (!ofs.is_open()) {
-            std::cerr << "错误: 无法打开文件用于写入: " << training_data_path << std::endl;
+            LOG_ERROR(LogSubsystem::FACE, "无法打开文件用于写入: " << training_data_path);
             return false;
         }
         
@@ -279,20 +360,20 @@ bool FaceRecognizer::saveModel(const std::string& filename) {
         }
         
         ofs.close();
-        std::cout << "保存模型到: " << model_path << std::endl;
+        LOG_INFO(LogSubsystem::FACE, "保存模型到: " << model_path);
         return true;
     } catch (const cv::Exception& e) {
-        std::cerr << "错误: 保存模型失败: " << e.what() << std::endl;
+        LOG_ERROR(LogSubsystem::FACE, "保存模型失败: " << e.what());
         return false;
     } catch (const std::exception& e) {
-        std::cerr << "错误: 保存训练数据失败: " << e.what() << std::endl;
+        LOG_ERROR(LogSubsystem::FACE, "保存训练数据失败: " << e.what());
         return false;
     }
 }
 
 bool FaceRecognizer::loadModel(const std::string& filename) {
     if (!lbph_model_) {
-        std::cerr << "错误: 人脸识别器未初始化" << std::endl;
+        LOG_ERROR(LogSubsystem::FACE, "人脸识别器未初始化");
         return false;
     }
     
@@ -304,24 +385,26 @@ bool FaceRecognizer::loadModel(const std::string& filename) {
         // 检查模型文件是否存在
         struct stat model_st;
         if (stat(model_path.c_str(), &model_st) != 0) {
-            std::cout << "模型文件不存在: " << model_path << std::endl;
+            LOG_INFO(LogSubsystem::FACE, "模型文件不存在: " << model_path);
             return false;
         }
         
         // 检查训练数据文件是否存在
         struct stat training_st;
         if (stat(training_data_path.c_str(), &training_st) != 0) {
-            std::cout << "训练数据文件不存在: " << training_data_path << std::endl;
+            LOG_INFO(LogSubsystem::FACE, "训练数据文件不存在: " << training_data_path);
             return false;
         }
         
+        std::lock_guard<std::mutex> lock(mutex_);
+        
         // 加载模型
         lbph_model_->read(model_path);
         
         // 加载训练数据
         std::ifstream ifs(training_data_path, std::ios::binary);
         if (!ifs.is_open()) {
-            std::cerr << "错误: 无法打开文件用于读取: " << training_data_path << std::endl;
+            LOG_ERROR(LogSubsystem::FACE, "无法打开文件用于读取: " << training_data_path);
             return false;
         }
         
@@ -358,13 +441,13 @@ bool FaceRecognizer::loadModel(const std::string& filename) {
         
         ifs.close();
         
-        std::cout << "加载模型成功，共加载 " << training_faces_.size() << " 个用户的人脸数据" << std::endl;
+        LOG_INFO(LogSubsystem::FACE, "加载模型成功，共加载 " << training_faces_.size() << " 个用户的人脸数据");
         return true;
     } catch (const cv::Exception& e) {
-        std::cerr << "错误: 加载模型失败: " << e.what() << std::endl;
+        LOG_ERROR(LogSubsystem::FACE, "加载模型失败: " << e.what());
         return false;
     } catch (const std::exception& e) {
-        std::cerr << "错误: 加载训练数据失败: " << e.what() << std::endl;
+        LOG_ERROR(LogSubsystem::FACE, "加载训练数据失败: " << e.what());
         return false;
     }
 } 
\ No newline at end of file
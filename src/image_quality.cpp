@@ -0,0 +1,74 @@
+#include "image_quality.h"
+#include <algorithm>
+
+QualityResult checkImageQuality(const cv::Mat& image, const QualityConfig& config, QualityMetrics* metrics) {
+    if (image.cols < config.min_width || image.rows < config.min_height) {
+        return QualityResult::TOO_SMALL;
+    }
+
+    // 先缩小再转灰度，像素数与分辨率无关
+    cv::Mat small;
+    int long_side = std::max(image.cols, image.rows);
+    if (config.analysis_size > 0 && long_side > config.analysis_size) {
+        double scale = static_cast<double>(config.analysis_size) / long_side;
+        cv::resize(image, small, cv::Size(std::max(1, static_cast<int>(image.cols * scale)),
+                                          std::max(1, static_cast<int>(image.rows * scale))),
+                   0, 0, cv::INTER_AREA);
+    } else {
+        small = image;
+    }
+    cv::Mat gray;
+    if (small.channels() > 1) {
+        cv::cvtColor(small, gray, cv::COLOR_BGR2GRAY);
+    } else {
+        gray = small;
+    }
+
+    double brightness = cv::mean(gray)[0];
+    if (metrics) {
+        metrics->brightness = brightness;
+    }
+    if (brightness < config.min_brightness) {
+        return QualityResult::UNDEREXPOSED;
+    }
+    if (brightness > config.max_brightness) {
+        return QualityResult::OVEREXPOSED;
+    }
+
+    // 拉普拉斯响应的方差：边缘越少（越模糊）越小
+    cv::Mat laplacian;
+    cv::Laplacian(gray, laplacian, CV_16S);
+    cv::Scalar mean;
+    cv::Scalar stddev;
+    cv::meanStdDev(laplacian, mean, stddev);
+    double sharpness = stddev[0] * stddev[0];
+    if (metrics) {
+        metrics->sharpness = sharpness;
+    }
+    if (sharpness < config.min_sharpness) {
+        return QualityResult::BLURRY;
+    }
+    return QualityResult::OK;
+}
+
+const char* qualityReason(QualityResult result) {
+    switch (result) {
+        case QualityResult::OK: return "ok";
+        case QualityResult::TOO_SMALL: return "too_small";
+        case QualityResult::UNDEREXPOSED: return "underexposed";
+        case QualityResult::OVEREXPOSED: return "overexposed";
+        case QualityResult::BLURRY: return "blurry";
+    }
+    return "unknown";
+}
+
+const char* qualityMessage(QualityResult result) {
+    switch (result) {
+        case QualityResult::OK: return "图像质量合格";
+        case QualityResult::TOO_SMALL: return "图像分辨率过低";
+        case QualityResult::UNDEREXPOSED: return "图像过暗";
+        case QualityResult::OVEREXPOSED: return "图像过亮";
+        case QualityResult::BLURRY: return "图像模糊";
+    }
+    return "图像质量不合格";
+}
@@ -0,0 +1,455 @@
+#include "logger.h"
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+const char* const LEVEL_NAMES[] = {"trace", "debug", "info", "warn", "error", "off"};
+const char* const LEVEL_LABELS[] = {"TRACE", "DEBUG", "INFO ", "WARN ", "ERROR", "OFF  "};
+const char* const SUBSYSTEM_NAMES[] = {"server", "net", "auth", "face", "storage"};
+
+// 后台线程每轮最多处理的记录数，处理完一轮写出一次
+const size_t DRAIN_BATCH = 256;
+
+// 进程内线程序号，比std::thread::id更短且无需哈希
+uint32_t currentThreadId() {
+    static std::atomic<uint32_t> next_id(0);
+    thread_local uint32_t id = ++next_id;
+    return id;
+}
+
+int64_t nowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+size_t roundUpPowerOfTwo(size_t value) {
+    size_t result = 2;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+// 追加本地时间，格式 2024-01-01 12:00:00.123456
+void appendTimestamp(int64_t timestamp_us, std::string& out) {
+    time_t seconds = static_cast<time_t>(timestamp_us / 1000000);
+    struct tm tm_time;
+    localtime_r(&seconds, &tm_time);
+    char buf[40];
+    size_t n = strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm_time);
+    n += snprintf(buf + n, sizeof(buf) - n, ".%06d", static_cast<int>(timestamp_us % 1000000));
+    out.append(buf, n);
+}
+
+// 按JSON字符串规则转义
+void appendJsonEscaped(const char* data, size_t size, std::string& out) {
+    for (size_t i = 0; i < size; ++i) {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (c < 0x20) {
+                char buf[8];
+                snprintf(buf, sizeof(buf), "\\u%04x", c);
+                out += buf;
+            } else {
+                out += static_cast<char>(c);
+            }
+            break;
+        }
+    }
+}
+
+void flushAtExit() {
+    Logger::instance().stop();
+}
+
+} // namespace
+
+LogRing::LogRing(size_t capacity)
+    : cells_(new Cell[roundUpPowerOfTwo(capacity)]),
+      mask_(roundUpPowerOfTwo(capacity) - 1),
+      enqueue_pos_(0),
+      dequeue_pos_(0) {
+    for (size_t i = 0; i <= mask_; ++i) {
+        cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool LogRing::push(const LogRecord& record) {
+    Cell* cell;
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    for (;;) {
+        cell = &cells_[pos & mask_];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            // 槽位空闲，抢占该位置
+            if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // 槽位尚未被消费，队列已满
+            return false;
+        } else {
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->record = record;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool LogRing::pop(LogRecord& record) {
+    Cell* cell;
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    for (;;) {
+        cell = &cells_[pos & mask_];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+        if (diff == 0) {
+            if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // 槽位尚未写入，队列为空
+            return false;
+        } else {
+            pos = dequeue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+
+    record = cell->record;
+    cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+}
+
+Logger& Logger::instance() {
+    // 有意不释放：静态析构阶段仍可能有线程写日志
+    static Logger* logger = new Logger();
+    return *logger;
+}
+
+Logger::Logger() : running_(false), fd_(-1), written_(0), dropped_(0) {
+    for (int i = 0; i < static_cast<int>(LogSubsystem::COUNT); ++i) {
+        levels_[i].store(static_cast<int>(config_.subsystem_levels[i]));
+    }
+}
+
+bool Logger::start(const LoggerConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+        return true;
+    }
+
+    config_ = config;
+    for (int i = 0; i < static_cast<int>(LogSubsystem::COUNT); ++i) {
+        levels_[i].store(static_cast<int>(config_.subsystem_levels[i]));
+    }
+
+    if (!config_.file.empty()) {
+        fd_ = open(config_.file.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            std::cerr << "无法打开日志文件: " << config_.file << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+    }
+
+    ring_.reset(new LogRing(config_.queue_size));
+    running_ = true;
+    thread_ = std::thread(&Logger::run, this);
+
+    // 进程退出（包括信号处理中的exit）前输出缓冲区中剩余的日志
+    static bool registered = false;
+    if (!registered) {
+        std::atexit(flushAtExit);
+        registered = true;
+    }
+    return true;
+}
+
+void Logger::stop() {
+    std::thread thread;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+        thread.swap(thread_);
+    }
+
+    // 后台线程看到running_为false后输出完剩余记录再退出
+    if (thread.joinable()) {
+        thread.join();
+    }
+
+    // 停止前读到running_为true的线程可能在后台线程最后一轮之后才入队
+    std::lock_guard<std::mutex> lock(mutex_);
+    drainLocked();
+    if (dropped_.load() > 0) {
+        std::cerr << "日志缓冲区已满，丢弃 " << dropped_.load() << " 条日志" << std::endl;
+    }
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+}
+
+void Logger::setLevel(LogSubsystem subsystem, LogLevel level) {
+    levels_[static_cast<int>(subsystem)].store(static_cast<int>(level));
+}
+
+void Logger::submit(const LogRecord& record) {
+    if (running_.load(std::memory_order_acquire)) {
+        if (!ring_->push(record)) {
+            // 不阻塞请求线程，缓冲区满时丢弃
+            dropped_++;
+            return;
+        }
+        // 入队与stop()竞争：入队后已停止时后台线程可能已经退出，在本线程上输出剩余记录
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!running_.load(std::memory_order_seq_cst)) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            drainLocked();
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    writeRecord(record);
+}
+
+LoggerStats Logger::getStats() const {
+    LoggerStats stats;
+    stats.written = written_.load();
+    stats.dropped = dropped_.load();
+    return stats;
+}
+
+bool Logger::parseLevel(const std::string& name, LogLevel& level) {
+    for (int i = 0; i <= static_cast<int>(LogLevel::OFF); ++i) {
+        if (name == LEVEL_NAMES[i]) {
+            level = static_cast<LogLevel>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Logger::parseSubsystem(const std::string& name, LogSubsystem& subsystem) {
+    for (int i = 0; i < static_cast<int>(LogSubsystem::COUNT); ++i) {
+        if (name == SUBSYSTEM_NAMES[i]) {
+            subsystem = static_cast<LogSubsystem>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Logger::parseFormat(const std::string& name, LogFormat& format) {
+    if (name == "text") {
+        format = LogFormat::TEXT;
+    } else if (name == "json") {
+        format = LogFormat::JSON;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* Logger::levelName(LogLevel level) {
+    return LEVEL_NAMES[static_cast<int>(level)];
+}
+
+const char* Logger::subsystemName(LogSubsystem subsystem) {
+    return SUBSYSTEM_NAMES[static_cast<int>(subsystem)];
+}
+
+void Logger::run() {
+    std::string out;
+    std::string err;
+    LogRecord record;
+
+    for (;;) {
+        // 先读取运行标志再清空缓冲区，保证停止前提交的记录都被输出
+        bool running = running_.load(std::memory_order_acquire);
+
+        size_t count = 0;
+        while (count < DRAIN_BATCH && ring_->pop(record)) {
+            // 未配置文件时警告与错误写stderr
+            bool to_err = fd_ < 0 && record.level >= static_cast<uint8_t>(LogLevel::WARN);
+            format(record, to_err ? err : out);
+            ++count;
+        }
+
+        if (!out.empty()) {
+            writeAll(fd_ >= 0 ? fd_ : STDOUT_FILENO, out);
+            out.clear();
+        }
+        if (!err.empty()) {
+            writeAll(STDERR_FILENO, err);
+            err.clear();
+        }
+        written_ += count;
+
+        if (count == 0) {
+            if (!running) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(config_.flush_interval_ms));
+        }
+    }
+}
+
+void Logger::format(const LogRecord& record, std::string& out) const {
+    LogLevel level = static_cast<LogLevel>(record.level);
+    LogSubsystem subsystem = static_cast<LogSubsystem>(record.subsystem);
+    char buf[32];
+
+    if (config_.format == LogFormat::JSON) {
+        out += "{\"ts\":\"";
+        appendTimestamp(record.timestamp_us, out);
+        out += "\",\"level\":\"";
+        out += levelName(level);
+        out += "\",\"subsystem\":\"";
+        out += subsystemName(subsystem);
+        snprintf(buf, sizeof(buf), "\",\"tid\":%u,\"msg\":\"", record.thread_id);
+        out += buf;
+        appendJsonEscaped(record.text, record.length, out);
+        out += "\"}\n";
+        return;
+    }
+
+    appendTimestamp(record.timestamp_us, out);
+    out += ' ';
+    out += LEVEL_LABELS[record.level];
+    out += " [";
+    out += subsystemName(subsystem);
+    snprintf(buf, sizeof(buf), "] [%u] ", record.thread_id);
+    out += buf;
+    out.append(record.text, record.length);
+    out += '\n';
+}
+
+void Logger::writeAll(int fd, const std::string& data) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        ssize_t n = write(fd, data.data() + offset, data.size() - offset);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        offset += static_cast<size_t>(n);
+    }
+}
+
+void Logger::writeRecord(const LogRecord& record) {
+    std::string line;
+    format(record, line);
+    bool to_err = fd_ < 0 && record.level >= static_cast<uint8_t>(LogLevel::WARN);
+    writeAll(fd_ >= 0 ? fd_ : (to_err ? STDERR_FILENO : STDOUT_FILENO), line);
+    written_++;
+}
+
+void Logger::drainLocked() {
+    LogRecord record;
+    while (ring_ && ring_->pop(record)) {
+        writeRecord(record);
+    }
+}
+
+LogLine::LogLine(LogLevel level, LogSubsystem subsystem) {
+    record_.timestamp_us = nowMicros();
+    record_.thread_id = currentThreadId();
+    record_.level = static_cast<uint8_t>(level);
+    record_.subsystem = static_cast<uint8_t>(subsystem);
+    record_.length = 0;
+}
+
+LogLine::~LogLine() {
+    Logger::instance().submit(record_);
+}
+
+LogLine& LogLine::operator<<(const char* value) {
+    if (value) {
+        append(value, strlen(value));
+    }
+    return *this;
+}
+
+LogLine& LogLine::operator<<(const std::string& value) {
+    append(value.data(), value.size());
+    return *this;
+}
+
+LogLine& LogLine::operator<<(char value) {
+    append(&value, 1);
+    return *this;
+}
+
+LogLine& LogLine::operator<<(int value) {
+    return *this << static_cast<long long>(value);
+}
+
+LogLine& LogLine::operator<<(unsigned int value) {
+    return *this << static_cast<unsigned long long>(value);
+}
+
+LogLine& LogLine::operator<<(long value) {
+    return *this << static_cast<long long>(value);
+}
+
+LogLine& LogLine::operator<<(unsigned long value) {
+    return *this << static_cast<unsigned long long>(value);
+}
+
+LogLine& LogLine::operator<<(long long value) {
+    char buf[24];
+    int n = snprintf(buf, sizeof(buf), "%lld", value);
+    append(buf, static_cast<size_t>(n));
+    return *this;
+}
+
+LogLine& LogLine::operator<<(unsigned long long value) {
+    char buf[24];
+    int n = snprintf(buf, sizeof(buf), "%llu", value);
+    append(buf, static_cast<size_t>(n));
+    return *this;
+}
+
+LogLine& LogLine::operator<<(double value) {
+    // 与std::ostream默认精度一致
+    char buf[32];
+    int n = snprintf(buf, sizeof(buf), "%g", value);
+    append(buf, static_cast<size_t>(n));
+    return *this;
+}
+
+void LogLine::append(const char* data, size_t size) {
+    size_t room = LogRecord::MAX_TEXT - record_.length;
+    if (size > room) {
+        // 回退到UTF-8字符起始字节，避免截断出半个字符
+        size = room;
+        while (size > 0 && (static_cast<unsigned char>(data[size]) & 0xC0) == 0x80) {
+            --size;
+        }
+    }
+    memcpy(record_.text + record_.length, data, size);
+    record_.length = static_cast<uint16_t>(record_.length + size);
+}
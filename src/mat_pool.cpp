@@ -0,0 +1,243 @@
+#include "mat_pool.h"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+
+// 最小与最大的池化尺寸；更小的分配交给malloc的线程缓存，更大的直接分配
+const size_t MIN_POOLED_SIZE = 4096;
+const size_t MAX_POOLED_SIZE = 64 * 1024 * 1024;
+
+// 线程缓存是否已经析构（线程退出时其他thread_local对象仍可能释放Mat）
+thread_local bool t_cache_destroyed = false;
+
+} // namespace
+
+// 每线程空闲缓冲区缓存
+struct PooledMatAllocator::ThreadCache {
+    std::vector<std::vector<unsigned char*>> lists;
+    size_t bytes;
+
+    explicit ThreadCache(size_t class_count) : lists(class_count), bytes(0) {
+    }
+
+    ~ThreadCache() {
+        t_cache_destroyed = true;
+        PooledMatAllocator::instance().flushToDepot(lists.data(), bytes);
+    }
+};
+
+PooledMatAllocator& PooledMatAllocator::instance() {
+    // 有意不释放：cv::Mat可能在静态析构阶段才释放缓冲区
+    static PooledMatAllocator* allocator = new PooledMatAllocator();
+    return *allocator;
+}
+
+PooledMatAllocator::PooledMatAllocator()
+    : thread_cache_bytes_(32 * 1024 * 1024),
+      max_cached_bytes_(256 * 1024 * 1024),
+      depot_bytes_(0),
+      allocations_(0),
+      pool_hits_(0),
+      oversize_(0),
+      cached_bytes_(0),
+      pooled_bytes_(0),
+      peak_pooled_bytes_(0) {
+    // 每个2的幂区间划分4个级别，内部碎片不超过25%
+    for (size_t base = MIN_POOLED_SIZE; base < MAX_POOLED_SIZE; base *= 2) {
+        for (size_t i = 0; i < 4; ++i) {
+            class_sizes_.push_back(base + base / 4 * i);
+        }
+    }
+    class_sizes_.push_back(MAX_POOLED_SIZE);
+    depot_.resize(class_sizes_.size());
+}
+
+void PooledMatAllocator::install(size_t thread_cache_bytes, size_t max_cached_bytes) {
+    thread_cache_bytes_ = thread_cache_bytes;
+    max_cached_bytes_ = max_cached_bytes;
+    cv::Mat::setDefaultAllocator(this);
+
+    std::cout << "Mat内存池已启用，线程缓存上限: " << (thread_cache_bytes_ >> 20)
+              << "MB, 全局缓存上限: " << (max_cached_bytes_ >> 20) << "MB" << std::endl;
+}
+
+cv::UMatData* PooledMatAllocator::allocate(int dims, const int* sizes, int type, void* data0,
+                                           size_t* step, int /*flags*/,
+                                           cv::UMatUsageFlags /*usageFlags*/) const {
+    // 与cv::StdMatAllocator相同的步长计算
+    size_t total = CV_ELEM_SIZE(type);
+    for (int i = dims - 1; i >= 0; i--) {
+        if (step) {
+            if (data0 && step[i] != CV_AUTOSTEP) {
+                CV_Assert(total <= step[i]);
+                total = step[i];
+            } else {
+                step[i] = total;
+            }
+        }
+        total *= sizes[i];
+    }
+
+    cv::UMatData* u = new cv::UMatData(this);
+    u->size = total;
+
+    if (data0) {
+        // 外部提供的内存不归池管理
+        u->data = u->origdata = static_cast<uchar*>(data0);
+        u->flags |= cv::UMatData::USER_ALLOCATED;
+        return u;
+    }
+
+    allocations_++;
+
+    int size_class = sizeClassFor(total);
+    if (size_class < 0) {
+        oversize_++;
+        u->data = u->origdata = static_cast<uchar*>(cv::fastMalloc(total));
+        return u;
+    }
+
+    // allocatorFlags_ 记录尺寸级别（+1，0表示未池化）
+    u->data = u->origdata = acquire(size_class);
+    u->allocatorFlags_ = size_class + 1;
+    return u;
+}
+
+bool PooledMatAllocator::allocate(cv::UMatData* u, int /*accessFlags*/,
+                                  cv::UMatUsageFlags /*usageFlags*/) const {
+    return u != nullptr;
+}
+
+void PooledMatAllocator::deallocate(cv::UMatData* u) const {
+    if (!u) {
+        return;
+    }
+
+    CV_Assert(u->urefcount == 0);
+    CV_Assert(u->refcount == 0);
+
+    if (!(u->flags & cv::UMatData::USER_ALLOCATED)) {
+        int size_class = u->allocatorFlags_ - 1;
+        if (size_class >= 0) {
+            release(size_class, u->origdata);
+        } else {
+            cv::fastFree(u->origdata);
+        }
+        u->origdata = 0;
+    }
+
+    delete u;
+}
+
+MatPoolStats PooledMatAllocator::getStats() const {
+    MatPoolStats stats;
+    stats.allocations = allocations_.load();
+    stats.pool_hits = pool_hits_.load();
+    stats.oversize = oversize_.load();
+    stats.cached_bytes = cached_bytes_.load();
+    stats.pooled_bytes = pooled_bytes_.load();
+    stats.peak_pooled_bytes = peak_pooled_bytes_.load();
+    return stats;
+}
+
+PooledMatAllocator::ThreadCache* PooledMatAllocator::localCache() const {
+    if (t_cache_destroyed) {
+        return nullptr;
+    }
+    thread_local ThreadCache cache(class_sizes_.size());
+    return &cache;
+}
+
+int PooledMatAllocator::sizeClassFor(size_t size) const {
+    if (size < MIN_POOLED_SIZE || size > MAX_POOLED_SIZE) {
+        return -1;
+    }
+    auto it = std::lower_bound(class_sizes_.begin(), class_sizes_.end(), size);
+    return static_cast<int>(it - class_sizes_.begin());
+}
+
+unsigned char* PooledMatAllocator::acquire(int size_class) const {
+    size_t block_size = class_sizes_[size_class];
+
+    // 先查线程缓存（无锁）
+    ThreadCache* cache = localCache();
+    if (cache && !cache->lists[size_class].empty()) {
+        unsigned char* block = cache->lists[size_class].back();
+        cache->lists[size_class].pop_back();
+        cache->bytes -= block_size;
+        cached_bytes_ -= block_size;
+        pool_hits_++;
+        return block;
+    }
+
+    // 再查全局仓库
+    {
+        std::lock_guard<std::mutex> lock(depot_mutex_);
+        std::vector<unsigned char*>& list = depot_[size_class];
+        if (!list.empty()) {
+            unsigned char* block = list.back();
+            list.pop_back();
+            depot_bytes_ -= block_size;
+            cached_bytes_ -= block_size;
+            pool_hits_++;
+            return block;
+        }
+    }
+
+    // 池中没有可用块，新分配
+    unsigned char* block = static_cast<unsigned char*>(cv::fastMalloc(block_size));
+    updatePeak(pooled_bytes_ += block_size);
+    return block;
+}
+
+void PooledMatAllocator::release(int size_class, unsigned char* block) const {
+    size_t block_size = class_sizes_[size_class];
+
+    ThreadCache* cache = localCache();
+    if (cache && cache->bytes + block_size <= thread_cache_bytes_) {
+        cache->lists[size_class].push_back(block);
+        cache->bytes += block_size;
+        cached_bytes_ += block_size;
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(depot_mutex_);
+        if (depot_bytes_ + block_size <= max_cached_bytes_) {
+            depot_[size_class].push_back(block);
+            depot_bytes_ += block_size;
+            cached_bytes_ += block_size;
+            return;
+        }
+    }
+
+    // 超出缓存上限，归还给系统
+    cv::fastFree(block);
+    pooled_bytes_ -= block_size;
+}
+
+void PooledMatAllocator::flushToDepot(std::vector<unsigned char*>* lists, size_t& bytes) const {
+    std::lock_guard<std::mutex> lock(depot_mutex_);
+    for (size_t c = 0; c < class_sizes_.size(); ++c) {
+        size_t block_size = class_sizes_[c];
+        for (unsigned char* block : lists[c]) {
+            if (depot_bytes_ + block_size <= max_cached_bytes_) {
+                depot_[c].push_back(block);
+                depot_bytes_ += block_size;
+            } else {
+                cv::fastFree(block);
+                cached_bytes_ -= block_size;
+                pooled_bytes_ -= block_size;
+            }
+        }
+        lists[c].clear();
+    }
+    bytes = 0;
+}
+
+void PooledMatAllocator::updatePeak(size_t pooled) const {
+    size_t peak = peak_pooled_bytes_.load();
+    while (pooled > peak && !peak_pooled_bytes_.compare_exchange_weak(peak, pooled)) {
+    }
+}
@@ -0,0 +1,287 @@
+#include "memory_storage.h"
+#include "logger.h"
+#include "utils.h"
+#include <functional>
+
+namespace {
+
+const size_t INITIAL_CAPACITY = 1024;
+
+} // namespace
+
+MemoryStorage::Table::Table(size_t capacity)
+    : mask(capacity - 1), slots(new std::atomic<const UserInfo*>[capacity]) {
+    for (size_t i = 0; i < capacity; ++i) {
+        slots[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+MemoryStorage::MemoryStorage()
+    : by_name_(nullptr), by_id_(nullptr), user_count_(0), next_id_(1),
+      auth_logs_(0), login_records_(0) {
+}
+
+MemoryStorage::~MemoryStorage() {
+    disconnect();
+}
+
+bool MemoryStorage::connect(const DBConfig& /*config*/) {
+    return createTables();
+}
+
+void MemoryStorage::disconnect() {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    if (!by_name_.load()) {
+        return;
+    }
+    LOG_INFO(LogSubsystem::STORAGE, "内存存储已关闭，用户数: " << user_count_.load()
+              << ", 认证日志: " << auth_logs_.load()
+              << ", 登录记录: " << login_records_.load());
+
+    by_name_.store(nullptr);
+    by_id_.store(nullptr);
+    user_count_.store(0);
+    next_id_ = 1;
+    records_.clear();
+    tables_.clear();
+    last_logins_.clear();
+}
+
+bool MemoryStorage::createTables() {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    if (by_name_.load()) {
+        return true;
+    }
+
+    tables_.push_back(std::unique_ptr<Table>(new Table(INITIAL_CAPACITY)));
+    by_name_.store(tables_.back().get(), std::memory_order_release);
+    tables_.push_back(std::unique_ptr<Table>(new Table(INITIAL_CAPACITY)));
+    by_id_.store(tables_.back().get(), std::memory_order_release);
+
+    LOG_INFO(LogSubsystem::STORAGE, "使用内存存储后端（数据不持久化）");
+    return true;
+}
+
+bool MemoryStorage::addUser(const std::string& username, const std::string& password,
+                            const std::vector<FaceImage>& faces) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    if (!by_name_.load()) {
+        LOG_ERROR(LogSubsystem::STORAGE, "内存存储未初始化");
+        return false;
+    }
+
+    if (findByName(username)) {
+        LOG_ERROR(LogSubsystem::STORAGE, "用户名已存在: " << username);
+        return false;
+    }
+
+    // 只有最后一张注册人脸在登录时使用，记录其路径
+    std::string file_path;
+    for (const FaceImage& face : faces) {
+        file_path = saveFaceFile(face, "register");
+        if (file_path.empty()) {
+            LOG_ERROR(LogSubsystem::STORAGE, "无法存储用户的人脸数据: " << username);
+            return false;
+        }
+    }
+
+    UserInfo* record = new UserInfo();
+    record->id = next_id_++;
+    record->username = username;
+    record->password_hash = utils::sha256(password);
+    record->file_path = file_path;
+    record->created_at = utils::getCurrentTimestamp();
+    publish(record);
+
+    // ID连续分配，发布后再更新用户数，遍历时只访问已发布的ID
+    user_count_.store(record->id, std::memory_order_release);
+    return true;
+}
+
+bool MemoryStorage::storeFaceData(int user_id, const FaceImage& face, const std::string& type) {
+    if (type == "login") {
+        login_records_++;
+        return findById(user_id) != nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    const UserInfo* current = findById(user_id);
+    if (!current) {
+        LOG_ERROR(LogSubsystem::STORAGE, "用户未找到: " << user_id);
+        return false;
+    }
+
+    std::string file_path = saveFaceFile(face, type);
+    if (file_path.empty()) {
+        return false;
+    }
+    return replaceFace(current, file_path);
+}
+
+bool MemoryStorage::updateUserFace(int user_id, const std::vector<FaceImage>& faces) {
+    if (!findById(user_id)) {
+        LOG_ERROR(LogSubsystem::STORAGE, "用户未找到: " << user_id);
+        return false;
+    }
+    for (const FaceImage& face : faces) {
+        if (!storeFaceData(user_id, face, "register")) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MemoryStorage::forEachUser(const std::function<bool(const UserInfo&)>& visitor) {
+    int count = user_count_.load(std::memory_order_acquire);
+    for (int id = 1; id <= count; ++id) {
+        const UserInfo* user = findById(id);
+        if (user && !visitor(*user)) {
+            break;
+        }
+    }
+    return true;
+}
+
+UserInfo MemoryStorage::getUserById(int user_id) {
+    const UserInfo* user = findById(user_id);
+    if (!user) {
+        UserInfo empty;
+        empty.id = 0;
+        return empty;
+    }
+    return *user;
+}
+
+UserInfo MemoryStorage::getUserByUsername(const std::string& username) {
+    const UserInfo* user = findByName(username);
+    if (!user) {
+        UserInfo empty;
+        empty.id = 0;
+        return empty;
+    }
+    return *user;
+}
+
+std::string MemoryStorage::getUserPassword(int user_id) {
+    const UserInfo* user = findById(user_id);
+    return user ? user->password_hash : "";
+}
+
+bool MemoryStorage::logAuthentication(int /*user_id*/, bool /*success*/, const std::string& /*details*/) {
+    auth_logs_++;
+    return true;
+}
+
+bool MemoryStorage::updateLastLogin(int user_id) {
+    std::map<int, std::string> last_logins;
+    last_logins[user_id] = utils::getCurrentTimestamp();
+    return updateLastLogins(last_logins);
+}
+
+bool MemoryStorage::insertAuthLogs(const std::vector<AuthLogEntry>& entries) {
+    auth_logs_ += entries.size();
+    return true;
+}
+
+bool MemoryStorage::insertLoginRecords(const std::vector<LoginRecord>& records) {
+    login_records_ += records.size();
+    return true;
+}
+
+bool MemoryStorage::updateLastLogins(const std::map<int, std::string>& last_logins) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    for (const auto& pair : last_logins) {
+        last_logins_[pair.first] = pair.second;
+    }
+    return true;
+}
+
+const UserInfo* MemoryStorage::findByName(const std::string& username) const {
+    const Table* table = by_name_.load(std::memory_order_acquire);
+    if (!table) {
+        return nullptr;
+    }
+    for (size_t i = hashName(username) & table->mask;; i = (i + 1) & table->mask) {
+        const UserInfo* record = table->slots[i].load(std::memory_order_acquire);
+        if (!record) {
+            return nullptr;
+        }
+        if (record->username == username) {
+            return record;
+        }
+    }
+}
+
+const UserInfo* MemoryStorage::findById(int user_id) const {
+    const Table* table = by_id_.load(std::memory_order_acquire);
+    if (!table) {
+        return nullptr;
+    }
+    for (size_t i = hashId(user_id) & table->mask;; i = (i + 1) & table->mask) {
+        const UserInfo* record = table->slots[i].load(std::memory_order_acquire);
+        if (!record) {
+            return nullptr;
+        }
+        if (record->id == user_id) {
+            return record;
+        }
+    }
+}
+
+void MemoryStorage::publish(const UserInfo* record) {
+    records_.push_back(std::unique_ptr<const UserInfo>(record));
+    publishTo(by_id_, record, false);
+    publishTo(by_name_, record, true);
+}
+
+void MemoryStorage::publishTo(std::atomic<Table*>& index, const UserInfo* record, bool by_name) {
+    Table* table = index.load(std::memory_order_relaxed);
+    size_t capacity = table->mask + 1;
+
+    // 负载超过1/2时扩容：在新表中重建后整体发布，读者看到的总是完整的表
+    int count = user_count_.load(std::memory_order_relaxed) + 1;
+    if (static_cast<size_t>(count) * 2 > capacity) {
+        Table* grown = new Table(capacity * 2);
+        tables_.push_back(std::unique_ptr<Table>(grown));
+        for (size_t i = 0; i < capacity; ++i) {
+            const UserInfo* existing = table->slots[i].load(std::memory_order_relaxed);
+            if (!existing) {
+                continue;
+            }
+            size_t hash = by_name ? hashName(existing->username) : hashId(existing->id);
+            size_t j = hash & grown->mask;
+            while (grown->slots[j].load(std::memory_order_relaxed)) {
+                j = (j + 1) & grown->mask;
+            }
+            grown->slots[j].store(existing, std::memory_order_relaxed);
+        }
+        index.store(grown, std::memory_order_release);
+        table = grown;
+    }
+
+    // 同一用户的新记录替换原槽位，否则写入第一个空槽
+    size_t hash = by_name ? hashName(record->username) : hashId(record->id);
+    for (size_t i = hash & table->mask;; i = (i + 1) & table->mask) {
+        const UserInfo* existing = table->slots[i].load(std::memory_order_relaxed);
+        if (!existing || existing->id == record->id) {
+            table->slots[i].store(record, std::memory_order_release);
+            return;
+        }
+    }
+}
+
+bool MemoryStorage::replaceFace(const UserInfo* current, const std::string& file_path) {
+    UserInfo* record = new UserInfo(*current);
+    record->file_path = file_path;
+    publish(record);
+    return true;
+}
+
+size_t MemoryStorage::hashName(const std::string& username) {
+    return std::hash<std::string>()(username);
+}
+
+size_t MemoryStorage::hashId(int user_id) {
+    // 乘法散列，连续ID分散到不同槽位
+    return static_cast<size_t>(static_cast<unsigned int>(user_id)) * 0x9E3779B97F4A7C15ULL >> 16;
+}
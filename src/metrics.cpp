@@ -0,0 +1,251 @@
+#include "metrics.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+
+namespace {
+
+// 导出的分位数
+const double QUANTILES[] = {0.5, 0.9, 0.99, 0.999};
+const char* const QUANTILE_NAMES[] = {"0.5", "0.9", "0.99", "0.999"};
+const char* const QUANTILE_KEYS[] = {"p50", "p90", "p99", "p999"};
+
+std::string escapeLabelValue(const std::string& value) {
+    std::string escaped;
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            escaped += '\\';
+            escaped += c;
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+// 拼接标签部分，如 {stage="decode",quantile="0.5"}；没有标签时返回空串
+std::string labels(const std::string& label, const std::string& value,
+                   const char* extra_label = nullptr, const char* extra_value = nullptr) {
+    std::string out;
+    if (!label.empty()) {
+        out += label + "=\"" + escapeLabelValue(value) + "\"";
+    }
+    if (extra_label) {
+        if (!out.empty()) {
+            out += ',';
+        }
+        out += std::string(extra_label) + "=\"" + extra_value + "\"";
+    }
+    return out.empty() ? out : "{" + out + "}";
+}
+
+std::string formatNumber(double value) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.15g", value);
+    return buf;
+}
+
+} // namespace
+
+uint64_t HistogramSnapshot::percentile(double q) const {
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t target = static_cast<uint64_t>(std::ceil(q * count));
+    if (target == 0) {
+        target = 1;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= target) {
+            return std::min(LatencyHistogram::bucketUpperBound(static_cast<int>(i)), max);
+        }
+    }
+    return max;
+}
+
+LatencyHistogram::LatencyHistogram() : count_(0), sum_(0), max_(0) {
+    for (std::atomic<uint64_t>& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::record(uint64_t value) {
+    buckets_[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    uint64_t current = max_.load(std::memory_order_relaxed);
+    while (value > current && !max_.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+HistogramSnapshot LatencyHistogram::snapshot() const {
+    // 各字段分别读取，并发记录时快照内部可能有极小的不一致，对统计用途无影响
+    HistogramSnapshot snapshot;
+    snapshot.buckets.resize(BUCKET_COUNT);
+    uint64_t total = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        snapshot.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        total += snapshot.buckets[i];
+    }
+    snapshot.count = total;
+    snapshot.sum = sum_.load(std::memory_order_relaxed);
+    snapshot.max = max_.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+int LatencyHistogram::bucketIndex(uint64_t value) {
+    if (value < static_cast<uint64_t>(SUB_BUCKETS)) {
+        return static_cast<int>(value);
+    }
+    int magnitude = 63 - __builtin_clzll(value);
+    if (magnitude > MAX_MAGNITUDE) {
+        return BUCKET_COUNT - 1;
+    }
+    // 最高的SUB_BUCKET_BITS+1位决定子桶
+    int shift = magnitude - SUB_BUCKET_BITS;
+    int sub = static_cast<int>(value >> shift) - SUB_BUCKETS;
+    return SUB_BUCKETS + shift * SUB_BUCKETS + sub;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int index) {
+    if (index < SUB_BUCKETS) {
+        return static_cast<uint64_t>(index);
+    }
+    int shift = (index - SUB_BUCKETS) / SUB_BUCKETS;
+    int sub = (index - SUB_BUCKETS) % SUB_BUCKETS;
+    uint64_t lower = static_cast<uint64_t>(SUB_BUCKETS + sub) << shift;
+    return lower + (static_cast<uint64_t>(1) << shift) - 1;
+}
+
+bool MetricsRegistry::Key::operator<(const Key& other) const {
+    if (name != other.name) {
+        return name < other.name;
+    }
+    if (label != other.label) {
+        return label < other.label;
+    }
+    return value < other.value;
+}
+
+MetricsRegistry& MetricsRegistry::instance() {
+    // 有意不释放：静态析构阶段仍可能有线程记录指标
+    static MetricsRegistry* registry = new MetricsRegistry();
+    return *registry;
+}
+
+LatencyHistogram& MetricsRegistry::histogram(const std::string& name, const std::string& label,
+                                             const std::string& value) {
+    Key key = {name, label, value};
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_ptr<LatencyHistogram>& entry = histograms_[key];
+    if (!entry) {
+        entry.reset(new LatencyHistogram());
+    }
+    return *entry;
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& label,
+                                  const std::string& value) {
+    Key key = {name, label, value};
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_ptr<Counter>& entry = counters_[key];
+    if (!entry) {
+        entry.reset(new Counter());
+    }
+    return *entry;
+}
+
+Json::Value MetricsRegistry::toJson(const std::vector<GaugeSample>& gauges) const {
+    Json::Value root;
+    root["histograms"] = Json::Value(Json::arrayValue);
+    root["counters"] = Json::Value(Json::arrayValue);
+    root["gauges"] = Json::Value(Json::arrayValue);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& pair : histograms_) {
+        HistogramSnapshot snapshot = pair.second->snapshot();
+        Json::Value item;
+        item["name"] = pair.first.name;
+        if (!pair.first.label.empty()) {
+            item[pair.first.label] = pair.first.value;
+        }
+        item["count"] = static_cast<Json::UInt64>(snapshot.count);
+        item["mean"] = snapshot.mean();
+        for (size_t i = 0; i < sizeof(QUANTILES) / sizeof(QUANTILES[0]); ++i) {
+            item[QUANTILE_KEYS[i]] = static_cast<Json::UInt64>(snapshot.percentile(QUANTILES[i]));
+        }
+        item["max"] = static_cast<Json::UInt64>(snapshot.max);
+        root["histograms"].append(item);
+    }
+
+    for (const auto& pair : counters_) {
+        Json::Value item;
+        item["name"] = pair.first.name;
+        if (!pair.first.label.empty()) {
+            item[pair.first.label] = pair.first.value;
+        }
+        item["value"] = static_cast<Json::UInt64>(pair.second->value());
+        root["counters"].append(item);
+    }
+
+    for (const GaugeSample& gauge : gauges) {
+        Json::Value item;
+        item["name"] = gauge.name;
+        if (!gauge.label.empty()) {
+            item[gauge.label] = gauge.value_label;
+        }
+        item["value"] = gauge.value;
+        root["gauges"].append(item);
+    }
+    return root;
+}
+
+std::string MetricsRegistry::toPrometheus(const std::vector<GaugeSample>& gauges) const {
+    std::ostringstream out;
+    std::string family;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& pair : histograms_) {
+        const Key& key = pair.first;
+        if (key.name != family) {
+            family = key.name;
+            out << "# TYPE " << family << " summary\n";
+        }
+        HistogramSnapshot snapshot = pair.second->snapshot();
+        for (size_t i = 0; i < sizeof(QUANTILES) / sizeof(QUANTILES[0]); ++i) {
+            out << key.name << labels(key.label, key.value, "quantile", QUANTILE_NAMES[i])
+                << ' ' << snapshot.percentile(QUANTILES[i]) << '\n';
+        }
+        out << key.name << "_sum" << labels(key.label, key.value) << ' ' << snapshot.sum << '\n';
+        out << key.name << "_count" << labels(key.label, key.value) << ' ' << snapshot.count << '\n';
+    }
+
+    family.clear();
+    for (const auto& pair : counters_) {
+        const Key& key = pair.first;
+        if (key.name != family) {
+            family = key.name;
+            out << "# TYPE " << family << " counter\n";
+        }
+        out << key.name << labels(key.label, key.value) << ' ' << pair.second->value() << '\n';
+    }
+
+    // 同名的瞬时值需连续输出
+    std::vector<GaugeSample> sorted = gauges;
+    std::stable_sort(sorted.begin(), sorted.end(),
+        [](const GaugeSample& a, const GaugeSample& b) { return a.name < b.name; });
+    family.clear();
+    for (const GaugeSample& gauge : sorted) {
+        if (gauge.name != family) {
+            family = gauge.name;
+            out << "# TYPE " << family << " gauge\n";
+        }
+        out << gauge.name << labels(gauge.label, gauge.value_label) << ' ' << formatNumber(gauge.value) << '\n';
+    }
+    return out.str();
+}
@@ -0,0 +1,80 @@
+#include "pipeline_stage.h"
+
+namespace {
+
+uint64_t elapsedMicros(std::chrono::steady_clock::time_point start,
+                       std::chrono::steady_clock::time_point end) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+}
+
+void updateMax(std::atomic<uint64_t>& target, uint64_t value) {
+    uint64_t current = target.load();
+    while (value > current && !target.compare_exchange_weak(current, value)) {
+    }
+}
+
+} // namespace
+
+PipelineStage::PipelineStage(const std::string& name, Executor* executor)
+    : name_(name),
+      executor_(executor),
+      wait_histogram_(MetricsRegistry::instance().histogram("face_auth_stage_wait_us", "stage", name)),
+      run_histogram_(MetricsRegistry::instance().histogram("face_auth_stage_run_us", "stage", name)),
+      queued_(0),
+      max_queued_(0),
+      completed_(0),
+      wait_us_(0),
+      run_us_(0),
+      max_run_us_(0) {
+}
+
+void PipelineStage::post(std::function<void()> task) {
+    Clock::time_point enqueued = enqueue();
+    if (!executor_) {
+        Timer timer(*this, enqueued);
+        task();
+        return;
+    }
+    executor_->post([this, task, enqueued]() {
+        Timer timer(*this, enqueued);
+        task();
+    });
+}
+
+StageStats PipelineStage::getStats() const {
+    StageStats stats;
+    stats.name = name_;
+    stats.executor = executor_ ? executor_->name() : "inline";
+    stats.completed = completed_.load();
+    stats.queue_depth = queued_.load();
+    stats.max_queue_depth = max_queued_.load();
+    stats.avg_wait_us = stats.completed ? static_cast<double>(wait_us_.load()) / stats.completed : 0.0;
+    stats.avg_run_us = stats.completed ? static_cast<double>(run_us_.load()) / stats.completed : 0.0;
+    stats.max_run_us = max_run_us_.load();
+    return stats;
+}
+
+PipelineStage::Clock::time_point PipelineStage::enqueue() {
+    size_t depth = ++queued_;
+    size_t peak = max_queued_.load();
+    while (depth > peak && !max_queued_.compare_exchange_weak(peak, depth)) {
+    }
+    return Clock::now();
+}
+
+PipelineStage::Timer::Timer(PipelineStage& stage, Clock::time_point enqueued)
+    : stage_(stage), start_(Clock::now()) {
+    stage_.queued_--;
+    uint64_t wait_us = elapsedMicros(enqueued, start_);
+    stage_.wait_us_ += wait_us;
+    stage_.wait_histogram_.record(wait_us);
+}
+
+PipelineStage::Timer::~Timer() {
+    uint64_t run_us = elapsedMicros(start_, Clock::now());
+    stage_.run_us_ += run_us;
+    stage_.run_histogram_.record(run_us);
+    updateMax(stage_.max_run_us_, run_us);
+    stage_.completed_++;
+}
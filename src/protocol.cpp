@@ -0,0 +1,159 @@
+#include "protocol.h"
+#include "logger.h"
+#include <cstring>
+#include <cstdint>
+#include <arpa/inet.h>
+
+namespace {
+
+// 帧头后4字节：JSON长度（网络字节序）
+uint32_t readLength(const char* data) {
+    uint32_t length = 0;
+    memcpy(&length, data, 4);
+    return ntohl(length);
+}
+
+std::string buildFrame(const char* magic, const std::string& json, const std::string& payload) {
+    std::string frame;
+    frame.reserve(protocol::FRAME_HEADER_SIZE + json.size() + payload.size());
+    frame.append(magic, 4);
+    uint32_t net_length = htonl(static_cast<uint32_t>(json.size()));
+    frame.append(reinterpret_cast<const char*>(&net_length), 4);
+    frame.append(json);
+    frame.append(payload);
+    return frame;
+}
+
+} // namespace
+
+namespace protocol {
+
+FrameStatus parseRequestFrame(const char* data, size_t size, Message& message, size_t* frame_size) {
+    if (size < FRAME_HEADER_SIZE) {
+        return FrameStatus::INCOMPLETE;
+    }
+
+    // 检查数据包头
+    if (memcmp(data, "FACE", 4) != 0) {
+        LOG_WARN(LogSubsystem::NET, "无效头部: " << std::string(data, 4));
+        return FrameStatus::INVALID;
+    }
+
+    // 获取JSON长度
+    size_t json_length = readLength(data + 4);
+    LOG_TRACE(LogSubsystem::NET, "解析的JSON长度: " << json_length);
+    if (json_length == 0 || json_length > MAX_FRAME_SIZE - FRAME_HEADER_SIZE) {
+        LOG_WARN(LogSubsystem::NET, "无效JSON长度: " << json_length);
+        return FrameStatus::INVALID;
+    }
+    if (size < FRAME_HEADER_SIZE + json_length) {
+        return FrameStatus::INCOMPLETE;
+    }
+
+    // 解析JSON数据
+    const char* json_begin = data + FRAME_HEADER_SIZE;
+    Json::Value json_obj;
+    Json::Reader reader;
+    if (!reader.parse(json_begin, json_begin + json_length, json_obj)) {
+        LOG_WARN(LogSubsystem::NET, "无法解析JSON: " << reader.getFormattedErrorMessages());
+        return FrameStatus::INVALID;
+    }
+
+    // 解析消息类型
+    std::string type = json_obj["type"].asString();
+    if (type == "login") {
+        message.type = MessageType::AUTHENTICATE_USER;
+    } else if (type == "register") {
+        message.type = MessageType::REGISTER_USER;
+    } else if (type == "enrollment_status") {
+        message.type = MessageType::ENROLLMENT_STATUS;
+    } else if (type == "stats") {
+        message.type = MessageType::STATS;
+    } else if (type == "login_session") {
+        message.type = MessageType::SESSION_LOGIN;
+    } else if (type == "session_frame") {
+        message.type = MessageType::SESSION_FRAME;
+    } else if (type == "session_end") {
+        message.type = MessageType::SESSION_END;
+    } else if (type == "token_auth") {
+        message.type = MessageType::TOKEN_AUTH;
+    } else if (type == "token_revoke") {
+        message.type = MessageType::TOKEN_REVOKE;
+    } else {
+        LOG_WARN(LogSubsystem::NET, "未知消息类型: " << type);
+        return FrameStatus::INVALID;
+    }
+
+    // 状态与统计查询、会话结束与令牌请求不携带人脸数据
+    bool needs_face = message.type != MessageType::ENROLLMENT_STATUS && message.type != MessageType::STATS &&
+                      message.type != MessageType::SESSION_END && message.type != MessageType::TOKEN_AUTH &&
+                      message.type != MessageType::TOKEN_REVOKE;
+    int face_data_size = json_obj["face_data_size"].asInt();
+    if (needs_face && (face_data_size <= 0 ||
+                       static_cast<size_t>(face_data_size) > MAX_FRAME_SIZE - FRAME_HEADER_SIZE - json_length)) {
+        LOG_WARN(LogSubsystem::NET, "无效人脸数据大小: " << face_data_size);
+        return FrameStatus::INVALID;
+    }
+
+    size_t total = FRAME_HEADER_SIZE + json_length + (needs_face ? static_cast<size_t>(face_data_size) : 0);
+    if (frame_size) {
+        *frame_size = total;
+    }
+    if (size < total) {
+        return FrameStatus::INCOMPLETE;
+    }
+
+    // 提取数据
+    message.data["username"] = json_obj["username"].asString();
+    message.data["password"] = json_obj["password"].asString();
+    if (json_obj.isMember("token")) {
+        message.data["token"] = json_obj["token"].asString();
+    }
+    if (needs_face) {
+        message.data["face_data"].assign(json_begin + json_length, static_cast<size_t>(face_data_size));
+    }
+    return FrameStatus::COMPLETE;
+}
+
+std::string buildRequestFrame(const Json::Value& request, const std::string& face_data) {
+    Json::Value json = request;
+    if (!face_data.empty()) {
+        json["face_data_size"] = static_cast<Json::UInt64>(face_data.size());
+    }
+    Json::FastWriter writer;
+    return buildFrame("FACE", writer.write(json), face_data);
+}
+
+std::string buildResponseFrame(const Json::Value& response) {
+    Json::FastWriter writer;
+    return buildFrame("RESP", writer.write(response), std::string());
+}
+
+FrameStatus parseResponseFrame(const char* data, size_t size, Json::Value& response, size_t* frame_size) {
+    if (size < FRAME_HEADER_SIZE) {
+        return FrameStatus::INCOMPLETE;
+    }
+    if (memcmp(data, "RESP", 4) != 0) {
+        return FrameStatus::INVALID;
+    }
+
+    size_t json_length = readLength(data + 4);
+    if (json_length == 0 || json_length > MAX_FRAME_SIZE - FRAME_HEADER_SIZE) {
+        return FrameStatus::INVALID;
+    }
+    if (frame_size) {
+        *frame_size = FRAME_HEADER_SIZE + json_length;
+    }
+    if (size < FRAME_HEADER_SIZE + json_length) {
+        return FrameStatus::INCOMPLETE;
+    }
+
+    const char* json_begin = data + FRAME_HEADER_SIZE;
+    Json::Reader reader;
+    if (!reader.parse(json_begin, json_begin + json_length, response)) {
+        return FrameStatus::INVALID;
+    }
+    return FrameStatus::COMPLETE;
+}
+
+} // namespace protocol
@@ -0,0 +1,613 @@
+#include "sqlite_storage.h"
+#include "logger.h"
+#include "utils.h"
+
+namespace {
+
+// 语句用完后复位并清除绑定，便于下次复用
+struct StatementReset {
+    sqlite3_stmt* stmt;
+    explicit StatementReset(sqlite3_stmt* s) : stmt(s) {
+    }
+    ~StatementReset() {
+        if (stmt) {
+            sqlite3_reset(stmt);
+            sqlite3_clear_bindings(stmt);
+        }
+    }
+};
+
+std::string columnText(sqlite3_stmt* stmt, int column) {
+    const unsigned char* text = sqlite3_column_text(stmt, column);
+    return text ? reinterpret_cast<const char*>(text) : "";
+}
+
+void bindText(sqlite3_stmt* stmt, int index, const std::string& value) {
+    sqlite3_bind_text(stmt, index, value.c_str(), static_cast<int>(value.size()), SQLITE_TRANSIENT);
+}
+
+const char* const SELECT_USER_COLUMNS =
+    "SELECT u.id, u.username, u.password, u.created_at, "
+    "       (SELECT f.file_path FROM face_images f "
+    "        WHERE f.user_id = u.id AND f.type = 'register' "
+    "        ORDER BY f.created_at DESC, f.id DESC LIMIT 1) "
+    "FROM users u ";
+
+const std::string SELECT_USER_BY_ID = std::string(SELECT_USER_COLUMNS) + "WHERE u.id = ?";
+const std::string SELECT_USER_BY_NAME = std::string(SELECT_USER_COLUMNS) + "WHERE u.username = ?";
+const std::string SELECT_ALL_USERS = std::string(SELECT_USER_COLUMNS) + "ORDER BY u.id";
+
+const char* const INSERT_FACE_IMAGE =
+    "INSERT INTO face_images (user_id, file_path, type, created_at) VALUES (?, ?, ?, ?)";
+const char* const INSERT_AUTH_LOG =
+    "INSERT INTO auth_logs (user_id, success, details, created_at) VALUES (?, ?, ?, ?)";
+const char* const UPDATE_LAST_LOGIN =
+    "UPDATE users SET last_login = ? WHERE id = ?";
+const char* const SELECT_WAL_CHECKPOINT =
+    "SELECT sequence FROM wal_checkpoint WHERE source = ?";
+const char* const UPSERT_WAL_CHECKPOINT =
+    "INSERT INTO wal_checkpoint (source, sequence, updated_at) VALUES (?, ?, ?) "
+    "ON CONFLICT(source) DO UPDATE SET sequence = excluded.sequence, updated_at = excluded.updated_at";
+
+} // namespace
+
+SqliteStorage::SqliteStorage()
+    : db_(nullptr), prepares_(0), executes_(0), cache_hits_(0) {
+}
+
+SqliteStorage::~SqliteStorage() {
+    disconnect();
+}
+
+bool SqliteStorage::connect(const DBConfig& config) {
+    disconnect();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    // 连接由mutex_串行化，关闭SQLite内部的连接级互斥
+    int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX;
+    if (sqlite3_open_v2(config.path.c_str(), &db_, flags, nullptr) != SQLITE_OK) {
+        LOG_ERROR(LogSubsystem::STORAGE, "无法打开SQLite数据库 " << config.path << ": "
+                  << (db_ ? sqlite3_errmsg(db_) : "内存不足"));
+        sqlite3_close(db_);
+        db_ = nullptr;
+        return false;
+    }
+
+    sqlite3_busy_timeout(db_, config.checkout_timeout_ms);
+
+    // WAL模式 + NORMAL同步：提交只写WAL，检查点时才同步主库文件
+    if (!execute("PRAGMA journal_mode=WAL") ||
+        !execute("PRAGMA synchronous=NORMAL") ||
+        !execute("PRAGMA foreign_keys=ON")) {
+        sqlite3_close(db_);
+        db_ = nullptr;
+        return false;
+    }
+
+    LOG_INFO(LogSubsystem::STORAGE, "连接到SQLite数据库: " << config.path);
+    return true;
+}
+
+void SqliteStorage::disconnect() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& pair : statements_) {
+        sqlite3_finalize(pair.second);
+    }
+    statements_.clear();
+
+    if (db_) {
+        sqlite3_close(db_);
+        db_ = nullptr;
+    }
+}
+
+bool SqliteStorage::createTables() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!db_) {
+        LOG_ERROR(LogSubsystem::STORAGE, "未连接到数据库");
+        return false;
+    }
+
+    return execute(
+               "CREATE TABLE IF NOT EXISTS users ("
+               "  id INTEGER PRIMARY KEY AUTOINCREMENT,"
+               "  username TEXT UNIQUE NOT NULL,"
+               "  password TEXT NOT NULL,"
+               "  created_at TEXT NOT NULL,"
+               "  last_login TEXT"
+               ")") &&
+           execute(
+               "CREATE TABLE IF NOT EXISTS face_images ("
+               "  id INTEGER PRIMARY KEY AUTOINCREMENT,"
+               "  user_id INTEGER NOT NULL REFERENCES users(id) ON DELETE CASCADE,"
+               "  file_path TEXT NOT NULL,"
+               "  type TEXT NOT NULL CHECK (type IN ('register', 'login')),"
+               "  created_at TEXT NOT NULL"
+               ")") &&
+           execute(
+               "CREATE INDEX IF NOT EXISTS idx_face_images_user_type_created "
+               "ON face_images (user_id, type, created_at)") &&
+           execute(
+               "CREATE TABLE IF NOT EXISTS auth_logs ("
+               "  id INTEGER PRIMARY KEY AUTOINCREMENT,"
+               "  user_id INTEGER NOT NULL REFERENCES users(id) ON DELETE CASCADE,"
+               "  success INTEGER NOT NULL DEFAULT 0,"
+               "  details TEXT,"
+               "  created_at TEXT NOT NULL"
+               ")") &&
+           execute(
+               "CREATE TABLE IF NOT EXISTS wal_checkpoint ("
+               "  source TEXT PRIMARY KEY,"
+               "  sequence INTEGER NOT NULL,"
+               "  updated_at TEXT NOT NULL"
+               ")");
+}
+
+bool SqliteStorage::addUser(const std::string& username, const std::string& password,
+                            const std::vector<FaceImage>& faces) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!db_) {
+        LOG_ERROR(LogSubsystem::STORAGE, "未连接到数据库");
+        return false;
+    }
+
+    if (getUserByUsernameLocked(username).id != 0) {
+        LOG_ERROR(LogSubsystem::STORAGE, "用户名已存在: " << username);
+        return false;
+    }
+
+    sqlite3_stmt* stmt = prepare("INSERT INTO users (username, password, created_at) VALUES (?, ?, ?)");
+    if (!stmt) {
+        return false;
+    }
+
+    if (!execute("BEGIN")) {
+        return false;
+    }
+
+    int user_id = 0;
+    {
+        StatementReset reset(stmt);
+        bindText(stmt, 1, username);
+        bindText(stmt, 2, utils::sha256(password));
+        bindText(stmt, 3, utils::getCurrentTimestamp());
+        executes_++;
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            LOG_ERROR(LogSubsystem::STORAGE, "无法执行语句: " << sqlite3_errmsg(db_));
+            execute("ROLLBACK");
+            return false;
+        }
+        user_id = static_cast<int>(sqlite3_last_insert_rowid(db_));
+    }
+
+    // 用户与注册人脸在同一事务中写入，失败时整体回滚
+    for (const FaceImage& face : faces) {
+        if (!storeFaceDataLocked(user_id, face, "register")) {
+            LOG_ERROR(LogSubsystem::STORAGE, "无法存储用户的人脸数据: " << username);
+            execute("ROLLBACK");
+            return false;
+        }
+    }
+
+    return execute("COMMIT");
+}
+
+bool SqliteStorage::storeFaceData(int user_id, const FaceImage& face, const std::string& type) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!db_) {
+        LOG_ERROR(LogSubsystem::STORAGE, "未连接到数据库");
+        return false;
+    }
+    return storeFaceDataLocked(user_id, face, type);
+}
+
+bool SqliteStorage::storeFaceDataLocked(int user_id, const FaceImage& face, const std::string& type) {
+    std::string file_path = saveFaceFile(face, type);
+    if (file_path.empty()) {
+        return false;
+    }
+
+    sqlite3_stmt* stmt = prepare(INSERT_FACE_IMAGE);
+    if (!stmt) {
+        return false;
+    }
+
+    StatementReset reset(stmt);
+    sqlite3_bind_int(stmt, 1, user_id);
+    bindText(stmt, 2, file_path);
+    bindText(stmt, 3, type);
+    bindText(stmt, 4, utils::getCurrentTimestamp());
+    executes_++;
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        LOG_ERROR(LogSubsystem::STORAGE, "无法执行语句: " << sqlite3_errmsg(db_));
+        return false;
+    }
+    return true;
+}
+
+bool SqliteStorage::updateUserFace(int user_id, const std::vector<FaceImage>& faces) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!db_) {
+        LOG_ERROR(LogSubsystem::STORAGE, "未连接到数据库");
+        return false;
+    }
+
+    if (getUserByIdLocked(user_id).id == 0) {
+        LOG_ERROR(LogSubsystem::STORAGE, "用户未找到: " << user_id);
+        return false;
+    }
+
+    if (!execute("BEGIN")) {
+        return false;
+    }
+    for (const FaceImage& face : faces) {
+        if (!storeFaceDataLocked(user_id, face, "register")) {
+            execute("ROLLBACK");
+            return false;
+        }
+    }
+    return execute("COMMIT");
+}
+
+bool SqliteStorage::forEachUser(const std::function<bool(const UserInfo&)>& visitor) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!db_) {
+        LOG_ERROR(LogSubsystem::STORAGE, "未连接到数据库");
+        return false;
+    }
+
+    sqlite3_stmt* stmt = prepare(SELECT_ALL_USERS.c_str());
+    if (!stmt) {
+        return false;
+    }
+
+    // 逐行步进，结果集不在内存中缓存
+    StatementReset reset(stmt);
+    executes_++;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        if (!visitor(readUser(stmt))) {
+            return true;
+        }
+    }
+
+    if (rc != SQLITE_DONE) {
+        LOG_ERROR(LogSubsystem::STORAGE, "读取用户结果中断: " << sqlite3_errmsg(db_));
+        return false;
+    }
+    return true;
+}
+
+UserInfo SqliteStorage::getUserById(int user_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!db_) {
+        LOG_ERROR(LogSubsystem::STORAGE, "未连接到数据库");
+        UserInfo user;
+        user.id = 0;
+        return user;
+    }
+    return getUserByIdLocked(user_id);
+}
+
+UserInfo SqliteStorage::getUserByIdLocked(int user_id) {
+    UserInfo user;
+    user.id = 0;
+
+    sqlite3_stmt* stmt = prepare(SELECT_USER_BY_ID.c_str());
+    if (!stmt) {
+        return user;
+    }
+
+    StatementReset reset(stmt);
+    sqlite3_bind_int(stmt, 1, user_id);
+    executes_++;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        user = readUser(stmt);
+    }
+    return user;
+}
+
+UserInfo SqliteStorage::getUserByUsername(const std::string& username) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!db_) {
+        LOG_ERROR(LogSubsystem::STORAGE, "未连接到数据库");
+        UserInfo user;
+        user.id = 0;
+        return user;
+    }
+    return getUserByUsernameLocked(username);
+}
+
+UserInfo SqliteStorage::getUserByUsernameLocked(const std::string& username) {
+    UserInfo user;
+    user.id = 0;
+
+    sqlite3_stmt* stmt = prepare(SELECT_USER_BY_NAME.c_str());
+    if (!stmt) {
+        return user;
+    }
+
+    StatementReset reset(stmt);
+    bindText(stmt, 1, username);
+    executes_++;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        user = readUser(stmt);
+    }
+    return user;
+}
+
+std::string SqliteStorage::getUserPassword(int user_id) {
+    return getUserById(user_id).password_hash;
+}
+
+bool SqliteStorage::logAuthentication(int user_id, bool success, const std::string& details) {
+    std::vector<AuthLogEntry> entries(1);
+    entries[0].user_id = user_id;
+    entries[0].success = success;
+    entries[0].details = details;
+    entries[0].created_at = utils::getCurrentTimestamp();
+    return insertAuthLogs(entries);
+}
+
+bool SqliteStorage::updateLastLogin(int user_id) {
+    std::map<int, std::string> last_logins;
+    last_logins[user_id] = utils::getCurrentTimestamp();
+    return updateLastLogins(last_logins);
+}
+
+// 批量写入在单个事务中重复执行缓存的单行语句，只在提交时写一次WAL
+bool SqliteStorage::insertAuthLogs(const std::vector<AuthLogEntry>& entries) {
+    if (entries.empty()) {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!db_) {
+        LOG_ERROR(LogSubsystem::STORAGE, "未连接到数据库");
+        return false;
+    }
+    if (!execute("BEGIN")) {
+        return false;
+    }
+    if (!insertAuthLogsLocked(entries)) {
+        execute("ROLLBACK");
+        return false;
+    }
+    return execute("COMMIT");
+}
+
+bool SqliteStorage::insertLoginRecords(const std::vector<LoginRecord>& records) {
+    if (records.empty()) {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!db_) {
+        LOG_ERROR(LogSubsystem::STORAGE, "未连接到数据库");
+        return false;
+    }
+    if (!execute("BEGIN")) {
+        return false;
+    }
+    if (!insertLoginRecordsLocked(records)) {
+        execute("ROLLBACK");
+        return false;
+    }
+    return execute("COMMIT");
+}
+
+bool SqliteStorage::updateLastLogins(const std::map<int, std::string>& last_logins) {
+    if (last_logins.empty()) {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!db_) {
+        LOG_ERROR(LogSubsystem::STORAGE, "未连接到数据库");
+        return false;
+    }
+    if (!execute("BEGIN")) {
+        return false;
+    }
+    if (!updateLastLoginsLocked(last_logins)) {
+        execute("ROLLBACK");
+        return false;
+    }
+    return execute("COMMIT");
+}
+
+// 在一个事务内写入预写日志段并推进检查点；检查点已不小于该段序号时跳过，崩溃后重放不会重复写入
+bool SqliteStorage::applyAuthEventBatch(const std::string& source, uint64_t sequence,
+                                        const std::vector<AuthLogEntry>& logs,
+                                        const std::vector<LoginRecord>& logins,
+                                        const std::map<int, std::string>& last_logins) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!db_) {
+        LOG_ERROR(LogSubsystem::STORAGE, "未连接到数据库");
+        return false;
+    }
+    if (!execute("BEGIN IMMEDIATE")) {
+        return false;
+    }
+
+    uint64_t checkpoint = 0;
+    bool ok = getAuthEventCheckpointLocked(source, checkpoint);
+    if (ok && checkpoint >= sequence) {
+        execute("ROLLBACK");
+        return true;
+    }
+
+    ok = ok && insertAuthLogsLocked(logs) && insertLoginRecordsLocked(logins) &&
+         updateLastLoginsLocked(last_logins);
+
+    if (ok) {
+        sqlite3_stmt* stmt = prepare(UPSERT_WAL_CHECKPOINT);
+        ok = stmt != nullptr;
+        if (ok) {
+            StatementReset reset(stmt);
+            bindText(stmt, 1, source);
+            sqlite3_bind_int64(stmt, 2, static_cast<sqlite3_int64>(sequence));
+            bindText(stmt, 3, utils::getCurrentTimestamp());
+            executes_++;
+            if (sqlite3_step(stmt) != SQLITE_DONE) {
+                LOG_ERROR(LogSubsystem::STORAGE, "更新预写日志检查点失败: " << sqlite3_errmsg(db_));
+                ok = false;
+            }
+        }
+    }
+
+    if (ok && !execute("COMMIT")) {
+        ok = false;
+    }
+    if (!ok) {
+        execute("ROLLBACK");
+    }
+    return ok;
+}
+
+bool SqliteStorage::getAuthEventCheckpoint(const std::string& source, uint64_t& sequence) {
+    sequence = 0;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!db_) {
+        LOG_ERROR(LogSubsystem::STORAGE, "未连接到数据库");
+        return false;
+    }
+    return getAuthEventCheckpointLocked(source, sequence);
+}
+
+bool SqliteStorage::insertAuthLogsLocked(const std::vector<AuthLogEntry>& entries) {
+    if (entries.empty()) {
+        return true;
+    }
+    sqlite3_stmt* stmt = prepare(INSERT_AUTH_LOG);
+    if (!stmt) {
+        return false;
+    }
+
+    for (const AuthLogEntry& entry : entries) {
+        StatementReset reset(stmt);
+        sqlite3_bind_int(stmt, 1, entry.user_id);
+        sqlite3_bind_int(stmt, 2, entry.success ? 1 : 0);
+        bindText(stmt, 3, entry.details);
+        bindText(stmt, 4, entry.created_at);
+        executes_++;
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            LOG_ERROR(LogSubsystem::STORAGE, "批量写入认证日志失败: " << sqlite3_errmsg(db_));
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SqliteStorage::insertLoginRecordsLocked(const std::vector<LoginRecord>& records) {
+    if (records.empty()) {
+        return true;
+    }
+    sqlite3_stmt* stmt = prepare(INSERT_FACE_IMAGE);
+    if (!stmt) {
+        return false;
+    }
+
+    for (const LoginRecord& record : records) {
+        StatementReset reset(stmt);
+        sqlite3_bind_int(stmt, 1, record.user_id);
+        bindText(stmt, 2, "LOGIN_IMAGE_NOT_SAVED");
+        bindText(stmt, 3, "login");
+        bindText(stmt, 4, record.created_at);
+        executes_++;
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            LOG_ERROR(LogSubsystem::STORAGE, "批量写入登录记录失败: " << sqlite3_errmsg(db_));
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SqliteStorage::updateLastLoginsLocked(const std::map<int, std::string>& last_logins) {
+    if (last_logins.empty()) {
+        return true;
+    }
+    sqlite3_stmt* stmt = prepare(UPDATE_LAST_LOGIN);
+    if (!stmt) {
+        return false;
+    }
+
+    for (const auto& pair : last_logins) {
+        StatementReset reset(stmt);
+        bindText(stmt, 1, pair.second);
+        sqlite3_bind_int(stmt, 2, pair.first);
+        executes_++;
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            LOG_ERROR(LogSubsystem::STORAGE, "批量更新最后登录时间失败: " << sqlite3_errmsg(db_));
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SqliteStorage::getAuthEventCheckpointLocked(const std::string& source, uint64_t& sequence) {
+    sequence = 0;
+    sqlite3_stmt* stmt = prepare(SELECT_WAL_CHECKPOINT);
+    if (!stmt) {
+        return false;
+    }
+
+    StatementReset reset(stmt);
+    bindText(stmt, 1, source);
+    executes_++;
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        sequence = static_cast<uint64_t>(sqlite3_column_int64(stmt, 0));
+    } else if (rc != SQLITE_DONE) {
+        LOG_ERROR(LogSubsystem::STORAGE, "查询预写日志检查点失败: " << sqlite3_errmsg(db_));
+        return false;
+    }
+    return true;
+}
+
+DBStatementStats SqliteStorage::getStatementStats() const {
+    DBStatementStats stats;
+    stats.prepares = prepares_.load();
+    stats.executes = executes_.load();
+    stats.cache_hits = cache_hits_.load();
+    return stats;
+}
+
+sqlite3_stmt* SqliteStorage::prepare(const char* sql) {
+    auto it = statements_.find(sql);
+    if (it != statements_.end()) {
+        cache_hits_++;
+        return it->second;
+    }
+
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        LOG_ERROR(LogSubsystem::STORAGE, "无法准备语句: " << sqlite3_errmsg(db_));
+        sqlite3_finalize(stmt);
+        return nullptr;
+    }
+
+    prepares_++;
+    statements_[sql] = stmt;
+    return stmt;
+}
+
+bool SqliteStorage::execute(const char* sql) {
+    char* error = nullptr;
+    if (sqlite3_exec(db_, sql, nullptr, nullptr, &error) != SQLITE_OK) {
+        LOG_ERROR(LogSubsystem::STORAGE, "SQLite执行失败 (" << sql << "): " << (error ? error : ""));
+        sqlite3_free(error);
+        return false;
+    }
+    return true;
+}
+
+UserInfo SqliteStorage::readUser(sqlite3_stmt* stmt) {
+    UserInfo user;
+    user.id = sqlite3_column_int(stmt, 0);
+    user.username = columnText(stmt, 1);
+    user.password_hash = columnText(stmt, 2);
+    user.created_at = columnText(stmt, 3);
+    user.file_path = columnText(stmt, 4);
+    return user;
+}
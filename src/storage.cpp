@@ -0,0 +1,119 @@
+#include "storage.h"
+#include "logger.h"
+#include "blob_store.h"
+#include "db_manager.h"
+#include "memory_storage.h"
+#ifdef HAVE_SQLITE3
+#include "sqlite_storage.h"
+#endif
+#include <cstring>
+
+DBStatementStats Storage::getStatementStats() const {
+    DBStatementStats stats;
+    stats.prepares = 0;
+    stats.executes = 0;
+    stats.cache_hits = 0;
+    return stats;
+}
+
+bool Storage::runMaintenance() {
+    return true;
+}
+
+bool Storage::applyAuthEventBatch(const std::string& /*source*/, uint64_t /*sequence*/,
+                                  const std::vector<AuthLogEntry>& logs,
+                                  const std::vector<LoginRecord>& logins,
+                                  const std::map<int, std::string>& last_logins) {
+    return insertAuthLogs(logs) && insertLoginRecords(logins) && updateLastLogins(last_logins);
+}
+
+bool Storage::getAuthEventCheckpoint(const std::string& /*source*/, uint64_t& sequence) {
+    sequence = 0;
+    return true;
+}
+
+std::vector<UserInfo> Storage::getAllUsers() {
+    std::vector<UserInfo> users;
+    forEachUser([&users](const UserInfo& user) {
+        users.push_back(user);
+        return true;
+    });
+    return users;
+}
+
+// 按块流式遍历用户，每攒够chunk_size个用户调用一次visitor
+bool Storage::forEachUserChunk(size_t chunk_size,
+                               const std::function<bool(std::vector<UserInfo>&)>& visitor) {
+    if (chunk_size == 0) {
+        chunk_size = 1;
+    }
+    
+    std::vector<UserInfo> chunk;
+    chunk.reserve(chunk_size);
+    bool stopped = false;
+    
+    bool ok = forEachUser([&](const UserInfo& user) {
+        chunk.push_back(user);
+        if (chunk.size() < chunk_size) {
+            return true;
+        }
+        stopped = !visitor(chunk);
+        chunk.clear();
+        chunk.reserve(chunk_size);
+        return !stopped;
+    });
+    
+    if (ok && !stopped && !chunk.empty()) {
+        visitor(chunk);
+    }
+    return ok;
+}
+
+std::unique_ptr<Storage> createStorage(const std::string& backend) {
+    if (backend.empty() || backend == "mysql") {
+        return std::unique_ptr<Storage>(new DBManager());
+    }
+    if (backend == "memory") {
+        return std::unique_ptr<Storage>(new MemoryStorage());
+    }
+    if (backend == "sqlite") {
+#ifdef HAVE_SQLITE3
+        return std::unique_ptr<Storage>(new SqliteStorage());
+#else
+        LOG_ERROR(LogSubsystem::STORAGE, "未编译SQLite存储后端");
+        return nullptr;
+#endif
+    }
+    
+    LOG_ERROR(LogSubsystem::STORAGE, "未知的存储后端: " << backend);
+    return nullptr;
+}
+
+namespace {
+
+const char* const NORMALIZED_FACE_EXTENSION = ".face.png";
+
+} // namespace
+
+std::string saveFaceFile(const FaceImage& face, const std::string& type) {
+    // 登录时不需要实际保存文件，只记录占位路径
+    if (type == "login") {
+        return "LOGIN_IMAGE_NOT_SAVED";
+    }
+    
+    std::string extension = face.normalized ? NORMALIZED_FACE_EXTENSION : BlobStore::imageExtension(face.data);
+    std::string file_path = BlobStore::instance().put(face.data, extension);
+    if (file_path.empty()) {
+        LOG_ERROR(LogSubsystem::STORAGE, "保存人脸图像失败");
+        return "";
+    }
+    
+    LOG_DEBUG(LogSubsystem::STORAGE, "人脸数据保存到：" << file_path << "，大小：" << face.data.size() << " 字节");
+    return file_path;
+}
+
+bool isNormalizedFacePath(const std::string& file_path) {
+    size_t length = strlen(NORMALIZED_FACE_EXTENSION);
+    return file_path.size() > length &&
+           file_path.compare(file_path.size() - length, length, NORMALIZED_FACE_EXTENSION) == 0;
+}
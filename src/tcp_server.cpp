@@ -1,20 +1,25 @@
 #include "tcp_server.h"
-#include "utils.h"
+#include "logger.h"
+#include "metrics.h"
 #include <iostream>
 #include <unistd.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
+#include <poll.h>
 #include <netinet/in.h>
 #include <cstring>
 #include <vector>
 #include <thread>
 #include <sstream>
+#include <chrono>
+#include <memory>
 #include <json/json.h>
-#include <fstream>  // 添加 fstream 头文件
 
-// 协议相关常量
-const size_t HEADER_SIZE = 8; // 消息头大小，用于存储消息长度
-const size_t MAX_BUFFER_SIZE = 1024 * 1024 * 10; // 最大缓冲区大小（10MB）
+namespace {
+
+const size_t MESSAGE_TYPE_COUNT = static_cast<size_t>(MessageType::ERROR) + 1;
+
+} // namespace
 
 TcpServer::TcpServer(AuthServer& auth_server, int port)
     : auth_server_(auth_server), port_(port), server_socket_(-1), running_(false) {
@@ -28,21 +33,21 @@ bool TcpServer::start() {
     std::lock_guard<std::mutex> lock(mutex_);
     
     if (running_) {
-        std::cerr << "服务器已经在运行" << std::endl;
+        LOG_WARN(LogSubsystem::NET, "服务器已经在运行");
         return false;
     }
     
     // 创建套接字
     server_socket_ = socket(AF_INET, SOCK_STREAM, 0);
     if (server_socket_ < 0) {
-        std::cerr << "无法创建套接字: " << strerror(errno) << std::endl;
+        LOG_ERROR(LogSubsystem::NET, "无法创建套接字: " << strerror(errno));
         return false;
     }
     
     // 设置地址重用选项
     int opt = 1;
     if (setsockopt(server_socket_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
-        std::cerr << "无法设置套接字选项: " << strerror(errno) << std::endl;
+        LOG_ERROR(LogSubsystem::NET, "无法设置套接字选项: " << strerror(errno));
         close(server_socket_);
         server_socket_ = -1;
         return false;
@@ -56,7 +61,7 @@ bool TcpServer::start() {
     server_addr.sin_port = htons(port_);
     
     if (bind(server_socket_, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0) {
-        std::cerr << "无法绑定: " << strerror(errno) << std::endl;
+        LOG_ERROR(LogSubsystem::NET, "无法绑定: " << strerror(errno));
         close(server_socket_);
         server_socket_ = -1;
         return false;
@@ -64,17 +69,22 @@ bool TcpServer::start() {
     
     // 开始监听
     if (listen(server_socket_, 5) < 0) {
-        std::cerr << "无法监听: " << strerror(errno) << std::endl;
+        LOG_ERROR(LogSubsystem::NET, "无法监听: " << strerror(errno));
         close(server_socket_);
         server_socket_ = -1;
         return false;
     }
     
+    // 抓包失败不影响服务
+    if (auth_server_.getCaptureConfig().enabled && !capture_.start(auth_server_.getCaptureConfig())) {
+        LOG_WARN(LogSubsystem::NET, "请求抓包启动失败，继续运行");
+    }
+    
     // 启动服务器线程
     running_ = true;
     server_thread_ = std::thread(&TcpServer::serverThread, this);
     
-    std::cout << "TCP服务器在端口 " << port_ << " 启动" << std::endl;
+    LOG_INFO(LogSubsystem::NET, "TCP服务器在端口 " << port_ << " 启动");
     return true;
 }
 
@@ -105,8 +115,9 @@ void TcpServer::stop() {
         }
     }
     client_threads_.clear();
+    capture_.stop();
     
-    std::cout << "TCP服务器已停止" << std::endl;
+    LOG_INFO(LogSubsystem::NET, "TCP服务器已停止");
 }
 
 void TcpServer::serverThread() {
@@ -123,7 +134,7 @@ void TcpServer::serverThread() {
         int activity = select(server_socket_ + 1, &read_fds, NULL, NULL, &timeout);
         
         if (activity < 0 && errno != EINTR) {
-            std::cerr << "Select错误: " << strerror(errno) << std::endl;
+            LOG_ERROR(LogSubsystem::NET, "Select错误: " << strerror(errno));
             break;
         }
         
@@ -137,13 +148,13 @@ void TcpServer::serverThread() {
             
             int client_socket = accept(server_socket_, (struct sockaddr *)&client_addr, &client_len);
             if (client_socket < 0) {
-                std::cerr << "接受失败: " << strerror(errno) << std::endl;
+                LOG_WARN(LogSubsystem::NET, "接受失败: " << strerror(errno));
                 continue;
             }
             
             char client_ip[INET_ADDRSTRLEN];
             inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, INET_ADDRSTRLEN);
-            std::cout << "新连接来自 " << client_ip << ":" << ntohs(client_addr.sin_port) << std::endl;
+            LOG_DEBUG(LogSubsystem::NET, "新连接来自 " << client_ip << ":" << ntohs(client_addr.sin_port));
             
             // 创建客户端线程
             client_threads_.push_back(std::thread(&TcpServer::clientHandler, this, client_socket));
@@ -159,162 +170,95 @@ void TcpServer::clientHandler(int client_socket) {
     setsockopt(client_socket, SOL_SOCKET, SO_RCVTIMEO, (const char*)&tv, sizeof(tv));
     
     try {
-        // 确保必要的目录结构存在
-        utils::createDirectories("face_auth_data/temp");
-        
         // 处理来自客户端的请求
         Message message;
-        if (receiveMessage(client_socket, message)) {
-            processMessage(client_socket, message);
+        std::vector<char> buffer;
+        bool received = auth_server_.parseStage().run([&]() { return receiveMessage(client_socket, buffer, message); });
+        if (received) {
+            processMessage(client_socket, message, buffer);
+        } else {
+            static Counter& receive_errors = MetricsRegistry::instance().counter("face_auth_receive_errors_total");
+            receive_errors.increment();
         }
     } catch (const std::exception& e) {
-        std::cerr << "处理客户端错误: " << e.what() << std::endl;
+        LOG_ERROR(LogSubsystem::NET, "处理客户端错误: " << e.what());
         sendError(client_socket, std::string("服务器错误: ") + e.what());
     }
     
     // 关闭客户端连接
     close(client_socket);
-    std::cout << "客户端连接已关闭" << std::endl;
+    LOG_DEBUG(LogSubsystem::NET, "客户端连接已关闭");
 }
 
-bool TcpServer::receiveMessage(int client_socket, Message& message) {
+bool TcpServer::receiveMessage(int client_socket, std::vector<char>& all_data, Message& message) {
     const int buffer_size = 8192;
     char buffer[buffer_size];
-    std::vector<char> all_data;
     
-    // 接收数据
+    // 按帧头与JSON中的长度精确接收一帧，收齐即解析，不依赖超时判断结束
+    size_t frame_size = 0;
     while (true) {
+        FrameStatus status = takeFrame(all_data, message, frame_size);
+        if (status == FrameStatus::COMPLETE) {
+            break;
+        }
+        if (status == FrameStatus::INVALID) {
+            return false;
+        }
+        
         int received = recv(client_socket, buffer, buffer_size, 0);
         
         if (received < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
             // 接收出错
             if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                std::cerr << "套接字超时" << std::endl;
+                LOG_WARN(LogSubsystem::NET, "套接字超时");
             } else {
-                std::cerr << "接收错误: " << strerror(errno) << std::endl;
+                LOG_WARN(LogSubsystem::NET, "接收错误: " << strerror(errno));
             }
             return false;
         }
         
         if (received == 0) {
             // 连接关闭
-            std::cout << "客户端关闭连接" << std::endl;
+            if (all_data.empty()) {
+                LOG_DEBUG(LogSubsystem::NET, "客户端关闭连接");
+            } else {
+                LOG_WARN(LogSubsystem::NET, "不完整数据: " << all_data.size() << " 字节");
+            }
             return false;
         }
         
         // 添加接收到的数据
         all_data.insert(all_data.end(), buffer, buffer + received);
-        std::cout << "接收到 " << received << " 字节的数据，总计 " << all_data.size() << " 字节" << std::endl;
-        
-        // 检查是否接收完毕
-        if (received < buffer_size) {
-            std::cout << "接收到的数据块小于缓冲区大小，可能已接收完毕" << std::endl;
-            // A more reliable way to check if we're done receiving
-            // 可能已接收完毕，设置短暂超时
-            struct timeval short_timeout;
-            short_timeout.tv_sec = 0;
-            short_timeout.tv_usec = 500000; // 0.5秒
-            setsockopt(client_socket, SOL_SOCKET, SO_RCVTIMEO, (const char*)&short_timeout, sizeof(short_timeout));
-            
-            // 使用MSG_PEEK测试是否还有更多数据
-            char peek_buffer[1];
-            received = recv(client_socket, peek_buffer, 1, MSG_PEEK);
-            
-            // 恢复原超时设置
-            struct timeval timeout;
-            timeout.tv_sec = 60;
-            timeout.tv_usec = 0;
-            setsockopt(client_socket, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
-            
-            if (received <= 0) {
-                // 没有更多数据，结束接收
-                std::cout << "没有更多数据，接收完毕" << std::endl;
-                break;
-            } else {
-                // 还有更多数据，继续接收
-                std::cout << "还有更多数据，继续接收" << std::endl;
-            }
-        }
-    }
-    
-    // 解析接收到的数据
-    if (all_data.size() < 8) {
-        std::cerr << "无效消息: 太小" << std::endl;
-        return false;
-    }
-    
-    // 检查数据包头
-    std::string header(all_data.begin(), all_data.begin() + 4);
-    std::cout << "解析的头部字符串: '" << header << "'" << std::endl;
-    
-    if (header != "FACE") {
-        std::cerr << "无效头部: " << header << std::endl;
-        return false;
-    }
-    
-    // 获取JSON长度
-    int json_length = 0;
-    memcpy(&json_length, all_data.data() + 4, 4);
-    json_length = ntohl(json_length);
-    std::cout << "解析的JSON长度: " << json_length << std::endl;
-    
-    if (json_length <= 0 || all_data.size() < 8 + json_length) {
-        std::cerr << "无效JSON长度或不完整数据: " << json_length << std::endl;
-        return false;
+        LOG_TRACE(LogSubsystem::NET, "接收到 " << received << " 字节的数据，总计 " << all_data.size() << " 字节");
     }
     
-    // 解析JSON数据
-    std::string json_str(all_data.begin() + 8, all_data.begin() + 8 + json_length);
-    std::cout << "JSON数据: " << json_str << std::endl;
-    
-    Json::Value json_obj;
-    Json::Reader reader;
-    if (!reader.parse(json_str, json_obj)) {
-        std::cerr << "无法解析JSON: " << reader.getFormattedErrorMessages() << std::endl;
-        return false;
-    }
+    // 只记录摘要，不输出密码与完整请求
+    auto it_face_data = message.data.find("face_data");
+    LOG_DEBUG(LogSubsystem::NET, "收到请求: " << messageTypeName(message.type) << ", 用户: " << message.data["username"]
+              << ", 人脸数据: " << (it_face_data != message.data.end() ? it_face_data->second.size() : 0) << " 字节");
     
-    // 解析消息类型
-    std::string type = json_obj["type"].asString();
-    if (type == "login") {
-        message.type = MessageType::AUTHENTICATE_USER;
-    } else if (type == "register") {
-        message.type = MessageType::REGISTER_USER;
-    } else {
-        std::cerr << "未知消息类型: " << type << std::endl;
-        return false;
+    return true;
+}
+
+FrameStatus TcpServer::takeFrame(std::vector<char>& buffer, Message& message, size_t& frame_size) {
+    // 已知整帧长度时收齐后再解析，JSON最多解析两次
+    if (frame_size != 0 && buffer.size() < frame_size) {
+        return FrameStatus::INCOMPLETE;
     }
     
-    // 提取数据
-    message.data["username"] = json_obj["username"].asString();
-    message.data["password"] = json_obj["password"].asString();
-    
-    // 提取人脸数据
-    int face_data_size = json_obj["face_data_size"].asInt();
-    if (face_data_size > 0 && all_data.size() >= 8 + json_length + face_data_size) {
-        std::string face_data(all_data.begin() + 8 + json_length, 
-                              all_data.begin() + 8 + json_length + face_data_size);
-        message.data["face_data"] = face_data;
-        
-        // 保存接收到的人脸数据用于调试
-        std::string temp_dir = "face_auth_data/temp";
-        
-        // 确保目录存在
-        if (utils::createDirectories(temp_dir)) {
-            std::string debug_face_file = temp_dir + "/received_face.jpg";
-            std::ofstream face_file(debug_face_file, std::ios::binary);
-            if (face_file.is_open()) {
-                face_file.write(face_data.c_str(), face_data.size());
-                face_file.close();
-                std::cout << "已保存人脸数据到 " << debug_face_file << std::endl;
-            }
-        }
-    } else {
-        std::cerr << "无效人脸数据大小或不完整数据" << std::endl;
-        return false;
+    FrameStatus status = protocol::parseRequestFrame(buffer.data(), buffer.size(), message, &frame_size);
+    if (status == FrameStatus::COMPLETE) {
+        capture_.offer(buffer.data(), frame_size);
+        auth_server_.getFrameRing().offer(buffer.data(), frame_size);
+        buffer.erase(buffer.begin(), buffer.begin() + frame_size);
+        frame_size = 0;
+    } else if (status == FrameStatus::INCOMPLETE && frame_size != 0) {
+        buffer.reserve(frame_size);
     }
-    
-    return true;
+    return status;
 }
 
 bool TcpServer::sendMessage(int client_socket, const Message& message) {
@@ -340,7 +284,7 @@ bool TcpServer::sendMessage(int client_socket, const Message& message) {
     } else if (message.type == MessageType::ERROR) {
         json_response["type"] = "error";
     } else {
-        std::cerr << "发送无效消息类型" << std::endl;
+        LOG_ERROR(LogSubsystem::NET, "发送无效消息类型");
         return false;
     }
     
@@ -351,31 +295,16 @@ bool TcpServer::sendMessage(int client_socket, const Message& message) {
         }
     }
     
-    // 打印发送的响应内容
-    std::cout << "发送响应: " << json_response.toStyledString() << std::endl;
-    
-    // 序列化JSON
-    Json::FastWriter writer;
-    std::string json_str = writer.write(json_response);
-    
-    // 构造响应数据包
-    std::vector<char> packet;
-    
-    // 添加包头 - 保持与Python版本一致，使用'RESP'作为头
-    packet.insert(packet.end(), {'R', 'E', 'S', 'P'});
-    
-    // 添加JSON长度 (网络字节序)
-    uint32_t json_length = static_cast<uint32_t>(json_str.length());
-    uint32_t net_length = htonl(json_length);
-    const char* length_bytes = reinterpret_cast<const char*>(&net_length);
-    packet.insert(packet.end(), length_bytes, length_bytes + 4);
-    
-    // 添加JSON数据
-    packet.insert(packet.end(), json_str.begin(), json_str.end());
+    return sendJson(client_socket, json_response);
+}
+
+bool TcpServer::sendJson(int client_socket, const Json::Value& json_response) {
+    std::string packet = protocol::buildResponseFrame(json_response);
     
-    std::cout << "准备发送响应: " << json_response["type"].asString() 
-              << ", 成功: " << json_response["success"]
-              << ", 大小: " << packet.size() << " 字节" << std::endl;
+    LOG_DEBUG(LogSubsystem::NET, "发送响应: " << json_response["type"].asString()
+              << ", 成功: " << json_response["success"].asString()
+              << ", 消息: " << json_response["message"].asString()
+              << ", 大小: " << packet.size() << " 字节");
     
     // 发送数据 
     const size_t chunk_size = 4096;
@@ -392,22 +321,30 @@ bool TcpServer::sendMessage(int client_socket, const Message& message) {
                 usleep(1000);
                 continue;
             }
-            std::cerr << "发送错误: " << strerror(errno) << std::endl;
+            LOG_WARN(LogSubsystem::NET, "发送错误: " << strerror(errno));
             return false;
         }
         
         total_sent += sent;
-        std::cout << "已发送 " << sent << " 字节，总计 " << total_sent << "/" << packet.size() << std::endl;
+        LOG_TRACE(LogSubsystem::NET, "已发送 " << sent << " 字节，总计 " << total_sent << "/" << packet.size());
     }
     
-    std::cout << "响应已完全发送: " << total_sent << " 字节" << std::endl;
-    // 等待一小段时间确保数据发送完成
-    usleep(100000); // 0.1秒
-    
+    LOG_TRACE(LogSubsystem::NET, "响应已完全发送: " << total_sent << " 字节");
     return true;
 }
 
-void TcpServer::processMessage(int client_socket, const Message& message) {
+void TcpServer::processMessage(int client_socket, const Message& message, std::vector<char>& buffer) {
+    // 按请求类型统计次数与处理延迟（不含接收）
+    static EnumMetricCache<Counter, MessageType, MESSAGE_TYPE_COUNT> requests([](MessageType type) -> Counter& {
+        return MetricsRegistry::instance().counter("face_auth_requests_total", "type", messageTypeName(type));
+    });
+    static EnumMetricCache<LatencyHistogram, MessageType, MESSAGE_TYPE_COUNT> latencies(
+        [](MessageType type) -> LatencyHistogram& {
+            return MetricsRegistry::instance().histogram("face_auth_request_latency_us", "type", messageTypeName(type));
+        });
+    requests[message.type].increment();
+    ScopedLatency latency(latencies[message.type]);
+    
     switch (message.type) {
         case MessageType::REGISTER_USER:
             handleRegister(client_socket, message);
@@ -415,8 +352,23 @@ void TcpServer::processMessage(int client_socket, const Message& message) {
         case MessageType::AUTHENTICATE_USER:
             handleAuthenticate(client_socket, message);
             break;
+        case MessageType::ENROLLMENT_STATUS:
+            handleEnrollmentStatus(client_socket, message);
+            break;
+        case MessageType::STATS:
+            handleStats(client_socket);
+            break;
+        case MessageType::SESSION_LOGIN:
+            handleSession(client_socket, message, buffer);
+            break;
+        case MessageType::TOKEN_AUTH:
+            handleTokenAuth(client_socket, message);
+            break;
+        case MessageType::TOKEN_REVOKE:
+            handleTokenRevoke(client_socket, message);
+            break;
         default:
-            std::cerr << "未知消息类型" << std::endl;
+            LOG_WARN(LogSubsystem::NET, "未知消息类型");
             sendError(client_socket, "未知消息类型");
             break;
     }
@@ -439,6 +391,12 @@ void TcpServer::handleRegister(int client_socket, const Message& message) {
     // 创建包含请求类型的响应数据
     std::map<std::string, std::string> additional_data;
     additional_data["request_type"] = "register";
+    if (result.isMember("enrollment_status")) {
+        additional_data["enrollment_status"] = result["enrollment_status"].asString();
+    }
+    if (result.isMember("quality")) {
+        additional_data["quality"] = result["quality"].asString();
+    }
     
     // 发送响应
     sendResponse(client_socket, result["success"].asBool(), result["message"].asString(), additional_data);
@@ -470,10 +428,199 @@ void TcpServer::handleAuthenticate(int client_socket, const Message& message) {
     if (success && result.isMember("face_verified")) {
         additional_data["face_verified"] = result["face_verified"].asBool() ? "true" : "false";
     }
+    if (result.isMember("token")) {
+        additional_data["token"] = result["token"].asString();
+        additional_data["token_expires"] = std::to_string(result["token_expires"].asInt64());
+    }
+    if (result.isMember("quality")) {
+        additional_data["quality"] = result["quality"].asString();
+    }
     
     sendResponse(client_socket, success, message_text, additional_data);
 }
 
+void TcpServer::handleSession(int client_socket, const Message& message, std::vector<char>& buffer) {
+    auto it_username = message.data.find("username");
+    auto it_password = message.data.find("password");
+    auto it_face_data = message.data.find("face_data");
+    
+    if (it_username == message.data.end() || it_password == message.data.end() ||
+        it_face_data == message.data.end()) {
+        sendError(client_socket, "缺少认证所需的参数");
+        drainConnection(client_socket);
+        return;
+    }
+    
+    Json::Value response;
+    std::shared_ptr<AuthSession> session = auth_server_.startSession(it_username->second, it_password->second, response);
+    if (!session) {
+        std::map<std::string, std::string> additional_data;
+        additional_data["request_type"] = "login_session";
+        sendResponse(client_socket, false, response["message"].asString(), additional_data);
+        // 客户端可能已发出后续帧，读掉后再关闭，避免RST冲掉响应
+        drainConnection(client_socket);
+        return;
+    }
+    auth_server_.scoreSessionFrame(session, it_face_data->second);
+    
+    // 同时等待客户端的后续帧与会话判定；timeout_ms限制整个会话（包括结束发送后等待评分），
+    // 到期时不再等待评分中的帧，按已有证据判定
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(auth_server_.getSessionConfig().timeout_ms);
+    bool receiving = true;
+    bool peer_closed = false;
+    std::string error;
+    size_t frame_size = 0;
+    char chunk[8192];
+    while (!session->isDecided()) {
+        struct pollfd fds[2];
+        fds[0].fd = session->notifyFd();
+        fds[0].events = POLLIN;
+        fds[1].fd = receiving ? client_socket : -1;
+        fds[1].events = POLLIN;
+        
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+        int ready = poll(fds, 2, remaining > 0 ? static_cast<int>(remaining) : 0);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_WARN(LogSubsystem::NET, "会话poll错误: " << strerror(errno));
+            session->cancel();
+            break;
+        }
+        if (ready == 0) {
+            LOG_DEBUG(LogSubsystem::NET, "会话超时，按已评分的帧判定");
+            receiving = false;
+            session->expire();
+            continue;
+        }
+        if (!receiving || !(fds[1].revents & (POLLIN | POLLHUP | POLLERR))) {
+            continue;
+        }
+        
+        int received = recv(client_socket, chunk, sizeof(chunk), 0);
+        if (received < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) {
+                continue;
+            }
+            LOG_WARN(LogSubsystem::NET, "会话接收错误: " << strerror(errno));
+            session->cancel();
+            break;
+        }
+        if (received == 0) {
+            // 客户端关闭发送方向，视为不再有帧，仍尝试返回结果
+            receiving = false;
+            peer_closed = true;
+            session->endOfStream();
+            continue;
+        }
+        buffer.insert(buffer.end(), chunk, chunk + received);
+        
+        while (receiving) {
+            Message frame;
+            FrameStatus status = takeFrame(buffer, frame, frame_size);
+            if (status == FrameStatus::INCOMPLETE) {
+                break;
+            }
+            if (status == FrameStatus::INVALID || frame.type == MessageType::SESSION_LOGIN) {
+                LOG_WARN(LogSubsystem::NET, "会话中收到无效帧");
+                error = "无效的会话帧";
+                session->cancel();
+                receiving = false;
+                break;
+            }
+            if (frame.type == MessageType::SESSION_END) {
+                receiving = false;
+                session->endOfStream();
+            } else if (frame.type == MessageType::SESSION_FRAME) {
+                auth_server_.scoreSessionFrame(session, frame.data["face_data"]);
+            } else {
+                // 会话中只接受会话帧，其他请求视为结束
+                receiving = false;
+                session->endOfStream();
+            }
+        }
+    }
+    
+    Json::Value result = auth_server_.finishSession(session);
+    if (session->decision() == SessionDecision::CANCELLED) {
+        if (!error.empty()) {
+            sendError(client_socket, error);
+            drainConnection(client_socket);
+        }
+        return;
+    }
+    
+    std::map<std::string, std::string> additional_data;
+    additional_data["request_type"] = "login_session";
+    additional_data["face_verified"] = result["face_verified"].asBool() ? "true" : "false";
+    additional_data["frames"] = std::to_string(result["frames"].asUInt64());
+    if (result.isMember("token")) {
+        additional_data["token"] = result["token"].asString();
+        additional_data["token_expires"] = std::to_string(result["token_expires"].asInt64());
+    }
+    sendResponse(client_socket, result["success"].asBool(), result["message"].asString(), additional_data);
+    
+    if (!peer_closed) {
+        drainConnection(client_socket);
+    }
+}
+
+void TcpServer::drainConnection(int client_socket) {
+    shutdown(client_socket, SHUT_WR);
+    
+    // 最多等待1秒、丢弃一帧上限的数据
+    const size_t max_bytes = protocol::MAX_FRAME_SIZE;
+    size_t drained = 0;
+    char chunk[8192];
+    while (drained < max_bytes) {
+        struct pollfd fd;
+        fd.fd = client_socket;
+        fd.events = POLLIN;
+        if (poll(&fd, 1, 1000) <= 0) {
+            break;
+        }
+        int received = recv(client_socket, chunk, sizeof(chunk), 0);
+        if (received <= 0) {
+            break;
+        }
+        drained += static_cast<size_t>(received);
+    }
+}
+
+void TcpServer::handleTokenAuth(int client_socket, const Message& message) {
+    auto it_token = message.data.find("token");
+    if (it_token == message.data.end()) {
+        sendError(client_socket, "缺少令牌");
+        return;
+    }
+    
+    Json::Value result = auth_server_.verifyToken(it_token->second);
+    
+    std::map<std::string, std::string> additional_data;
+    additional_data["request_type"] = "token_auth";
+    if (result["success"].asBool()) {
+        additional_data["user_id"] = std::to_string(result["user_id"].asInt());
+        additional_data["token_expires"] = std::to_string(result["token_expires"].asInt64());
+    }
+    sendResponse(client_socket, result["success"].asBool(), result["message"].asString(), additional_data);
+}
+
+void TcpServer::handleTokenRevoke(int client_socket, const Message& message) {
+    auto it_token = message.data.find("token");
+    if (it_token == message.data.end()) {
+        sendError(client_socket, "缺少令牌");
+        return;
+    }
+    
+    Json::Value result = auth_server_.revokeToken(it_token->second);
+    
+    std::map<std::string, std::string> additional_data;
+    additional_data["request_type"] = "token_revoke";
+    sendResponse(client_socket, result["success"].asBool(), result["message"].asString(), additional_data);
+}
+
 void TcpServer::handleUpdateFace(int client_socket, const Message& message) {
     // 获取请求参数
     auto it_user_id = message.data.find("user_id");
@@ -500,6 +647,58 @@ void TcpServer::handleUpdateFace(int client_socket, const Message& message) {
     sendResponse(client_socket, result["success"].asBool(), result["message"].asString());
 }
 
+void TcpServer::handleEnrollmentStatus(int client_socket, const Message& message) {
+    // 获取请求参数
+    auto it_username = message.data.find("username");
+    auto it_password = message.data.find("password");
+    
+    if (it_username == message.data.end() || it_password == message.data.end()) {
+        sendError(client_socket, "缺少查询所需的参数");
+        return;
+    }
+    
+    Json::Value result = auth_server_.enrollmentStatus(it_username->second, it_password->second);
+    
+    std::map<std::string, std::string> additional_data;
+    additional_data["request_type"] = "enrollment_status";
+    if (result.isMember("status")) {
+        additional_data["status"] = result["status"].asString();
+    }
+    
+    sendResponse(client_socket, result["success"].asBool(), result["message"].asString(), additional_data);
+}
+
+void TcpServer::handleStats(int client_socket) {
+    if (!auth_server_.isStatsMessageEnabled()) {
+        sendError(client_socket, "统计查询未启用");
+        return;
+    }
+    
+    // 统计数据是嵌套的JSON，不经过字符串键值的Message
+    Json::Value response = auth_server_.getStats();
+    response["type"] = "stats";
+    response["success"] = true;
+    sendJson(client_socket, response);
+}
+
+const char* TcpServer::messageTypeName(MessageType type) {
+    switch (type) {
+        case MessageType::REGISTER_USER: return "register";
+        case MessageType::AUTHENTICATE_USER: return "login";
+        case MessageType::UPDATE_USER_FACE: return "update_face";
+        case MessageType::ENROLLMENT_STATUS: return "enrollment_status";
+        case MessageType::STATS: return "stats";
+        case MessageType::SESSION_LOGIN: return "login_session";
+        case MessageType::SESSION_FRAME: return "session_frame";
+        case MessageType::SESSION_END: return "session_end";
+        case MessageType::TOKEN_AUTH: return "token_auth";
+        case MessageType::TOKEN_REVOKE: return "token_revoke";
+        case MessageType::RESPONSE: return "response";
+        case MessageType::ERROR: return "error";
+    }
+    return "unknown";
+}
+
 void TcpServer::sendResponse(int client_socket, bool success, const std::string& message_text, 
                            const std::map<std::string, std::string>& data) {
     Message response;
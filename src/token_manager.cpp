@@ -0,0 +1,203 @@
+#include "token_manager.h"
+#include "logger.h"
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+#include <ctime>
+#include <vector>
+
+namespace {
+
+const char* TOKEN_VERSION = "v1";
+const size_t TOKEN_ID_BYTES = 8;
+const size_t KEY_BYTES = 32;
+const size_t SIGNATURE_HEX_LENGTH = 64;   // HMAC-SHA256
+
+std::string toHex(const unsigned char* data, size_t length) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(length * 2);
+    for (size_t i = 0; i < length; ++i) {
+        hex.push_back(digits[data[i] >> 4]);
+        hex.push_back(digits[data[i] & 0x0f]);
+    }
+    return hex;
+}
+
+bool isHex(const std::string& text, size_t length) {
+    if (text.size() != length) {
+        return false;
+    }
+    for (char c : text) {
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 非负十进制整数，最多max_digits位
+bool parseNumber(const std::string& text, size_t max_digits, int64_t& value) {
+    if (text.empty() || text.size() > max_digits) {
+        return false;
+    }
+    value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        value = value * 10 + (c - '0');
+    }
+    return true;
+}
+
+int64_t now() {
+    return static_cast<int64_t>(std::time(nullptr));
+}
+
+} // namespace
+
+TokenManager::TokenManager() : revoked_count_(0) {
+}
+
+bool TokenManager::configure(const TokenConfig& config) {
+    config_ = config;
+    if (!config_.secret.empty()) {
+        key_ = config_.secret;
+        return true;
+    }
+
+    unsigned char key[KEY_BYTES];
+    if (RAND_bytes(key, sizeof(key)) != 1) {
+        LOG_ERROR(LogSubsystem::AUTH, "无法生成令牌密钥");
+        return false;
+    }
+    key_.assign(reinterpret_cast<const char*>(key), sizeof(key));
+    if (config_.enabled) {
+        LOG_WARN(LogSubsystem::AUTH, "未配置令牌密钥，使用随机密钥，重启后已签发的令牌失效");
+    }
+    return true;
+}
+
+std::string TokenManager::issue(int user_id, int64_t* expires) const {
+    unsigned char id[TOKEN_ID_BYTES];
+    if (RAND_bytes(id, sizeof(id)) != 1) {
+        return std::string();
+    }
+    int64_t expiry = now() + config_.ttl_seconds;
+    if (expires) {
+        *expires = expiry;
+    }
+    std::string payload = std::string(TOKEN_VERSION) + "." + std::to_string(user_id) + "." +
+                          std::to_string(static_cast<long long>(expiry)) + "." + toHex(id, sizeof(id));
+    return payload + "." + sign(payload);
+}
+
+TokenStatus TokenManager::verify(const std::string& token, TokenClaims& claims) const {
+    // v1.<用户ID>.<过期时间>.<令牌ID>.<签名>
+    std::vector<std::string> parts;
+    size_t start = 0;
+    while (parts.size() < 6) {
+        size_t dot = token.find('.', start);
+        parts.push_back(token.substr(start, dot == std::string::npos ? std::string::npos : dot - start));
+        if (dot == std::string::npos) {
+            break;
+        }
+        start = dot + 1;
+    }
+    int64_t user_id = 0;
+    int64_t expires = 0;
+    if (parts.size() != 5 || parts[0] != TOKEN_VERSION || !parseNumber(parts[1], 10, user_id) ||
+        user_id <= 0 || user_id > 0x7fffffff || !parseNumber(parts[2], 18, expires) ||
+        !isHex(parts[3], TOKEN_ID_BYTES * 2) || !isHex(parts[4], SIGNATURE_HEX_LENGTH)) {
+        return TokenStatus::MALFORMED;
+    }
+
+    // 先验签名再看过期与吊销，伪造的令牌不会得到更具体的结果
+    size_t payload_length = token.size() - parts[4].size() - 1;
+    std::string expected = sign(token.substr(0, payload_length));
+    if (CRYPTO_memcmp(expected.data(), parts[4].data(), expected.size()) != 0) {
+        return TokenStatus::BAD_SIGNATURE;
+    }
+    if (expires <= now()) {
+        return TokenStatus::EXPIRED;
+    }
+    if (isRevoked(parts[3])) {
+        return TokenStatus::REVOKED;
+    }
+
+    claims.user_id = static_cast<int>(user_id);
+    claims.expires = expires;
+    claims.id = parts[3];
+    return TokenStatus::VALID;
+}
+
+bool TokenManager::revoke(const std::string& token) {
+    TokenClaims claims;
+    TokenStatus status = verify(token, claims);
+    if (status == TokenStatus::REVOKED) {
+        return true;
+    }
+    if (status != TokenStatus::VALID) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    purgeExpiredLocked(now());
+    if (config_.revocation_capacity == 0) {
+        return false;
+    }
+    if (revoked_.size() >= config_.revocation_capacity) {
+        // 已满时淘汰最早过期的条目，被淘汰的令牌在剩余的有效期内重新有效
+        auto soonest = revoked_.begin();
+        for (auto it = revoked_.begin(); it != revoked_.end(); ++it) {
+            if (it->second < soonest->second) {
+                soonest = it;
+            }
+        }
+        LOG_WARN(LogSubsystem::AUTH, "令牌吊销列表已满（" << revoked_.size() << "），淘汰 "
+                 << (soonest->second - now()) << " 秒后过期的条目");
+        revoked_.erase(soonest);
+    }
+    revoked_[claims.id] = claims.expires;
+    revoked_count_.store(revoked_.size(), std::memory_order_relaxed);
+    return true;
+}
+
+const char* TokenManager::statusName(TokenStatus status) {
+    switch (status) {
+        case TokenStatus::VALID: return "valid";
+        case TokenStatus::MALFORMED: return "malformed";
+        case TokenStatus::BAD_SIGNATURE: return "bad_signature";
+        case TokenStatus::EXPIRED: return "expired";
+        case TokenStatus::REVOKED: return "revoked";
+    }
+    return "unknown";
+}
+
+std::string TokenManager::sign(const std::string& payload) const {
+    unsigned char mac[EVP_MAX_MD_SIZE];
+    unsigned int mac_length = 0;
+    HMAC(EVP_sha256(), key_.data(), static_cast<int>(key_.size()),
+         reinterpret_cast<const unsigned char*>(payload.data()), payload.size(), mac, &mac_length);
+    return toHex(mac, mac_length);
+}
+
+bool TokenManager::isRevoked(const std::string& id) const {
+    if (revoked_count_.load(std::memory_order_relaxed) == 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    return revoked_.count(id) != 0;
+}
+
+void TokenManager::purgeExpiredLocked(int64_t current) {
+    for (auto it = revoked_.begin(); it != revoked_.end();) {
+        if (it->second <= current) {
+            it = revoked_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
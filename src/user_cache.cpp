@@ -0,0 +1,209 @@
+#include "user_cache.h"
+#include "logger.h"
+#include <algorithm>
+#include <functional>
+#include <deque>
+#include <thread>
+#include <condition_variable>
+
+UserCache::UserCache()
+    : shard_capacity_(0), hits_(0), misses_(0), expirations_(0), evictions_(0) {
+    configure(config_);
+}
+
+void UserCache::configure(const UserCacheConfig& config) {
+    config_ = config;
+
+    // 分片数取2的幂，便于用掩码定位分片
+    size_t shard_count = 1;
+    while (shard_count < config_.shards) {
+        shard_count <<= 1;
+    }
+    config_.shards = shard_count;
+    shard_capacity_ = std::max<size_t>(1, (config_.capacity + shard_count - 1) / shard_count);
+
+    shards_.clear();
+    for (size_t i = 0; i < shard_count; ++i) {
+        shards_.push_back(std::unique_ptr<Shard>(new Shard()));
+    }
+}
+
+size_t UserCache::warm(Storage& storage) {
+    if (!config_.enabled) {
+        return 0;
+    }
+
+    size_t thread_count = std::max<size_t>(1, config_.warm_threads);
+    // 待处理块的上限，读取速度快于写入时阻塞读取线程，内存占用不随用户数增长
+    size_t max_pending = thread_count * 2;
+
+    std::deque<std::vector<UserInfo>> pending;
+    std::mutex mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    bool done = false;
+    std::atomic<size_t> loaded(0);
+
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < thread_count; ++i) {
+        workers.push_back(std::thread([&]() {
+            while (true) {
+                std::vector<UserInfo> chunk;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    not_empty.wait(lock, [&]() { return done || !pending.empty(); });
+                    if (pending.empty()) {
+                        return;
+                    }
+                    chunk = std::move(pending.front());
+                    pending.pop_front();
+                }
+                not_full.notify_one();
+
+                for (const UserInfo& user : chunk) {
+                    put(user);
+                }
+                loaded += chunk.size();
+            }
+        }));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    bool ok = storage.forEachUserChunk(config_.warm_chunk_size, [&](std::vector<UserInfo>& chunk) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [&]() { return pending.size() < max_pending; });
+        pending.push_back(std::move(chunk));
+        not_empty.notify_one();
+        return true;
+    });
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+    }
+    not_empty.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    if (!ok) {
+        LOG_WARN(LogSubsystem::STORAGE, "用户目录缓存预热未完成，已载入 " << loaded.load() << " 个用户");
+    } else {
+        LOG_INFO(LogSubsystem::STORAGE, "用户目录缓存已预热，用户数: " << loaded.load()
+                  << ", 耗时: " << elapsed << "ms");
+    }
+    return loaded.load();
+}
+
+bool UserCache::get(const std::string& username, UserInfo& user) {
+    if (!config_.enabled) {
+        return false;
+    }
+
+    Shard& shard = shardFor(username);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(username);
+    if (it == shard.index.end()) {
+        misses_++;
+        return false;
+    }
+
+    if (std::chrono::steady_clock::now() >= it->second->expires_at) {
+        shard.lru.erase(it->second);
+        shard.index.erase(it);
+        expirations_++;
+        misses_++;
+        return false;
+    }
+
+    // 移到链表头部
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    user = it->second->user;
+    hits_++;
+    return true;
+}
+
+void UserCache::put(const UserInfo& user) {
+    store(user, true);
+}
+
+void UserCache::fill(const UserInfo& user) {
+    store(user, false);
+}
+
+void UserCache::store(const UserInfo& user, bool overwrite) {
+    if (!config_.enabled || user.id <= 0) {
+        return;
+    }
+
+    Shard& shard = shardFor(user.username);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto now = std::chrono::steady_clock::now();
+    auto expires_at = now + std::chrono::seconds(config_.ttl_seconds);
+
+    auto it = shard.index.find(user.username);
+    if (it != shard.index.end()) {
+        if (!overwrite && now < it->second->expires_at) {
+            return;
+        }
+        it->second->user = user;
+        it->second->expires_at = expires_at;
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        return;
+    }
+
+    Entry entry;
+    entry.user = user;
+    entry.expires_at = expires_at;
+    shard.lru.push_front(entry);
+    shard.index[user.username] = shard.lru.begin();
+
+    // 超出分片容量时淘汰最久未使用的条目
+    while (shard.lru.size() > shard_capacity_) {
+        shard.index.erase(shard.lru.back().user.username);
+        shard.lru.pop_back();
+        evictions_++;
+    }
+}
+
+void UserCache::erase(const std::string& username) {
+    Shard& shard = shardFor(username);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(username);
+    if (it != shard.index.end()) {
+        shard.lru.erase(it->second);
+        shard.index.erase(it);
+    }
+}
+
+void UserCache::clear() {
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->lru.clear();
+        shard->index.clear();
+    }
+}
+
+UserCacheStats UserCache::getStats() const {
+    UserCacheStats stats;
+    stats.hits = hits_.load();
+    stats.misses = misses_.load();
+    stats.expirations = expirations_.load();
+    stats.evictions = evictions_.load();
+    stats.size = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        stats.size += shard->lru.size();
+    }
+    return stats;
+}
+
+UserCache::Shard& UserCache::shardFor(const std::string& username) {
+    size_t hash = std::hash<std::string>()(username);
+    return *shards_[hash & (shards_.size() - 1)];
+}
@@ -10,116 +10,352 @@
 #include <fstream>
 #include <errno.h>
 #include <string.h>
+#include <stdint.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 namespace utils {
 
 // Base64编码表
-static const std::string base64_chars = 
+static const char base64_chars[] =
     "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
-// 判断字符是否为Base64字符
-static inline bool is_base64(unsigned char c) {
-    return (isalnum(c) || (c == '+') || (c == '/'));
+// Base64解码表，0xFF表示非Base64字符
+static const unsigned char BASE64_INVALID = 0xFF;
+
+struct Base64DecodeTable {
+    unsigned char values[256];
+
+    Base64DecodeTable() {
+        memset(values, BASE64_INVALID, sizeof(values));
+        for (int i = 0; i < 64; ++i) {
+            values[static_cast<unsigned char>(base64_chars[i])] = static_cast<unsigned char>(i);
+        }
+    }
+};
+
+static const Base64DecodeTable base64_table;
+
+// 标量编码：处理SIMD路径剩余的尾部数据
+static size_t base64EncodeScalar(const unsigned char* data, size_t length, char* out) {
+    char* p = out;
+    size_t i = 0;
+
+    for (; i + 3 <= length; i += 3) {
+        uint32_t v = (uint32_t(data[i]) << 16) | (uint32_t(data[i + 1]) << 8) | data[i + 2];
+        *p++ = base64_chars[(v >> 18) & 0x3f];
+        *p++ = base64_chars[(v >> 12) & 0x3f];
+        *p++ = base64_chars[(v >> 6) & 0x3f];
+        *p++ = base64_chars[v & 0x3f];
+    }
+
+    size_t rest = length - i;
+    if (rest) {
+        uint32_t v = uint32_t(data[i]) << 16;
+        if (rest == 2) {
+            v |= uint32_t(data[i + 1]) << 8;
+        }
+        *p++ = base64_chars[(v >> 18) & 0x3f];
+        *p++ = base64_chars[(v >> 12) & 0x3f];
+        *p++ = (rest == 2) ? base64_chars[(v >> 6) & 0x3f] : '=';
+        *p++ = '=';
+    }
+
+    return p - out;
 }
 
-std::string base64Encode(const unsigned char* data, size_t length) {
-    std::string ret;
-    int i = 0;
-    int j = 0;
-    unsigned char char_array_3[3];
-    unsigned char char_array_4[4];
-
-    while (length--) {
-        char_array_3[i++] = *(data++);
-        if (i == 3) {
-            char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-            char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-            char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-            char_array_4[3] = char_array_3[2] & 0x3f;
-
-            for(i = 0; i < 4; i++)
-                ret += base64_chars[char_array_4[i]];
-            i = 0;
+// 标量解码：遇到'='或非Base64字符即停止（与旧实现行为一致）
+static size_t base64DecodeScalar(const char* in, size_t length, unsigned char* out) {
+    unsigned char* p = out;
+    uint32_t acc = 0;
+    int count = 0;
+
+    for (size_t i = 0; i < length; ++i) {
+        unsigned char v = base64_table.values[static_cast<unsigned char>(in[i])];
+        if (v == BASE64_INVALID) {
+            break;
+        }
+        acc = (acc << 6) | v;
+        if (++count == 4) {
+            *p++ = static_cast<unsigned char>(acc >> 16);
+            *p++ = static_cast<unsigned char>(acc >> 8);
+            *p++ = static_cast<unsigned char>(acc);
+            acc = 0;
+            count = 0;
         }
     }
 
-    if (i) {
-        for(j = i; j < 3; j++)
-            char_array_3[j] = '\0';
+    // 不完整的最后一组：n个字符产生n-1个字节
+    if (count > 1) {
+        acc <<= 6 * (4 - count);
+        *p++ = static_cast<unsigned char>(acc >> 16);
+        if (count > 2) {
+            *p++ = static_cast<unsigned char>(acc >> 8);
+        }
+    }
 
-        char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-        char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-        char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-        char_array_4[3] = char_array_3[2] & 0x3f;
+    return p - out;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// SSSE3编码：每次处理12字节输入，输出16个字符（需要至少16字节可读）
+__attribute__((target("ssse3")))
+static size_t base64EncodeSSSE3(const unsigned char* data, size_t length, char* out) {
+    size_t i = 0;
+    char* p = out;
+
+    while (i + 16 <= length) {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+
+        // 每个32位通道排列为 [b1, b0, b2, b1]
+        in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+
+        // 拆分出4个6位索引
+        __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+        __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+        __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+        __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+        __m128i idx = _mm_or_si128(t1, t3);
+
+        // 索引转ASCII：按区间累加偏移
+        __m128i shift = _mm_set1_epi8(65);
+        shift = _mm_add_epi8(shift, _mm_and_si128(_mm_cmpgt_epi8(idx, _mm_set1_epi8(25)), _mm_set1_epi8(6)));
+        shift = _mm_add_epi8(shift, _mm_and_si128(_mm_cmpgt_epi8(idx, _mm_set1_epi8(51)), _mm_set1_epi8(-75)));
+        shift = _mm_add_epi8(shift, _mm_and_si128(_mm_cmpeq_epi8(idx, _mm_set1_epi8(62)), _mm_set1_epi8(-15)));
+        shift = _mm_add_epi8(shift, _mm_and_si128(_mm_cmpeq_epi8(idx, _mm_set1_epi8(63)), _mm_set1_epi8(-12)));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_add_epi8(idx, shift));
+        i += 12;
+        p += 16;
+    }
 
-        for (j = 0; j < i + 1; j++)
-            ret += base64_chars[char_array_4[j]];
+    return (p - out) + base64EncodeScalar(data + i, length - i, p);
+}
 
-        while((i++ < 3))
-            ret += '=';
+// AVX2编码：每次处理24字节输入，输出32个字符（需要至少28字节可读）
+__attribute__((target("avx2")))
+static size_t base64EncodeAVX2(const unsigned char* data, size_t length, char* out) {
+    size_t i = 0;
+    char* p = out;
+
+    while (i + 28 <= length) {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 12));
+        __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+
+        in = _mm256_shuffle_epi8(in, _mm256_set_epi8(
+            10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+            10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+
+        __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+        __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+        __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+        __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+        __m256i idx = _mm256_or_si256(t1, t3);
+
+        __m256i shift = _mm256_set1_epi8(65);
+        shift = _mm256_add_epi8(shift, _mm256_and_si256(_mm256_cmpgt_epi8(idx, _mm256_set1_epi8(25)), _mm256_set1_epi8(6)));
+        shift = _mm256_add_epi8(shift, _mm256_and_si256(_mm256_cmpgt_epi8(idx, _mm256_set1_epi8(51)), _mm256_set1_epi8(-75)));
+        shift = _mm256_add_epi8(shift, _mm256_and_si256(_mm256_cmpeq_epi8(idx, _mm256_set1_epi8(62)), _mm256_set1_epi8(-15)));
+        shift = _mm256_add_epi8(shift, _mm256_and_si256(_mm256_cmpeq_epi8(idx, _mm256_set1_epi8(63)), _mm256_set1_epi8(-12)));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), _mm256_add_epi8(idx, shift));
+        i += 24;
+        p += 32;
     }
 
-    return ret;
+    return (p - out) + base64EncodeSSSE3(data + i, length - i, p);
 }
 
-std::vector<unsigned char> base64Decode(const std::string& encoded_data) {
-    size_t in_len = encoded_data.size();
-    int i = 0;
-    int j = 0;
-    int in_ = 0;
-    unsigned char char_array_4[4], char_array_3[3];
-    std::vector<unsigned char> ret;
-
-    while (in_len-- && (encoded_data[in_] != '=') && is_base64(encoded_data[in_])) {
-        char_array_4[i++] = encoded_data[in_]; in_++;
-        if (i == 4) {
-            for (i = 0; i < 4; i++)
-                char_array_4[i] = base64_chars.find(char_array_4[i]);
-
-            char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-            char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-            char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
-
-            for (i = 0; i < 3; i++)
-                ret.push_back(char_array_3[i]);
-            i = 0;
+// SSSE3解码：每次处理16个字符，输出12字节（需要至少16字节输出空间）
+// 整块校验通过才写出，遇到非法字符时交给标量路径处理剩余部分
+__attribute__((target("ssse3")))
+static size_t base64DecodeSSSE3(const char* in, size_t length, unsigned char* out, size_t out_capacity) {
+    size_t i = 0;
+    size_t written = 0;
+
+    while (i + 16 <= length && written + 16 <= out_capacity) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+
+        // 按字符区间计算偏移，同时完成校验
+        __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)),
+                                      _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+        __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('a' - 1)),
+                                      _mm_cmplt_epi8(v, _mm_set1_epi8('z' + 1)));
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                                      _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+        __m128i plus = _mm_cmpeq_epi8(v, _mm_set1_epi8('+'));
+        __m128i slash = _mm_cmpeq_epi8(v, _mm_set1_epi8('/'));
+
+        __m128i valid = _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, _mm_or_si128(plus, slash)));
+        if (_mm_movemask_epi8(valid) != 0xFFFF) {
+            break;
         }
+
+        __m128i shift = _mm_and_si128(upper, _mm_set1_epi8(-65));
+        shift = _mm_or_si128(shift, _mm_and_si128(lower, _mm_set1_epi8(-71)));
+        shift = _mm_or_si128(shift, _mm_and_si128(digit, _mm_set1_epi8(4)));
+        shift = _mm_or_si128(shift, _mm_and_si128(plus, _mm_set1_epi8(19)));
+        shift = _mm_or_si128(shift, _mm_and_si128(slash, _mm_set1_epi8(16)));
+        v = _mm_add_epi8(v, shift);
+
+        // 4个6位值合并为24位：先合并相邻字节，再合并相邻16位
+        __m128i merged = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+        merged = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+        merged = _mm_shuffle_epi8(merged, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + written), merged);
+        i += 16;
+        written += 12;
     }
 
-    if (i) {
-        for (j = i; j <4; j++)
-            char_array_4[j] = 0;
+    return written + base64DecodeScalar(in + i, length - i, out + written);
+}
 
-        for (j = 0; j <4; j++)
-            char_array_4[j] = base64_chars.find(char_array_4[j]);
+// AVX2解码：每次处理32个字符，输出24字节（需要至少32字节输出空间）
+__attribute__((target("avx2")))
+static size_t base64DecodeAVX2(const char* in, size_t length, unsigned char* out, size_t out_capacity) {
+    size_t i = 0;
+    size_t written = 0;
+
+    while (i + 32 <= length && written + 32 <= out_capacity) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+
+        __m256i upper = _mm256_andnot_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('Z')),
+                                            _mm256_cmpgt_epi8(v, _mm256_set1_epi8('A' - 1)));
+        __m256i lower = _mm256_andnot_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('z')),
+                                            _mm256_cmpgt_epi8(v, _mm256_set1_epi8('a' - 1)));
+        __m256i digit = _mm256_andnot_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('9')),
+                                            _mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)));
+        __m256i plus = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('+'));
+        __m256i slash = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('/'));
+
+        __m256i valid = _mm256_or_si256(_mm256_or_si256(upper, lower),
+                                        _mm256_or_si256(digit, _mm256_or_si256(plus, slash)));
+        if (static_cast<uint32_t>(_mm256_movemask_epi8(valid)) != 0xFFFFFFFFu) {
+            break;
+        }
 
-        char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-        char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-        char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
+        __m256i shift = _mm256_and_si256(upper, _mm256_set1_epi8(-65));
+        shift = _mm256_or_si256(shift, _mm256_and_si256(lower, _mm256_set1_epi8(-71)));
+        shift = _mm256_or_si256(shift, _mm256_and_si256(digit, _mm256_set1_epi8(4)));
+        shift = _mm256_or_si256(shift, _mm256_and_si256(plus, _mm256_set1_epi8(19)));
+        shift = _mm256_or_si256(shift, _mm256_and_si256(slash, _mm256_set1_epi8(16)));
+        v = _mm256_add_epi8(v, shift);
+
+        __m256i merged = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+        merged = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+        merged = _mm256_shuffle_epi8(merged, _mm256_setr_epi8(
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        // 两个128位通道各有12字节，拼接为连续的24字节
+        merged = _mm256_permutevar8x32_epi32(merged, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + written), merged);
+        i += 32;
+        written += 24;
+    }
 
-        for (j = 0; j < i - 1; j++)
-            ret.push_back(char_array_3[j]);
+    return written + base64DecodeSSSE3(in + i, length - i, out + written, out_capacity - written);
+}
+
+#endif
+
+typedef size_t (*Base64EncodeFn)(const unsigned char*, size_t, char*);
+typedef size_t (*Base64DecodeFn)(const char*, size_t, unsigned char*, size_t);
+
+static size_t base64DecodeScalarBounded(const char* in, size_t length, unsigned char* out, size_t /*out_capacity*/) {
+    return base64DecodeScalar(in, length, out);
+}
+
+// 根据CPU特性选择实现（只检测一次）
+struct Base64Dispatch {
+    Base64EncodeFn encode;
+    Base64DecodeFn decode;
+    const char* name;
+
+    Base64Dispatch() : encode(base64EncodeScalar), decode(base64DecodeScalarBounded), name("scalar") {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            encode = base64EncodeAVX2;
+            decode = base64DecodeAVX2;
+            name = "avx2";
+        } else if (__builtin_cpu_supports("ssse3")) {
+            encode = base64EncodeSSSE3;
+            decode = base64DecodeSSSE3;
+            name = "ssse3";
+        }
+#endif
     }
+};
 
+static const Base64Dispatch& base64Dispatch() {
+    static const Base64Dispatch dispatch;
+    return dispatch;
+}
+
+const char* base64Implementation() {
+    return base64Dispatch().name;
+}
+
+size_t base64EncodedLength(size_t length) {
+    return (length + 2) / 3 * 4;
+}
+
+size_t base64DecodedMaxLength(size_t encoded_length) {
+    return (encoded_length + 3) / 4 * 3;
+}
+
+size_t base64EncodeTo(const unsigned char* data, size_t length, char* out) {
+    return base64Dispatch().encode(data, length, out);
+}
+
+size_t base64DecodeTo(const char* encoded, size_t length, unsigned char* out, size_t out_capacity) {
+    if (out_capacity < base64DecodedMaxLength(length)) {
+        return 0;
+    }
+    return base64Dispatch().decode(encoded, length, out, out_capacity);
+}
+
+std::string base64Encode(const unsigned char* data, size_t length) {
+    std::string ret(base64EncodedLength(length), '\0');
+    if (length) {
+        ret.resize(base64EncodeTo(data, length, &ret[0]));
+    }
+    return ret;
+}
+
+std::vector<unsigned char> base64Decode(const std::string& encoded_data) {
+    std::vector<unsigned char> ret(base64DecodedMaxLength(encoded_data.size()));
+    if (!ret.empty()) {
+        ret.resize(base64DecodeTo(encoded_data.data(), encoded_data.size(), ret.data(), ret.size()));
+    }
     return ret;
 }
 
 cv::Mat base64ToMat(const std::string& base64_image) {
-    // 删除可能存在的格式前缀 (data:image/jpeg;base64,)
-    std::string base64_data = base64_image;
-    size_t pos = base64_data.find(',');
+    // 跳过可能存在的格式前缀 (data:image/jpeg;base64,)，不复制字符串
+    const char* encoded = base64_image.data();
+    size_t length = base64_image.size();
+    size_t pos = base64_image.find(',');
     if (pos != std::string::npos) {
-        base64_data = base64_data.substr(pos + 1);
+        encoded += pos + 1;
+        length -= pos + 1;
     }
 
     // 解码Base64
-    std::vector<unsigned char> decoded_data = base64Decode(base64_data);
-    if (decoded_data.empty()) {
+    std::vector<unsigned char> decoded_data(base64DecodedMaxLength(length));
+    size_t decoded = decoded_data.empty() ? 0 : base64DecodeTo(encoded, length, decoded_data.data(), decoded_data.size());
+    if (decoded == 0) {
         return cv::Mat();
     }
 
-    // 将解码后的数据转换为OpenCV Mat
-    return cv::imdecode(decoded_data, cv::IMREAD_COLOR);
+    // 直接引用解码缓冲区交给OpenCV解码
+    cv::Mat raw(1, static_cast<int>(decoded), CV_8UC1, decoded_data.data());
+    return cv::imdecode(raw, cv::IMREAD_COLOR);
 }
 
 std::string matToBase64(const cv::Mat& image, const std::string& format) {
@@ -0,0 +1,401 @@
+// 端到端压测工具：按 FACE + 长度 + JSON + 人脸数据 的请求帧格式驱动服务器，
+// 支持并发连接数、开环到达速率、登录/注册比例与用户基数，输出吞吐量与延迟分位数（JSON）
+//
+// 配合 "database": {"backend": "memory"} 启动的服务器，无需任何外部服务即可在本机完成压测
+#include "metrics.h"
+#include "protocol.h"
+#include "synthetic_face.h"
+#include "tool_client.h"
+#include <json/json.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct Options {
+    std::string host = "127.0.0.1";
+    int port = 8080;
+    int connections = 8;            // 并发连接（工作线程）数
+    double rate = 0.0;              // 开环到达速率（请求/秒），0表示闭环：每个连接收到响应后立即发下一个
+    bool poisson = false;           // 开环时按泊松过程（指数分布间隔）到达，默认等间隔
+    double duration_s = 30.0;       // 测量时长
+    double register_ratio = 0.0;    // 注册请求占比，其余为登录
+    int users = 100;                // 登录使用的用户基数
+    bool setup = true;              // 测量前先注册全部登录用户
+    std::string user_prefix = "loadgen_user_";
+    std::string password = "loadgen_password";
+    std::string image;              // 人脸图片（JPEG等），为空时使用合成人脸
+    int timeout_ms = 60000;         // 单个请求的收发超时
+    std::string output;             // 结果文件，为空时写到标准输出
+};
+
+// 开环模式下积压超过该数量的请求直接计为丢弃，避免服务器跟不上时内存无限增长
+const size_t MAX_BACKLOG = 1000000;
+
+void printUsage(const char* program) {
+    std::cerr << "用法: " << program << " [选项]\n"
+              << "  --host HOST           服务器地址（默认127.0.0.1）\n"
+              << "  --port N              服务器端口（默认8080）\n"
+              << "  --connections N       并发连接数（默认8）\n"
+              << "  --rate N              开环到达速率（请求/秒），0为闭环（默认0）\n"
+              << "  --poisson             开环到达间隔服从指数分布\n"
+              << "  --duration S          测量时长，秒（默认30）\n"
+              << "  --register-ratio R    注册请求占比0~1（默认0）\n"
+              << "  --users N             登录用户基数（默认100）\n"
+              << "  --no-setup            跳过预先注册登录用户\n"
+              << "  --user-prefix TEXT    用户名前缀（默认loadgen_user_）\n"
+              << "  --image PATH          人脸图片，默认使用合成人脸\n"
+              << "  --timeout-ms N        单个请求超时（默认60000）\n"
+              << "  --output FILE         结果写入文件（默认标准输出）\n";
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            return false;
+        }
+        if (arg == "--poisson") {
+            options.poisson = true;
+            continue;
+        }
+        if (arg == "--no-setup") {
+            options.setup = false;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "缺少参数值: " << arg << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--host") {
+            options.host = value;
+        } else if (arg == "--port") {
+            options.port = std::stoi(value);
+        } else if (arg == "--connections") {
+            options.connections = std::stoi(value);
+        } else if (arg == "--rate") {
+            options.rate = std::stod(value);
+        } else if (arg == "--duration") {
+            options.duration_s = std::stod(value);
+        } else if (arg == "--register-ratio") {
+            options.register_ratio = std::stod(value);
+        } else if (arg == "--users") {
+            options.users = std::stoi(value);
+        } else if (arg == "--user-prefix") {
+            options.user_prefix = value;
+        } else if (arg == "--image") {
+            options.image = value;
+        } else if (arg == "--timeout-ms") {
+            options.timeout_ms = std::stoi(value);
+        } else if (arg == "--output") {
+            options.output = value;
+        } else {
+            std::cerr << "未知选项: " << arg << std::endl;
+            return false;
+        }
+    }
+    if (options.connections <= 0 || options.users <= 0 || options.duration_s <= 0 ||
+        options.register_ratio < 0 || options.register_ratio > 1 || options.rate < 0) {
+        std::cerr << "参数超出范围" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+enum class RequestKind { LOGIN, REGISTER };
+
+class LoadGenerator {
+public:
+    LoadGenerator(const Options& options, const std::string& face_data)
+        : options_(options), face_data_(face_data), run_id_(static_cast<long>(std::time(nullptr))),
+          stop_(false), dropped_(0), max_backlog_(0) {
+        stats_[0].reset(new tool_client::RequestStats());
+        stats_[1].reset(new tool_client::RequestStats());
+    }
+
+    // 预先注册全部登录用户；重复运行时用户已存在，注册被拒绝不影响后续登录
+    // 只有全部请求都无法收到响应时返回false
+    bool setupUsers() {
+        std::atomic<int> next(0);
+        std::atomic<int> registered(0);
+        std::atomic<int> rejected(0);
+        std::atomic<int> errors(0);
+        std::mutex reason_mutex;
+        std::string first_reason;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < options_.connections; ++t) {
+            threads.push_back(std::thread([&]() {
+                int index;
+                while ((index = next++) < options_.users) {
+                    Json::Value response;
+                    if (!tool_client::exchange(options_.host, options_.port, options_.timeout_ms,
+                                               buildRequest(RequestKind::REGISTER, loginUser(index)), response)) {
+                        errors++;
+                    } else if (tool_client::isSuccess(response)) {
+                        registered++;
+                    } else {
+                        rejected++;
+                        std::lock_guard<std::mutex> lock(reason_mutex);
+                        if (first_reason.empty()) {
+                            first_reason = response["message"].asString();
+                        }
+                    }
+                }
+            }));
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        std::cerr << "预先注册 " << options_.users << " 个用户: 成功 " << registered << ", 拒绝 " << rejected
+                  << (first_reason.empty() ? "" : "（" + first_reason + "）") << ", 错误 " << errors << std::endl;
+        return errors < options_.users;
+    }
+
+    void run() {
+        start_ = Clock::now();
+        end_ = start_ + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options_.duration_s));
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < options_.connections; ++t) {
+            workers.push_back(std::thread(&LoadGenerator::worker, this, t));
+        }
+        if (options_.rate > 0) {
+            dispatch();
+        } else {
+            std::this_thread::sleep_until(end_);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        finish_ = Clock::now();
+    }
+
+    Json::Value report() const {
+        double elapsed = std::chrono::duration<double>(finish_ - start_).count();
+        Json::Value root;
+        root["tool"] = "face_auth_loadgen";
+        root["timestamp"] = static_cast<Json::Int64>(std::time(nullptr));
+
+        Json::Value config;
+        config["host"] = options_.host;
+        config["port"] = options_.port;
+        config["connections"] = options_.connections;
+        config["mode"] = options_.rate > 0 ? "open" : "closed";
+        config["rate"] = options_.rate;
+        config["arrival"] = options_.poisson ? "poisson" : "uniform";
+        config["duration_s"] = options_.duration_s;
+        config["register_ratio"] = options_.register_ratio;
+        config["users"] = options_.users;
+        config["face_bytes"] = static_cast<Json::UInt64>(face_data_.size());
+        root["config"] = config;
+
+        uint64_t completed = 0;
+        uint64_t succeeded = 0;
+        Json::Value requests;
+        const char* const names[] = {"login", "register"};
+        for (int i = 0; i < 2; ++i) {
+            const tool_client::RequestStats& stats = *stats_[i];
+            uint64_t count = stats.latency.snapshot().count;
+            if (count == 0) {
+                continue;
+            }
+            requests[names[i]] = stats.toJson(elapsed);
+            completed += count;
+            succeeded += stats.success.value();
+        }
+
+        root["elapsed_s"] = elapsed;
+        root["completed"] = static_cast<Json::UInt64>(completed);
+        root["succeeded"] = static_cast<Json::UInt64>(succeeded);
+        root["throughput_rps"] = elapsed > 0 ? completed / elapsed : 0.0;
+        root["dropped"] = static_cast<Json::UInt64>(dropped_.load());
+        root["max_backlog"] = static_cast<Json::UInt64>(max_backlog_);
+        root["requests"] = requests;
+        return root;
+    }
+
+private:
+    struct Task {
+        Clock::time_point intended;
+        RequestKind kind;
+    };
+
+    std::string loginUser(int index) const {
+        return options_.user_prefix + std::to_string(index);
+    }
+
+    std::string buildRequest(RequestKind kind, const std::string& username) const {
+        Json::Value request;
+        request["type"] = kind == RequestKind::REGISTER ? "register" : "login";
+        request["username"] = username;
+        request["password"] = options_.password;
+        return protocol::buildRequestFrame(request, face_data_);
+    }
+
+    // 开环调度：按计划时刻生成请求放入队列，工作线程从计划时刻起计算延迟，避免协同遗漏
+    void dispatch() {
+        std::mt19937_64 rng(static_cast<uint64_t>(run_id_));
+        std::exponential_distribution<double> interval(options_.rate);
+        std::uniform_real_distribution<double> mix(0.0, 1.0);
+        double offset_s = 0.0;
+        while (true) {
+            offset_s += options_.poisson ? interval(rng) : 1.0 / options_.rate;
+            Clock::time_point intended = start_ + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(offset_s));
+            if (intended >= end_) {
+                break;
+            }
+            std::this_thread::sleep_until(intended);
+
+            Task task;
+            task.intended = intended;
+            task.kind = mix(rng) < options_.register_ratio ? RequestKind::REGISTER : RequestKind::LOGIN;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (queue_.size() >= MAX_BACKLOG) {
+                    dropped_++;
+                    continue;
+                }
+                queue_.push_back(task);
+                if (queue_.size() > max_backlog_) {
+                    max_backlog_ = queue_.size();
+                }
+            }
+            cv_.notify_one();
+        }
+    }
+
+    void worker(int worker_id) {
+        std::mt19937 rng(static_cast<uint32_t>(run_id_) + worker_id);
+        std::uniform_int_distribution<int> pick_user(0, options_.users - 1);
+        std::uniform_real_distribution<double> mix(0.0, 1.0);
+        uint64_t sequence = 0;
+
+        while (true) {
+            Task task;
+            if (options_.rate > 0) {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+                // 压测时长结束后不再发送积压请求，剩余请求计为丢弃
+                if (stop_) {
+                    dropped_ += queue_.size();
+                    queue_.clear();
+                    return;
+                }
+                task = queue_.front();
+                queue_.pop_front();
+            } else {
+                task.intended = Clock::now();
+                if (task.intended >= end_) {
+                    return;
+                }
+                task.kind = mix(rng) < options_.register_ratio ? RequestKind::REGISTER : RequestKind::LOGIN;
+            }
+
+            // 注册使用本次运行内唯一的新用户名，登录在用户基数内均匀选择
+            std::string username = task.kind == RequestKind::REGISTER
+                ? options_.user_prefix + "new_" + std::to_string(run_id_) + "_" + std::to_string(worker_id) +
+                      "_" + std::to_string(sequence++)
+                : loginUser(pick_user(rng));
+
+            Clock::time_point sent = Clock::now();
+            Json::Value response;
+            bool ok = tool_client::exchange(options_.host, options_.port, options_.timeout_ms,
+                                           buildRequest(task.kind, username), response);
+            Clock::time_point done = Clock::now();
+
+            stats_[task.kind == RequestKind::REGISTER ? 1 : 0]->record(task.intended, sent, done, ok, response);
+        }
+    }
+
+    const Options& options_;
+    const std::string& face_data_;
+    const long run_id_;
+
+    Clock::time_point start_;
+    Clock::time_point end_;
+    Clock::time_point finish_;
+
+    std::unique_ptr<tool_client::RequestStats> stats_[2];   // 0：登录，1：注册
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Task> queue_;
+    bool stop_;
+    std::atomic<uint64_t> dropped_;
+    size_t max_backlog_;
+};
+
+bool loadFaceData(const Options& options, std::string& face_data) {
+    if (!options.image.empty()) {
+        std::ifstream file(options.image, std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "无法读取图片: " << options.image << std::endl;
+            return false;
+        }
+        face_data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return !face_data.empty();
+    }
+    // 合成人脸不一定能被Haar检测器检出，此时请求会被服务器拒绝，但仍经过完整的解码与检测路径
+    std::vector<uchar> jpeg;
+    cv::imencode(".jpg", synthetic::makeScene(cv::Size(640, 480), 1), jpeg);
+    face_data.assign(jpeg.begin(), jpeg.end());
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::string face_data;
+    if (!loadFaceData(options, face_data)) {
+        return 1;
+    }
+
+    LoadGenerator generator(options, face_data);
+    if (options.setup && options.register_ratio < 1.0 && !generator.setupUsers()) {
+        std::cerr << "无法注册任何登录用户，请检查服务器是否已启动" << std::endl;
+        return 1;
+    }
+
+    std::cerr << "开始压测: " << options.connections << " 个连接, ";
+    if (options.rate > 0) {
+        std::cerr << "开环 " << options.rate << " 请求/秒";
+    } else {
+        std::cerr << "闭环";
+    }
+    std::cerr << ", " << options.duration_s << " 秒" << std::endl;
+    generator.run();
+
+    Json::Value report = generator.report();
+    tool_client::printSummary(report);
+    if (!tool_client::writeReport(report, options.output)) {
+        return 1;
+    }
+    return 0;
+}
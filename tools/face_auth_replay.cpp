@@ -0,0 +1,348 @@
+// 抓包回放工具：按记录时的到达间隔（可加速）把抓包文件中的请求重新发送到服务器，
+// 输出各类请求的吞吐量与延迟分位数（JSON），用于在真实流量形态下对比版本
+//
+// 抓包中的密码已脱敏，需用 --password 指定测试环境中这些用户的密码；
+// 未完整保留人脸数据的请求，用 --image 指定的图片或补零到原始大小后发送
+#include "capture.h"
+#include "metrics.h"
+#include "protocol.h"
+#include "tool_client.h"
+#include <json/json.h>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct Options {
+    std::vector<std::string> files;     // 抓包文件，按时间从旧到新
+    std::string host = "127.0.0.1";
+    int port = 8080;
+    int connections = 16;               // 并发连接（工作线程）数
+    double speed = 1.0;                 // 回放速度倍数，0表示不等待、尽快发送
+    int loops = 1;                      // 重复回放次数
+    std::string password;               // 替换脱敏的密码，为空时保持脱敏值
+    std::string image;                  // 替换未完整保留的人脸数据
+    int timeout_ms = 60000;
+    std::string output;
+};
+
+struct ReplayRequest {
+    uint64_t offset_us;     // 相对第一条请求的到达时间
+    std::string type;
+    std::string frame;
+};
+
+void printUsage(const char* program) {
+    std::cerr << "用法: " << program << " [选项] 抓包文件...\n"
+              << "  --host HOST           服务器地址（默认127.0.0.1）\n"
+              << "  --port N              服务器端口（默认8080）\n"
+              << "  --connections N       并发连接数（默认16）\n"
+              << "  --speed X             回放速度倍数，1为原速，0为尽快发送（默认1）\n"
+              << "  --loops N             重复回放次数（默认1）\n"
+              << "  --password TEXT       替换脱敏的密码\n"
+              << "  --image PATH          替换未完整保留的人脸数据\n"
+              << "  --timeout-ms N        单个请求超时（默认60000）\n"
+              << "  --output FILE         结果写入文件（默认标准输出）\n"
+              << "轮转产生的多个文件按从旧到新的顺序给出，如 requests.fcap.2 requests.fcap.1 requests.fcap\n";
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            return false;
+        }
+        if (arg.compare(0, 2, "--") != 0) {
+            options.files.push_back(arg);
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "缺少参数值: " << arg << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--host") {
+            options.host = value;
+        } else if (arg == "--port") {
+            options.port = std::stoi(value);
+        } else if (arg == "--connections") {
+            options.connections = std::stoi(value);
+        } else if (arg == "--speed") {
+            options.speed = std::stod(value);
+        } else if (arg == "--loops") {
+            options.loops = std::stoi(value);
+        } else if (arg == "--password") {
+            options.password = value;
+        } else if (arg == "--image") {
+            options.image = value;
+        } else if (arg == "--timeout-ms") {
+            options.timeout_ms = std::stoi(value);
+        } else if (arg == "--output") {
+            options.output = value;
+        } else {
+            std::cerr << "未知选项: " << arg << std::endl;
+            return false;
+        }
+    }
+    if (options.files.empty() || options.connections <= 0 || options.speed < 0 || options.loops <= 0) {
+        return false;
+    }
+    return true;
+}
+
+// 读取全部抓包记录并重建请求帧
+// 多帧会话的后续帧依赖所在连接，无法单独回放而跳过；会话的第一帧后紧跟session_end，按单帧会话回放
+bool loadRequests(const Options& options, std::vector<ReplayRequest>& requests, size_t& substituted,
+                  size_t& skipped) {
+    std::string image;
+    if (!options.image.empty()) {
+        std::ifstream file(options.image, std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "无法读取图片: " << options.image << std::endl;
+            return false;
+        }
+        image.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    uint64_t first_us = 0;
+    substituted = 0;
+    skipped = 0;
+    for (const std::string& path : options.files) {
+        CaptureReader reader;
+        if (!reader.open(path)) {
+            std::cerr << "无法打开抓包文件: " << path << std::endl;
+            return false;
+        }
+        CaptureRecord record;
+        while (reader.next(record)) {
+            std::string type = record.request["type"].asString();
+            if (type == "session_frame" || type == "session_end") {
+                skipped++;
+                continue;
+            }
+            if (requests.empty()) {
+                first_us = record.timestamp_us;
+            }
+            if (!options.password.empty() && record.request.isMember("password")) {
+                record.request["password"] = options.password;
+            }
+            if (!record.payloadComplete()) {
+                if (!image.empty()) {
+                    record.face_data = image;
+                } else {
+                    record.face_data.resize(record.face_data_size, '\0');
+                }
+                substituted++;
+            }
+
+            ReplayRequest request;
+            request.offset_us = record.timestamp_us > first_us ? record.timestamp_us - first_us : 0;
+            request.type = type;
+            request.frame = protocol::buildRequestFrame(record.request, record.face_data);
+            if (type == "login_session") {
+                Json::Value end;
+                end["type"] = "session_end";
+                request.frame += protocol::buildRequestFrame(end, std::string());
+            }
+            requests.push_back(std::move(request));
+        }
+        if (reader.truncated()) {
+            std::cerr << "抓包文件 " << path << " 末尾有不完整的记录，已忽略" << std::endl;
+        }
+    }
+    return true;
+}
+
+class Replayer {
+public:
+    Replayer(const Options& options, const std::vector<ReplayRequest>& requests)
+        : options_(options), requests_(requests), done_(false) {
+        for (const ReplayRequest& request : requests_) {
+            if (!stats_.count(request.type)) {
+                stats_[request.type].reset(new tool_client::RequestStats());
+            }
+        }
+    }
+
+    void run() {
+        start_ = Clock::now();
+        std::vector<std::thread> workers;
+        for (int t = 0; t < options_.connections; ++t) {
+            workers.push_back(std::thread(&Replayer::worker, this));
+        }
+
+        // 按原始到达间隔调度，延迟从计划时刻算起；每轮从上一轮最后一条请求之后开始
+        uint64_t span_us = requests_.empty() ? 0 : requests_.back().offset_us;
+        for (int loop = 0; loop < options_.loops; ++loop) {
+            for (size_t i = 0; i < requests_.size(); ++i) {
+                Task task;
+                task.index = i;
+                task.intended = Clock::now();
+                if (options_.speed > 0) {
+                    double offset_us = (static_cast<double>(span_us) * loop + requests_[i].offset_us) / options_.speed;
+                    task.intended = start_ + std::chrono::duration_cast<Clock::duration>(
+                        std::chrono::duration<double, std::micro>(offset_us));
+                    std::this_thread::sleep_until(task.intended);
+                }
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    // 尽快发送时限制积压，按完成速度推进
+                    if (options_.speed == 0) {
+                        not_full_.wait(lock, [this]() {
+                            return queue_.size() < static_cast<size_t>(options_.connections) * 2;
+                        });
+                        task.intended = Clock::now();
+                    }
+                    queue_.push_back(task);
+                    if (queue_.size() > max_backlog_) {
+                        max_backlog_ = queue_.size();
+                    }
+                }
+                not_empty_.notify_one();
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            done_ = true;
+        }
+        not_empty_.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        finish_ = Clock::now();
+    }
+
+    Json::Value report(size_t substituted, size_t skipped) const {
+        double elapsed = std::chrono::duration<double>(finish_ - start_).count();
+        Json::Value root;
+        root["tool"] = "face_auth_replay";
+        root["timestamp"] = static_cast<Json::Int64>(std::time(nullptr));
+
+        Json::Value config;
+        config["host"] = options_.host;
+        config["port"] = options_.port;
+        config["connections"] = options_.connections;
+        config["speed"] = options_.speed;
+        config["loops"] = options_.loops;
+        for (const std::string& file : options_.files) {
+            config["files"].append(file);
+        }
+        config["captured_requests"] = static_cast<Json::UInt64>(requests_.size());
+        config["substituted_payloads"] = static_cast<Json::UInt64>(substituted);
+        config["skipped_session_frames"] = static_cast<Json::UInt64>(skipped);
+        root["config"] = config;
+
+        uint64_t completed = 0;
+        uint64_t succeeded = 0;
+        Json::Value requests(Json::objectValue);
+        for (const auto& pair : stats_) {
+            requests[pair.first] = pair.second->toJson(elapsed);
+            completed += pair.second->latency.snapshot().count;
+            succeeded += pair.second->success.value();
+        }
+        root["elapsed_s"] = elapsed;
+        root["completed"] = static_cast<Json::UInt64>(completed);
+        root["succeeded"] = static_cast<Json::UInt64>(succeeded);
+        root["throughput_rps"] = elapsed > 0 ? completed / elapsed : 0.0;
+        root["max_backlog"] = static_cast<Json::UInt64>(max_backlog_);
+        root["requests"] = requests;
+        return root;
+    }
+
+private:
+    struct Task {
+        size_t index;
+        Clock::time_point intended;
+    };
+
+    void worker() {
+        while (true) {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                not_empty_.wait(lock, [this]() { return done_ || !queue_.empty(); });
+                if (queue_.empty()) {
+                    return;
+                }
+                task = queue_.front();
+                queue_.pop_front();
+            }
+            not_full_.notify_one();
+
+            const ReplayRequest& request = requests_[task.index];
+            Clock::time_point sent = Clock::now();
+            Json::Value response;
+            bool ok = tool_client::exchange(options_.host, options_.port, options_.timeout_ms, request.frame, response);
+            stats_.at(request.type)->record(task.intended, sent, Clock::now(), ok, response);
+        }
+    }
+
+    const Options& options_;
+    const std::vector<ReplayRequest>& requests_;
+    std::map<std::string, std::unique_ptr<tool_client::RequestStats>> stats_;   // 运行前建好，之后只读
+
+    Clock::time_point start_;
+    Clock::time_point finish_;
+
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::deque<Task> queue_;
+    bool done_;
+    size_t max_backlog_ = 0;
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::vector<ReplayRequest> requests;
+    size_t substituted = 0;
+    size_t skipped = 0;
+    if (!loadRequests(options, requests, substituted, skipped)) {
+        return 1;
+    }
+    if (requests.empty()) {
+        std::cerr << "抓包文件中没有请求" << std::endl;
+        return 1;
+    }
+    double span_s = requests.back().offset_us / 1e6;
+    std::cerr << "读取 " << requests.size() << " 个请求，原始时长 " << span_s << " 秒，"
+              << substituted << " 个请求的人脸数据被替换";
+    if (skipped > 0) {
+        std::cerr << "，跳过 " << skipped << " 个会话后续帧";
+    }
+    std::cerr << std::endl;
+    if (options.password.empty()) {
+        std::cerr << "注意: 未指定 --password，登录请求将使用脱敏后的密码" << std::endl;
+    }
+
+    Replayer replayer(options, requests);
+    replayer.run();
+
+    Json::Value report = replayer.report(substituted, skipped);
+    tool_client::printSummary(report);
+    if (!tool_client::writeReport(report, options.output)) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,191 @@
+#ifndef TOOL_CLIENT_H
+#define TOOL_CLIENT_H
+
+#include "metrics.h"
+#include "protocol.h"
+#include <json/json.h>
+#include <string>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+// 压测与回放工具共用的客户端函数
+namespace tool_client {
+
+inline int connectToServer(const std::string& host, int port, int timeout_ms) {
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* result = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &result) != 0) {
+        return -1;
+    }
+    int fd = -1;
+    for (struct addrinfo* addr = result; addr; addr = addr->ai_next) {
+        fd = socket(addr->ai_family, addr->ai_socktype | SOCK_CLOEXEC, addr->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        if (connect(fd, addr->ai_addr, addr->ai_addrlen) == 0) {
+            break;
+        }
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(result);
+    if (fd < 0) {
+        return -1;
+    }
+
+    int flag = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+    struct timeval tv;
+    tv.tv_sec = timeout_ms / 1000;
+    tv.tv_usec = (timeout_ms % 1000) * 1000;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    return fd;
+}
+
+// 服务器每个连接只处理一个请求：连接、发送整帧、读取一个响应帧后关闭
+inline bool exchange(const std::string& host, int port, int timeout_ms,
+                     const std::string& frame, Json::Value& response) {
+    int fd = connectToServer(host, port, timeout_ms);
+    if (fd < 0) {
+        return false;
+    }
+
+    bool ok = true;
+    size_t offset = 0;
+    while (offset < frame.size()) {
+        ssize_t n = send(fd, frame.data() + offset, frame.size() - offset, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            ok = false;
+            break;
+        }
+        offset += static_cast<size_t>(n);
+    }
+
+    std::string data;
+    char buffer[4096];
+    while (ok) {
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            ok = false;
+            break;
+        }
+        data.append(buffer, static_cast<size_t>(n));
+        FrameStatus status = protocol::parseResponseFrame(data.data(), data.size(), response);
+        if (status == FrameStatus::COMPLETE) {
+            break;
+        }
+        if (status == FrameStatus::INVALID) {
+            ok = false;
+        }
+    }
+    close(fd);
+    return ok;
+}
+
+// 响应中的success字段，普通响应为字符串"true"/"false"，统计响应为布尔值
+inline bool isSuccess(const Json::Value& response) {
+    const Json::Value& success = response["success"];
+    return success.isBool() ? success.asBool() : success.asString() == "true";
+}
+
+// 延迟分布摘要（微秒）
+inline Json::Value summarize(const HistogramSnapshot& snapshot) {
+    Json::Value item;
+    item["mean"] = snapshot.mean();
+    item["p50"] = static_cast<Json::UInt64>(snapshot.percentile(0.5));
+    item["p90"] = static_cast<Json::UInt64>(snapshot.percentile(0.9));
+    item["p99"] = static_cast<Json::UInt64>(snapshot.percentile(0.99));
+    item["p999"] = static_cast<Json::UInt64>(snapshot.percentile(0.999));
+    item["max"] = static_cast<Json::UInt64>(snapshot.max);
+    return item;
+}
+
+// 一类请求的统计
+struct RequestStats {
+    LatencyHistogram latency;        // 从计划发出时刻到收到响应（微秒），开环时包含排队时间
+    LatencyHistogram service;        // 从实际发出到收到响应（微秒）
+    Counter success;
+    Counter rejected;                // 服务器返回success=false（认证失败、用户已存在等）
+    Counter errors;                  // 连接、收发或帧格式错误
+
+    void record(std::chrono::steady_clock::time_point intended, std::chrono::steady_clock::time_point sent,
+                std::chrono::steady_clock::time_point done, bool ok, const Json::Value& response) {
+        latency.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(done - intended).count()));
+        service.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(done - sent).count()));
+        if (!ok) {
+            errors.increment();
+        } else if (isSuccess(response)) {
+            success.increment();
+        } else {
+            rejected.increment();
+        }
+    }
+
+    Json::Value toJson(double elapsed_s) const {
+        HistogramSnapshot snapshot = latency.snapshot();
+        Json::Value item;
+        item["count"] = static_cast<Json::UInt64>(snapshot.count);
+        item["success"] = static_cast<Json::UInt64>(success.value());
+        item["rejected"] = static_cast<Json::UInt64>(rejected.value());
+        item["errors"] = static_cast<Json::UInt64>(errors.value());
+        item["throughput_rps"] = elapsed_s > 0 ? snapshot.count / elapsed_s : 0.0;
+        item["latency_us"] = summarize(snapshot);
+        item["service_time_us"] = summarize(service.snapshot());
+        return item;
+    }
+};
+
+// 输出各类请求的摘要到stderr
+inline void printSummary(const Json::Value& report) {
+    std::cerr << "完成 " << report["completed"].asUInt64() << " 个请求, 吞吐量 "
+              << report["throughput_rps"].asDouble() << " 请求/秒" << std::endl;
+    for (const std::string& name : report["requests"].getMemberNames()) {
+        const Json::Value& item = report["requests"][name];
+        std::cerr << "  " << name << ": 成功 " << item["success"].asUInt64() << ", 拒绝 "
+                  << item["rejected"].asUInt64() << ", 错误 " << item["errors"].asUInt64()
+                  << ", p50 " << item["latency_us"]["p50"].asUInt64() << " us, p99 "
+                  << item["latency_us"]["p99"].asUInt64() << " us" << std::endl;
+    }
+}
+
+// 结果写到文件，路径为空时写到标准输出
+inline bool writeReport(const Json::Value& report, const std::string& path) {
+    Json::StyledWriter writer;
+    std::string output = writer.write(report);
+    if (path.empty()) {
+        std::cout << output;
+        return true;
+    }
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "无法写入结果文件: " << path << std::endl;
+        return false;
+    }
+    file << output;
+    return true;
+}
+
+} // namespace tool_client
+
+#endif // TOOL_CLIENT_H